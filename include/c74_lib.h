@@ -9,16 +9,30 @@
 #include "c74_lib_circular_storage.h"
 #include "c74_lib_interpolator.h"
 #include "c74_lib_math.h"
+#include "c74_lib_denormal.h"
 #include "c74_lib_easing.h"
 #include "c74_lib_filters.h"
+#include "c74_lib_fft.h"
+#include "c74_lib_parameter.h"
 
 #include "c74_lib_adsr.h"
+#include "c74_lib_adsr_bank.h"
 #include "c74_lib_allpass.h"
+#include "c74_lib_biquad.h"
+#include "c74_lib_convolver.h"
+#include "c74_lib_crossover.h"
 #include "c74_lib_dcblocker.h"
 #include "c74_lib_delay.h"
 #include "c74_lib_generator.h"
 #include "c74_lib_limiter.h"
+#include "c74_lib_loudness.h"
+#include "c74_lib_multiband_limiter.h"
+#include "c74_lib_noise.h"
 #include "c74_lib_onepole.h"
+#include "c74_lib_oversampler.h"
 #include "c74_lib_saturation.h"
+#include "c74_lib_sos_cascade.h"
 #include "c74_lib_sync.h"
 #include "c74_lib_oscillator.h"
+
+#include "c74_lib_profile.h"
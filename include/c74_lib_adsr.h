@@ -6,12 +6,17 @@
 
 #pragma once
 
+#include "c74_lib_interpolator.h"
+#include "c74_lib_math.h"
+
 namespace c74::min::lib {
     
 
     ///	Generate an <a href="https://en.wikipedia.org/wiki/Synthesizer#Attack_Decay_Sustain_Release_.28ADSR.29_envelope">ADSR</a> envelope.
+    ///	@tparam	math_policy		How the curved slopes are evaluated: math::precise by default, or math::fast.
 
-    class adsr {
+    template<class math_policy = math::precise>
+    class basic_adsr {
     public:
 
         enum class adsr_stage {
@@ -48,12 +53,162 @@ namespace c74::min::lib {
                 if (m_is_linear)
                     return x;
                 else if (m_curve > 0.0)
-                    return 1.0 - pow(std::abs(x - 1.0), m_exp);
+                    return 1.0 - math_policy::pow(std::abs(x - 1.0), m_exp);
+                else
+                    return math_policy::pow(x, m_exp);
+            }
+
+            /// Return the exponent of the curve, which is one for a linear slope.
+            /// @return	The exponent.
+
+            number exponent() const {
+                return m_exp;
+            }
+
+            /// Return whether the curve is 1 - (1 - x)^exponent, which rises quickly at first, rather than x^exponent.
+            /// @return	True for a positive curve percentage.
+
+            bool inverted() const {
+                return m_curve > 0.0;
+            }
+
+            /// Calculate the slope at a run of evenly spaced positions: position + step, position + 2 * step, ...
+            /// The positions are accumulated one step at a time, as the envelope does for a single sample.
+            /// Rather than a pow per position, curved slopes are calculated with power(), within 1e-10 of the single-position result.
+            /// @param	position	The position before the first one calculated.
+            /// @param	step		The distance between positions.
+            /// @param	output		Storage for the result.
+            /// @param	count		The number of positions to calculate.
+
+            void operator()(number position, number step, sample* output, std::size_t count) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    position += step;
+                    output[i] = position;
+                }
+
+                if (m_is_linear)
+                    return;
+                else if (m_curve > 0.0) {
+                    for (std::size_t i = 0; i < count; ++i)
+                        output[i] = std::abs(output[i] - 1.0);
+                    power(output, std::abs(step), count);
+                    for (std::size_t i = 0; i < count; ++i)
+                        output[i] = 1.0 - output[i];
+                }
                 else
-                    return pow(x, m_exp);
+                    power(output, std::abs(step), count);
             }
 
         private:
+            static constexpr std::size_t	k_longest_run	= 64;		// the most positions between exact evaluations
+            static constexpr std::size_t	k_shortest_run	= 8;		// below this pow is used for every position
+            static constexpr number			k_tolerance		= 1e-10;	// the largest error of the recurrence
+
+
+            /// Raise a run of evenly spaced positions in [0, 1] to the exponent, in place.
+            ///
+            /// The power is calculated exactly with math_policy::pow at anchors, and between two anchors it follows
+            /// the quintic Hermite interpolant of their values and first two derivatives, u^e, e u^(e-1) and e (e-1) u^(e-2),
+            /// which are all found from the value without another pow. The interpolant is stepped with a forward-difference
+            /// recurrence, i.e. five additions per position. Its error over a distance h is at most |f| h^6 / 46080,
+            /// so the anchors are placed as far apart as that bound allows: up to k_longest_run positions along the curve,
+            /// and closer together towards zero, where the curve bends. Very close to zero every position is an anchor.
+            /// @param	u			The positions, replaced by their power.
+            /// @param	spacing		The distance between positions.
+            /// @param	count		The number of positions.
+
+            void power(sample* u, number spacing, std::size_t count) const {
+                if (!count)
+                    return;
+
+                const auto e  = m_exp;
+                const auto c6 = std::abs(e * (e - 1.0) * (e - 2.0) * (e - 3.0) * (e - 4.0) * (e - 5.0)) / 46080.0;
+
+                auto		ua	= u[0];
+                auto		ya	= math_policy::pow(ua, e);
+                std::size_t	i	= 1;
+                u[0] = ya;
+
+                while (i < count) {
+                    // The longest distance within the tolerance. Below an exponent of 6 the sixth derivative is largest at the low end,
+                    // and (h / low)^6 e...(e-5) low^e / 46080 <= tolerance with low = ua - h, taking ya for low^e, is conservative
+                    // whichever way the positions run. Above it the sixth derivative is no more than c6 on [0, 1].
+                    auto longest = k_longest_run * spacing;
+                    if (c6 > 0.0) {
+                        if (e >= 6.0)
+                            longest = std::cbrt(std::sqrt(k_tolerance / c6));
+                        else if (ua > 0.0 && ya > 0.0) {
+                            auto r  = std::cbrt(std::sqrt(k_tolerance / (c6 * ya)));
+                            longest = r * ua / (1.0 + r);
+                        }
+                        else
+                            longest = 0.0;
+                    }
+
+                    auto m = std::min<std::size_t>(count - i, spacing > 0.0 ? static_cast<std::size_t>(std::min<number>(longest / spacing, k_longest_run)) : k_longest_run);
+
+                    if (m < k_shortest_run || ua <= 0.0) {
+                        // too close to the bend: evaluate the next few positions directly
+                        m  = std::min(k_shortest_run, count - i);
+                        ua = u[i + m - 1];
+                        math_policy::pow(u + i, e, u + i, m);
+                        ya = u[i + m - 1];
+                        i += m;
+                        continue;
+                    }
+
+                    const auto ub = u[i + m - 1];
+                    const auto yb = math_policy::pow(ub, e);
+                    const auto h  = ub - ua;
+
+                    // the interpolant in t = (u - ua) / h from 0 to 1, with the derivatives scaled to t
+                    const auto va = h * e * ya / ua;
+                    const auto vb = h * e * yb / ub;
+                    const auto aa = h * h * e * (e - 1.0) * ya / (ua * ua);
+                    const auto ab = h * h * e * (e - 1.0) * yb / (ub * ub);
+                    const auto d  = yb - ya;
+
+                    const number c[6] {
+                        ya,
+                        va,
+                        0.5 * aa,
+                        10.0 * d - 6.0 * va - 4.0 * vb - 0.5 * (3.0 * aa - ab),
+                        -15.0 * d + 8.0 * va + 7.0 * vb + 0.5 * (3.0 * aa - 2.0 * ab),
+                        6.0 * d - 3.0 * va - 3.0 * vb - 0.5 * (aa - ab)
+                    };
+
+                    // The forward differences of the interpolant at t = 0, for steps of 1 / m.
+                    // In terms of the step, b[j] = c[j] / m^j, the nth difference of k^j is n! S(j, n), with S the Stirling numbers
+                    // of the second kind. Taking them from the coefficients, rather than subtracting values, avoids cancellation.
+                    number b[6];
+                    auto   scale = 1.0;
+                    for (auto j = 0; j < 6; ++j) {
+                        b[j] = c[j] * scale;
+                        scale /= m;
+                    }
+                    number difference[6] {
+                        b[0],
+                        b[1] + b[2] + b[3] + b[4] + b[5],
+                        2.0 * (b[2] + 3.0 * b[3] + 7.0 * b[4] + 15.0 * b[5]),
+                        6.0 * (b[3] + 6.0 * b[4] + 25.0 * b[5]),
+                        24.0 * (b[4] + 10.0 * b[5]),
+                        120.0 * b[5]
+                    };
+
+                    for (std::size_t k = 0; k + 1 < m; ++k) {
+                        for (auto order = 0; order < 5; ++order)
+                            difference[order] += difference[order + 1];
+                        u[i + k] = difference[0];
+                    }
+                    u[i + m - 1] = yb;
+
+                    ua = ub;
+                    ya = yb;
+                    i += m;
+                }
+            }
+
+
             number	m_curve		{ 0.0 };
             number	m_exp		{ 1.0 };
             bool	m_is_linear	{ true };
@@ -161,6 +316,35 @@ namespace c74::min::lib {
         }
 
 
+        /// Evaluate ramps in process() only every few samples, and interpolate between, when the envelope modulates a parameter
+        /// that does not need to change smoothly at every sample. The spacing is reduced for each segment as needed so that
+        /// the output stays within the tolerance of the envelope evaluated at every sample, which makes short segments run at audio rate.
+        /// The tolerance is guaranteed for linear interpolation; spline interpolation is usually closer within a segment.
+        /// @param	interval	The largest spacing of evaluations in samples. An interval of one, the default, evaluates every sample.
+        /// @param	tolerance	The largest difference from the envelope evaluated at every sample, in the units of the output.
+
+        void control_rate(int interval, number tolerance = 1e-3) {
+            m_control_interval = std::max(interval, 1);
+            m_control_tolerance = tolerance;
+        }
+
+
+        /// Set the interpolation used between evaluations at control rate.
+        /// @param	kind	interpolator::type::linear, the default, or interpolator::type::spline for a Catmull-Rom cubic.
+
+        void control_interpolation(interpolator::type kind) {
+            m_control_interpolation = kind;
+        }
+
+
+        /// Evaluate the attack at every sample even at control rate, so that a fast attack keeps its sharp start.
+        /// @param	audio_rate	True to evaluate the attack at every sample.
+
+        void audio_rate_attack(bool audio_rate) {
+            m_audio_rate_attack = audio_rate;
+        }
+
+
         void return_to_zero(bool rtz) {
             m_return_to_zero = rtz;
         }
@@ -283,29 +467,15 @@ namespace c74::min::lib {
                         else {
                             // we aren't returning to zero -- instead starting in the middle of the attack ftom the value where already are
 
-                            number attack_current {};
-                            number attack_curved {};
-
-                            bool was_below { false };
-                            if (m_peak_cached > m_initial_cached)
-                                was_below = true;
-                            bool is_below;
-                            bool found {};
-
-                            for (auto i=0; i<m_attack_step_count; ++i) {
-                                attack_current += m_attack_step;
-                                attack_curved = m_attack_exp(attack_current) * (m_peak_cached - m_initial_cached) + m_initial_cached;
-                                is_below = attack_curved < m_last_output;
-                                if (is_below != was_below) { // we found the position from which to retrigger
-                                    m_stage = adsr_stage::attack;
-                                    m_index = i;
-                                    m_attack_current = attack_current;
-                                    output = m_last_output;
-                                    found = true;
-                                }
-                            }
+                            auto i = retrigger_index();
 
-                            if (!found) { // so return to zero
+                            if (i >= 0) {
+                                m_stage = adsr_stage::attack;
+                                m_index = i;
+                                m_attack_current = i * m_attack_step;
+                                output = m_last_output;
+                            }
+                            else { // so return to zero
                                 m_stage = adsr_stage::attack;
                                 m_index = 0;
                                 m_attack_current = 0.0;
@@ -322,7 +492,71 @@ namespace c74::min::lib {
             return output;
         }
 
+
+        /// Calculate a vector of samples.
+        /// Rather than deciding what to do at every sample, whole runs of the current segment are calculated at once:
+        /// the sustain and inactive stages are a fill, and ramps are evaluated over a block, which the compiler vectorizes.
+        /// Only the sample at the boundary of a segment is calculated one at a time.
+        /// Curved segments follow the slope's recurrence rather than a pow per sample, so with math::precise the result
+        /// matches calling operator()() for every sample to within 1e-10 of the range of each segment, unless control rate is used.
+        /// @param	output			Storage for the samples.
+        /// @param	frame_count		The number of samples to calculate.
+
+        void process(sample* output, std::size_t frame_count) {
+            std::size_t i = 0;
+
+            while (i < frame_count) {
+                auto		o	= output + i;
+                auto		n	= frame_count - i;
+                std::size_t	run	{};
+
+                switch (m_stage) {
+                    case adsr_stage::attack:
+                        run = segment(m_attack_exp, m_attack_current, m_attack_step, m_attack_step_count, m_initial_cached, m_peak_cached, m_audio_rate_attack, o, n);
+                        break;
+                    case adsr_stage::decay:
+                        run = segment(m_decay_exp, m_decay_current, m_decay_step, m_decay_step_count, m_peak_cached, m_sustain_cached, false, o, n);
+                        break;
+                    case adsr_stage::release:
+                        run = segment(m_release_exp, m_release_current, m_release_step, m_release_step_count, m_sustain_cached, m_end_cached, false, o, n);
+                        break;
+                    case adsr_stage::early_release:
+                        run = segment(m_release_exp, m_release_current, m_release_step, m_release_step_count, m_retrigger_start, m_end_cached, false, o, n);
+                        break;
+                    case adsr_stage::retrigger:
+                        if (m_return_to_zero) {
+                            run = std::min<std::size_t>(n, std::max(m_retrigger_step_count - 1 - m_index, 0));
+                            for (auto j = 0; j < static_cast<int>(run); ++j)
+                                o[j] = m_retrigger_start - (((m_retrigger_start - m_end_cached) / m_retrigger_step_count) * (m_index + 1 + j));
+                            m_index += static_cast<int>(run);
+                        }
+                        break;
+                    case adsr_stage::sustain:
+                        run = n;
+                        std::fill_n(o, n, m_sustain_cached);
+                        break;
+                    case adsr_stage::inactive:
+                        run = n;
+                        std::fill_n(o, n, m_end_cached);
+                        break;
+                }
+
+                if (run) {
+                    m_last_output = o[run - 1];
+                    i += run;
+                }
+
+                // the last sample of a segment changes the stage
+                if (i < frame_count && run < n) {
+                    output[i] = (*this)();
+                    ++i;
+                }
+            }
+        }
+
     private:
+        static constexpr number k_retrigger_tolerance = 1e-7;
+
         int     m_attack_new;
         slope	m_attack_exp;
         number	m_attack_step;
@@ -357,6 +591,80 @@ namespace c74::min::lib {
         int             m_retrigger_step_count {};
         bool            m_return_to_zero { true };
 
+        int                 m_control_interval { 1 };
+        number              m_control_tolerance { 1e-3 };
+        interpolator::type  m_control_interpolation { interpolator::type::linear };
+        bool                m_audio_rate_attack { false };
+
+        /// Find the step of the attack from which to continue when retriggering without returning to zero.
+        /// The attack is monotonic, so the first step that reaches the current output is found with a binary search
+        /// in at most log2(attack steps) evaluations of the curve.
+        /// A step within a small tolerance of the output counts as reaching it, so that retriggering from the attack
+        /// resumes at the same step whether the output came from operator()() or from the approximations in process().
+        /// @return	The number of steps that fall short of the current output, or -1 if the attack never reaches it.
+
+        int retrigger_index() {
+            auto rising  = m_peak_cached > m_initial_cached;
+            auto reached = [this, rising](int i) {
+                auto curved = m_attack_exp((i + 1) * m_attack_step) * (m_peak_cached - m_initial_cached) + m_initial_cached;
+                return rising ? curved > m_last_output - k_retrigger_tolerance : curved < m_last_output + k_retrigger_tolerance;
+            };
+
+            int low  = 0;
+            int high = m_attack_step_count;    // the first step known to reach the output, or the end of the attack
+            while (low < high) {
+                auto middle = low + (high - low) / 2;
+                if (reached(middle))
+                    high = middle;
+                else
+                    low = middle + 1;
+            }
+            return high < m_attack_step_count ? high : -1;
+        }
+
+
+        /// Calculate the run of a ramp up to, but not including, its last sample.
+
+        std::size_t segment(slope& curve, sample& position, number step, int step_count, number from, number to, bool audio_rate, sample* output, std::size_t frame_count) {
+            auto run      = std::min<std::size_t>(frame_count, std::max(step_count - 1 - m_index, 0));
+            auto interval = audio_rate ? 1 : control_interval(curve, step_count, to - from);
+
+            if (interval > 1)
+                interpolator::knots([&curve, step](int i) { return curve(i * step); }, m_control_interpolation, interval, m_index, static_cast<int>(run), step_count, output);
+            else
+                curve(position, step, output, run);
+
+            for (std::size_t j = 0; j < run; ++j)
+                output[j] = output[j] * (to - from) + from;
+
+            for (std::size_t j = 0; j < run; ++j)
+                position += step;
+            m_index += static_cast<int>(run);
+            return run;
+        }
+
+
+        /// Return the spacing of evaluations at control rate for a segment.
+        /// Linear interpolation of x^e with knots h apart, as a fraction of the segment, is within e(e - 1)h^2 / 8 for e >= 2
+        /// and within h^e / 4 for 1 < e < 2, where the curvature is concentrated at the start. The inverted curve is the same reflected.
+
+        int control_interval(const slope& curve, int step_count, number range) const {
+            if (m_control_interval <= 1)
+                return 1;
+
+            auto e = curve.exponent();
+            auto a = std::abs(range);
+            auto h = 1.0;    // the largest spacing within the tolerance, as a fraction of the segment
+
+            if (e >= 2.0)
+                h = std::sqrt(8.0 * m_control_tolerance / (a * e * (e - 1.0)));
+            else if (e > 1.0)
+                h = std::pow(4.0 * m_control_tolerance / a, 1.0 / e);
+
+            return static_cast<int>(std::max(std::min<number>(h * step_count, m_control_interval), 1.0));
+        }
+
+
         void recalc() {
             m_attack_step_count = std::max(m_attack_new, 1);
             m_decay_step_count = std::max(m_decay_new, 1);
@@ -368,5 +676,11 @@ namespace c74::min::lib {
         }
     };
 
+
+    ///	An ADSR envelope with its slopes evaluated by the standard library.
+    ///	This is a class rather than an alias so that it can still be forward declared and specialized for.
+
+    class adsr : public basic_adsr<> {};
+
     
 }  // namespace c74::min::lib
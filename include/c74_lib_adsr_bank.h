@@ -0,0 +1,440 @@
+/// @file
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include "c74_lib_adsr.h"
+#include "c74_lib_math.h"
+
+#include <climits>
+
+
+namespace c74::min::lib {
+
+
+    ///	Many independent ADSR envelopes with shared settings, e.g. for the voices of a granular or percussive synthesizer.
+    ///
+    ///	The state of every envelope is stored in contiguous lanes rather than in separate adsr instances.
+    ///	Active envelopes are kept packed at the front of the lanes, so inactive voices cost nothing,
+    ///	and each sample is calculated for all active envelopes in a single loop over the lanes, which the compiler vectorizes.
+    ///	Whatever its stage, a lane describes its current segment the same way: a ramp with a start, an end, a length and a curve.
+    ///	Processing runs to the next segment boundary of any lane, and only then are the lanes that finished a segment
+    ///	moved on to the next stage.
+    ///
+    ///	Segments follow the adsr class, with the curves calculated by math_policy::pow.
+    ///	Triggering a voice that is already active restarts the attack from its current level,
+    ///	and releasing during the attack or decay releases from the current level.
+    ///	Settings take effect at the start of the next segment of each voice.
+    ///
+    ///	@tparam	math_policy		How the curved segments are evaluated: math::precise by default, or math::fast,
+    ///							whose pow the compiler can vectorize across the lanes.
+
+    template<class math_policy = math::precise>
+    class basic_adsr_bank {
+        using slope = typename basic_adsr<math_policy>::slope;
+
+    public:
+        using adsr_stage	= typename basic_adsr<math_policy>::adsr_stage;
+        using envelope_mode	= typename basic_adsr<math_policy>::envelope_mode;
+
+
+        /// Create a bank of envelopes, all inactive.
+        /// @param	a_voice_count	The number of envelopes.
+
+        explicit basic_adsr_bank(int a_voice_count = 1) {
+            m_voicecount = a_voice_count;
+
+            m_lane.resize(m_voicecount);
+            m_voice.resize(m_voicecount);
+            for (auto v = 0; v < m_voicecount; ++v) {
+                m_lane[v]  = v;
+                m_voice[v] = v;
+            }
+
+            m_stage.resize(m_voicecount, adsr_stage::inactive);
+            m_index.resize(m_voicecount, 0);
+            m_count.resize(m_voicecount, INT_MAX);
+            m_step.resize(m_voicecount, 0.0);
+            m_from.resize(m_voicecount, 0.0);
+            m_delta.resize(m_voicecount, 0.0);
+            m_exponent.resize(m_voicecount, 1.0);
+            m_inverted.resize(m_voicecount, 0.0);
+            m_level.resize(m_voicecount, 0.0);
+            m_tile.resize(m_voicecount * k_tile);
+        }
+
+
+#if 0
+#pragma mark -
+#pragma mark attributes
+#endif
+
+        void mode(envelope_mode mode_value) {
+            m_envelope_mode = mode_value;
+        }
+
+        envelope_mode mode() const {
+            return m_envelope_mode;
+        }
+
+
+        void initial(number initial_value) {
+            m_initial = initial_value;
+        }
+
+        void peak(number peak_value) {
+            m_peak = peak_value;
+        }
+
+        void sustain(number sustain_value) {
+            m_sustain = sustain_value;
+        }
+
+        void end(number end_value) {
+            m_end = end_value;
+        }
+
+
+        /// Set the attack time of the envelopes.
+        /// @param	attack_ms			The attack time in milliseconds.
+        /// @param	sampling_frequency	The sampling frequency of the environment in hertz.
+
+        void attack(number attack_ms, number sampling_frequency) {
+            m_attack_count = std::max(static_cast<int>((attack_ms / 1000.0) * sampling_frequency), 1);
+        }
+
+
+        /// Set the attack slope of the envelopes.
+        /// @param	attack_curve		The attack slope as a +/- percentage.
+
+        void attack_curve(number attack_curve) {
+            m_attack_slope = attack_curve;
+        }
+
+
+        /// Set the decay time of the envelopes.
+        /// @param	decay_ms			The decay time in milliseconds.
+        /// @param	sampling_frequency	The sampling frequency of the environment in hertz.
+
+        void decay(number decay_ms, number sampling_frequency) {
+            m_decay_count = std::max(static_cast<int>((decay_ms / 1000.0) * sampling_frequency), 1);
+        }
+
+
+        /// Set the decay slope of the envelopes.
+        /// @param	decay_curve			The decay slope as a +/- percentage.
+
+        void decay_curve(number decay_curve) {
+            m_decay_slope = decay_curve;
+        }
+
+
+        /// Set the release time of the envelopes.
+        /// @param	release_ms			The release time in milliseconds.
+        /// @param	sampling_frequency	The sampling frequency of the environment in hertz.
+
+        void release(number release_ms, number sampling_frequency) {
+            m_release_count = std::max(static_cast<int>((release_ms / 1000.0) * sampling_frequency), 1);
+        }
+
+
+        /// Set the release slope of the envelopes.
+        /// @param	release_curve		The release slope as a +/- percentage.
+
+        void release_curve(number release_curve) {
+            m_release_slope = release_curve;
+        }
+
+
+        /// Return the number of envelopes.
+        /// @return	The voice count.
+
+        int voice_count() const {
+            return m_voicecount;
+        }
+
+
+        /// Return the number of envelopes that are currently active.
+        /// @return	The active voice count.
+
+        int active_count() const {
+            return m_activecount;
+        }
+
+
+        /// Return whether an envelope is active.
+        /// @param	voice	The voice in the range [0, voice_count - 1].
+        /// @return			True if the envelope has been triggered and has not finished its release.
+
+        bool active(int voice) const {
+            return m_lane[voice] < m_activecount;
+        }
+
+
+        /// Return the stage of an envelope.
+        /// @param	voice	The voice in the range [0, voice_count - 1].
+        /// @return			The stage.
+
+        adsr_stage stage(int voice) const {
+            return m_stage[m_lane[voice]];
+        }
+
+
+        /// Return the most recent output of an envelope.
+        /// @param	voice	The voice in the range [0, voice_count - 1].
+        /// @return			The level.
+
+        number level(int voice) const {
+            return active(voice) ? m_level[m_lane[voice]] : m_end;
+        }
+
+
+#if 0
+#pragma mark -
+#pragma mark methods
+#endif
+
+        /// Start or release an envelope. This takes constant time.
+        /// @param	voice	The voice in the range [0, voice_count - 1].
+        /// @param	active	True to start the attack, false to release.
+
+        void trigger(int voice, bool active) {
+            assert(voice >= 0 && voice < m_voicecount);
+
+            if (active) {
+                if (!this->active(voice)) {
+                    swap_lanes(m_lane[voice], m_activecount);
+                    ++m_activecount;
+                    m_level[m_lane[voice]] = m_initial;
+                }
+                begin(m_lane[voice], adsr_stage::attack);
+            }
+            else if (this->active(voice) && m_stage[m_lane[voice]] != adsr_stage::release)
+                begin(m_lane[voice], adsr_stage::release);
+        }
+
+
+        /// Stop all envelopes immediately.
+
+        void clear() {
+            for (auto lane = 0; lane < m_activecount; ++lane)
+                m_stage[lane] = adsr_stage::inactive;
+            m_activecount = 0;
+        }
+
+
+#if 0
+#pragma mark -
+#pragma mark audio
+#endif
+
+        /// Calculate a vector of samples for every envelope.
+        /// @param	output	Storage with one channel per voice. Inactive voices output the end level.
+
+        void operator()(audio_bundle output) {
+            assert(output.channel_count() >= m_voicecount);
+
+            const auto frame_count = output.frame_count();
+            long       frame       = 0;
+
+            for (auto lane = m_activecount; lane < m_voicecount; ++lane)
+                std::fill_n(output.samples(m_voice[lane]), frame_count, m_end);
+
+            while (frame < frame_count) {
+                // run to the nearest segment boundary
+                auto run = frame_count - frame;
+                for (auto lane = 0; lane < m_activecount; ++lane)
+                    run = std::min<long>(run, m_count[lane] - m_index[lane]);
+
+                // calculate a few samples of every lane, then copy them out to each voice as a contiguous run
+                for (long i = 0; i < run; i += k_tile) {
+                    const auto tile  = std::min<long>(k_tile, run - i);
+                    const auto lanes = m_activecount;
+
+                    for (auto t = 0; t < tile; ++t)
+                        tick(m_tile.data() + t * lanes);
+                    std::copy_n(m_tile.data() + (tile - 1) * lanes, lanes, m_level.data());
+
+                    for (auto lane = 0; lane < lanes; ++lane) {
+                        auto o = output.samples(m_voice[lane]) + frame + i;
+                        for (auto t = 0; t < tile; ++t)
+                            o[t] = m_tile[t * lanes + lane];
+                    }
+                }
+                frame += run;
+
+                // move lanes that finished a segment on to the next stage, from the back since finished envelopes are swapped out
+                for (auto lane = m_activecount - 1; lane >= 0; --lane) {
+                    if (m_index[lane] == m_count[lane]) {
+                        auto voice = m_voice[lane];
+                        next(lane);
+                        if (!active(voice))
+                            std::fill_n(output.samples(voice) + frame, frame_count - frame, m_end);
+                    }
+                }
+            }
+
+            // the sustain never ends, so keep its counter from overflowing
+            for (auto lane = 0; lane < m_activecount; ++lane) {
+                if (m_stage[lane] == adsr_stage::sustain)
+                    m_index[lane] = 0;
+            }
+
+        }
+
+
+    private:
+        static constexpr int k_tile = 16;    // samples calculated for all lanes before they are copied to the output
+
+
+        /// Advance every active lane by one sample.
+        /// @param	row		Storage for the new level of every lane, which may not be the levels themselves.
+
+        void tick(sample* row) {
+            const auto index    = m_index.data();
+            const auto step     = m_step.data();
+            const auto from     = m_from.data();
+            const auto delta    = m_delta.data();
+            const auto exponent = m_exponent.data();
+            const auto inverted = m_inverted.data();
+            const auto lanes    = m_activecount;
+
+            for (auto lane = 0; lane < lanes; ++lane) {
+                auto i = ++index[lane];
+                auto x = i * step[lane];
+
+                // x^e, or 1 - (1 - x)^e for an inverted curve, with arithmetic in place of a branch
+                auto u = x + inverted[lane] * (1.0 - 2.0 * x);
+                auto p = math_policy::pow(u, exponent[lane]);
+                auto y = p + inverted[lane] * (1.0 - 2.0 * p);
+
+                row[lane] = from[lane] + delta[lane] * y;
+            }
+        }
+
+
+        /// Move a lane that finished its segment on to the next stage.
+
+        void next(int lane) {
+            switch (m_stage[lane]) {
+                case adsr_stage::attack:
+                    m_level[lane] = m_peak;    // exactly, without the error of the approximation
+                    begin(lane, adsr_stage::decay);
+                    break;
+                case adsr_stage::decay:
+                    m_level[lane] = m_sustain;
+                    begin(lane, m_envelope_mode == envelope_mode::adsr ? adsr_stage::sustain : adsr_stage::release);
+                    break;
+                default:
+                    m_level[lane]  = m_end;
+                    m_stage[lane]  = adsr_stage::inactive;
+                    swap_lanes(lane, m_activecount - 1);
+                    --m_activecount;
+                    break;
+            }
+        }
+
+
+        /// Start a segment of a lane, from its current level.
+
+        void begin(int lane, adsr_stage stage) {
+            const slope*		curve	{};
+            number				to;
+            int					count;
+
+            switch (stage) {
+                case adsr_stage::attack:
+                    curve = &m_attack_slope;
+                    to    = m_peak;
+                    count = m_attack_count;
+                    break;
+                case adsr_stage::decay:
+                    curve = &m_decay_slope;
+                    to    = m_sustain;
+                    count = m_decay_count;
+                    break;
+                case adsr_stage::sustain:
+                    to    = m_sustain;
+                    count = INT_MAX;
+                    break;
+                default:
+                    curve = &m_release_slope;
+                    to    = m_end;
+                    count = m_release_count;
+                    break;
+            }
+
+            m_stage[lane]    = stage;
+            m_index[lane]    = 0;
+            m_count[lane]    = count;
+            m_step[lane]     = curve ? 1.0 / count : 0.0;
+            m_from[lane]     = m_level[lane];
+            m_delta[lane]    = to - m_level[lane];
+            m_exponent[lane] = curve ? curve->exponent() : 1.0;
+            m_inverted[lane] = curve && curve->inverted() ? 1.0 : 0.0;
+        }
+
+
+        /// Exchange the state of two lanes, and the voices that own them.
+
+        void swap_lanes(int a, int b) {
+            if (a == b)
+                return;
+
+            std::swap(m_voice[a], m_voice[b]);
+            m_lane[m_voice[a]] = a;
+            m_lane[m_voice[b]] = b;
+
+            std::swap(m_stage[a], m_stage[b]);
+            std::swap(m_index[a], m_index[b]);
+            std::swap(m_count[a], m_count[b]);
+            std::swap(m_step[a], m_step[b]);
+            std::swap(m_from[a], m_from[b]);
+            std::swap(m_delta[a], m_delta[b]);
+            std::swap(m_exponent[a], m_exponent[b]);
+            std::swap(m_inverted[a], m_inverted[b]);
+            std::swap(m_level[a], m_level[b]);
+        }
+
+
+        int					m_voicecount	{};
+        int					m_activecount	{};
+        vector<int>			m_lane;					// [voice] the lane holding the state of each voice
+        vector<int>			m_voice;				// [lane] the voice whose state is in each lane
+
+        vector<adsr_stage>	m_stage;				// [lane]
+        vector<int>			m_index;				// samples into the segment
+        vector<int>			m_count;				// length of the segment
+        sample_vector		m_step;					// 1 / length
+        sample_vector		m_from;					// level at the start of the segment
+        sample_vector		m_delta;				// change in level over the segment
+        sample_vector		m_exponent;
+        sample_vector		m_inverted;				// 1 for an inverted curve, 0 otherwise
+        sample_vector		m_level;				// most recent output
+        sample_vector		m_tile;					// [sample * active_count + lane]
+
+        envelope_mode		m_envelope_mode	{ envelope_mode::adsr };
+        number				m_initial		{ 0.0 };
+        number				m_peak			{ 1.0 };
+        number				m_sustain		{ 0.5 };
+        number				m_end			{ 0.0 };
+        int					m_attack_count	{ 1 };
+        int					m_decay_count	{ 1 };
+        int					m_release_count	{ 1 };
+        slope				m_attack_slope;
+        slope				m_decay_slope;
+        slope				m_release_slope;
+    };
+
+
+    ///	A bank of ADSR envelopes with their slopes evaluated by the standard library.
+
+    class adsr_bank : public basic_adsr_bank<> {
+    public:
+        using basic_adsr_bank::basic_adsr_bank;
+    };
+
+
+}    // namespace c74::min::lib
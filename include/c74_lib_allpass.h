@@ -6,6 +6,7 @@
 #pragma once
 
 #include "c74_lib_delay.h"
+#include "c74_lib_denormal.h"
 
 namespace c74::min::lib {
 
@@ -83,6 +84,22 @@ namespace c74::min::lib {
         }
 
 
+        /// Flush the feedback history to zero once it decays below denormal::threshold.
+        /// The feedforward history is not flushed since it only ever holds input samples.
+        /// @param	new_flush	True to flush the history. Default is false.
+
+        void flush_denormals(bool new_flush) {
+            m_flush = new_flush;
+        }
+
+        /// Determine if the feedback history is flushed to zero once it decays below denormal::threshold.
+        /// @return	True if the history is flushed.
+
+        bool flush_denormals() {
+            return m_flush;
+        }
+
+
         ///	This algorithm is an IIR filter, meaning that it relies on feedback.  If the filter should
         ///	not be producing any signal (such as turning audio off and then back on in a host) or if the
         ///	feedback has become corrupted (such as might happen if a NaN is fed in) then it may be
@@ -121,6 +138,8 @@ namespace c74::min::lib {
             //		y = x1  +  alpha * y1  -  alpha * x;
             // Finally, here is a "Single Coefficient All-Pass Filter", dropping from 2 adds and 2 mults down to 2 adds and 1 mult
             auto y = x1 + ((y1 - x) * alpha);
+            if (m_flush)
+                y = denormal::flush(y);
 
             // Store the output in the feedback buffer
             m_feedback_history.write(y);
@@ -132,6 +151,7 @@ namespace c74::min::lib {
         c74::min::lib::delay m_feedforward_history{};    ///< Delay line for the FIR side of the filter.
         c74::min::lib::delay m_feedback_history{};       ///< Delay line for the IIR side of the filter.
         number               m_gain{};                   ///< Feedback coefficient.
+        bool                 m_flush{};                  ///< Flush the feedback history to zero when it becomes very small.
     };
 
 
@@ -0,0 +1,91 @@
+/// @file
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include "c74_lib_filters.h"
+
+namespace c74::min::lib {
+
+
+    ///	Single-channel <a href="https://en.wikipedia.org/wiki/Digital_biquad_filter">biquad</a> filter.
+    ///	Implemented in transposed direct form II, which needs only two state variables and behaves well with floating point.
+    ///	Coefficients are designed using the functions in the filters namespace, e.g. filters::lowpass().
+
+    class biquad {
+    public:
+        /// Default constructor. The filter passes its input unchanged until coefficients are set.
+        /// @param	initial_coefficients	The initial coefficients for the filter.
+
+        explicit biquad(const filters::biquad_coefficients& initial_coefficients = {})
+        : m_coefficients{initial_coefficients} {}
+
+
+        /// Set new coefficients. The filter history is retained.
+        /// @param	new_coefficients	The new coefficients.
+
+        void coefficients(const filters::biquad_coefficients& new_coefficients) {
+            m_coefficients = new_coefficients;
+        }
+
+
+        /// Return the current coefficients.
+        /// @return	The coefficients of the filter.
+
+        const filters::biquad_coefficients& coefficients() const {
+            return m_coefficients;
+        }
+
+
+        /// Clear the filter's history
+
+        void clear() {
+            z_1 = z_2 = 0.0;
+        }
+
+
+        /// Calculate one sample.
+        ///	@return		Calculated sample
+
+        sample operator()(sample x) {
+            auto& c = m_coefficients;
+            auto  y = c.b0 * x + z_1;
+
+            z_1 = c.b1 * x - c.a1 * y + z_2;
+            z_2 = c.b2 * x - c.a2 * y;
+            return y;
+        }
+
+
+        /// Calculate a vector of samples.
+        /// @param	input			The samples to filter.
+        /// @param	output			Storage for the filtered samples. May be the same as input.
+        /// @param	frame_count		The number of samples to process.
+
+        void process(const sample* input, sample* output, std::size_t frame_count) {
+            auto c  = m_coefficients;
+            auto s1 = z_1;
+            auto s2 = z_2;
+
+            for (auto i = 0; i < frame_count; ++i) {
+                auto x = input[i];
+                auto y = c.b0 * x + s1;
+
+                s1        = c.b1 * x - c.a1 * y + s2;
+                s2        = c.b2 * x - c.a2 * y;
+                output[i] = y;
+            }
+            z_1 = s1;
+            z_2 = s2;
+        }
+
+    private:
+        filters::biquad_coefficients m_coefficients;    ///< normalized filter coefficients
+        sample                       z_1{};             ///< first state variable
+        sample                       z_2{};             ///< second state variable
+    };
+
+
+}    // namespace c74::min::lib
@@ -0,0 +1,466 @@
+/// @file
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include "c74_min_api.h"
+#include "c74_lib_fft.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+
+namespace c74::min::lib {
+
+
+    ///	Single-channel, partitioned <a href="https://en.wikipedia.org/wiki/Overlap%E2%80%93save_method">overlap-save</a>
+    ///	convolution with long impulse responses in real time.
+    ///
+    ///	The impulse response is divided into stages. The head of the response is split into partitions of the block size
+    ///	so the latency stays low, and later stages use partitions four times longer than the stage before them,
+    ///	up to a maximum size, so a long tail costs few transforms. Within a stage every partition is the same size and
+    ///	the spectra of past input blocks are kept in a frequency-domain delay line, so each block costs one forward
+    ///	and one inverse real transform per stage plus a complex multiply-accumulate per partition.
+    ///
+    ///	Every later stage starts at least two of its own partitions into the response. Its result is therefore not needed
+    ///	until one partition after its input is complete, which allows it to be calculated on a background thread.
+    ///	The audio thread never waits for, notifies or calculates for that thread. It copies each partition of input into
+    ///	a short queue of the stage, so its cost per partition is a copy of the partition, two atomic loads and an atomic store.
+    ///	If the thread falls behind, every queued partition still enters the delay line but only the newest one is
+    ///	calculated, so the output of the stage drops out for the skipped partitions and is exact again from the next one.
+    ///	Only if the thread falls more than a whole queue behind is input lost, in which case the stage starts again
+    ///	from silence and its output is incomplete until the delay line has refilled.
+    ///
+    ///	The thread sleeps until shortly before the next partition of the shortest stage is expected, from the rate at
+    ///	which they have arrived, and then checks for it every 1/32 of that time, or every k_shortest_sleep microseconds if longer.
+    ///	When no input arrives it backs off to checking every k_longest_sleep microseconds, so the first partitions after
+    ///	the audio starts or resumes can be noticed up to that much later and be partly dropped.
+    ///
+    ///	All memory is allocated when the instance is created. The output is delayed by the block size,
+    ///	which is reported by latency(), and any number of samples may be processed at once.
+
+    class convolver {
+    public:
+        /// Create a convolver instance.
+        /// @param	impulse_response	The impulse response to convolve with.
+        /// @param	block_size			The size of the partitions at the head of the response, which sets the latency.
+        ///								A power of two from 32 to 4096.
+        /// @param	background			Calculate the stages after the head on a background thread.
+        ///								This avoids bursts of work on the audio thread when a long partition is due.
+        ///								process() should then be called with no more than four blocks at a time,
+        ///								or the results of the shortest background stage are due before they can be calculated.
+        /// @param	maximum_partition	The largest partition size used for the tail.
+        ///								Rounded up to a power of two no smaller than the block size.
+
+        explicit convolver(const sample_vector& impulse_response, int block_size = 64, bool background = false, int maximum_partition = 8192) {
+            assert(block_size >= 32 && block_size <= 4096 && (block_size & (block_size - 1)) == 0);
+
+            m_block_size = block_size;
+
+            auto largest = block_size;
+            while (largest < maximum_partition)
+                largest *= 2;
+
+            // Lay out the stages. Each later stage starts two of its partitions into the response.
+
+            const auto length = static_cast<int>(impulse_response.size());
+            auto       size   = block_size;
+            auto       offset = 0;
+
+            while (offset < length) {
+                auto next_size = std::min(size * 4, largest);
+                auto end       = (next_size > size) ? std::min(next_size * 2, length) : length;
+
+                m_stages.push_back(std::make_unique<stage>(impulse_response, offset, end, size));
+                offset = end;
+                size   = next_size;
+            }
+
+            // The input history must hold a partition of the largest stage
+
+            auto history = m_stages.empty() ? block_size : m_stages.back()->size;
+            m_input.resize(history);
+            m_input_mask = history - 1;
+
+            if (background && m_stages.size() > 1)
+                m_worker = std::thread(&convolver::work, this);
+        }
+
+
+        ~convolver() {
+            if (m_worker.joinable()) {
+                m_quit = true;
+                m_worker.join();
+            }
+        }
+
+
+        convolver(const convolver&) = delete;
+        convolver& operator=(const convolver&) = delete;
+
+
+        /// Return the delay introduced by the convolver.
+        /// @return	The latency in samples, which is the block size.
+
+        int latency() const {
+            return m_block_size;
+        }
+
+
+        /// Return the number of stages the impulse response has been divided into.
+        /// @return	The number of stages.
+
+        int stage_count() const {
+            return static_cast<int>(m_stages.size());
+        }
+
+
+        /// Return whether the background thread has calculations still to finish.
+        /// Offline rendering, which runs faster than real time, can wait for this to be false between calls to process()
+        /// so that no partition is skipped.
+        /// @return	True if a stage has input that the background thread has not yet taken.
+
+        bool pending() const {
+            for (auto& s : m_stages) {
+                if (s->consumed.load(std::memory_order_acquire) != s->submitted.load(std::memory_order_relaxed))
+                    return true;
+            }
+            return false;
+        }
+
+
+        /// Return the number of partitions whose output has been dropped because the background thread was behind.
+        /// @return	The number of partitions skipped by all stages since the convolver was created.
+
+        std::uint64_t skipped() const {
+            std::uint64_t count {};
+            for (auto& s : m_stages)
+                count += s->skipped.load(std::memory_order_relaxed);
+            return count;
+        }
+
+
+        /// Clear the convolver's history. Must be called from the audio thread.
+        /// Stages are cleared by whichever thread calculates them, before the first partition of input after this call,
+        /// and windows calculated from earlier input are not read.
+
+        void clear() {
+            for (auto& s : m_stages) {
+                ++s->epoch;
+                s->first_window = static_cast<std::int64_t>(m_time / s->size) + s->lead;
+            }
+            std::fill(m_input.begin(), m_input.end(), 0.0);
+        }
+
+
+        /// Convolve a vector of samples.
+        /// @param	input			The samples to convolve.
+        /// @param	output			Storage for the convolved samples, delayed by latency(). May be the same as input.
+        /// @param	frame_count		The number of samples to process.
+
+        void process(const sample* input, sample* output, std::size_t frame_count) {
+            while (frame_count) {
+                // process up to the end of the current block, so that every stage reads from a single window
+
+                auto n = std::min<std::size_t>(frame_count, m_block_size - (m_time % m_block_size));
+
+                for (auto i = 0; i < n; ++i)
+                    m_input[(m_time + i) & m_input_mask] = input[i];
+
+                std::fill_n(output, n, 0.0);
+                if (m_time >= m_block_size) {
+                    auto t = m_time - m_block_size;
+
+                    for (auto& s : m_stages) {
+                        auto index = static_cast<std::int64_t>(t / s->size);
+                        if (index < s->first_window || s->ready[index % 3].load(std::memory_order_acquire) != index)
+                            continue;    // the window is from before clear(), or the background thread is late and it is not ready
+
+                        auto y = s->window(index) + (t % s->size);
+                        for (auto i = 0; i < n; ++i)
+                            output[i] += y[i];
+                    }
+                }
+
+                m_time += n;
+                input += n;
+                output += n;
+                frame_count -= n;
+
+                if (m_time % m_block_size == 0) {
+                    for (auto s = 0; s < m_stages.size(); ++s) {
+                        if (m_time % m_stages[s]->size == 0)
+                            submit(s);
+                    }
+                }
+            }
+        }
+
+
+    private:
+        static constexpr std::uint64_t	k_queue_size		= 4;		// partitions of input each stage can fall behind by
+        static constexpr int			k_shortest_sleep	= 50;		// microseconds between checks while a partition is due
+        static constexpr int			k_longest_sleep		= 2000;		// microseconds between checks while no input arrives
+
+
+        /// A uniformly partitioned section of the impulse response.
+        /// Spectra are stored in the split form used by real_fft, with size + 1 bins.
+        /// The audio thread owns the queue entries that have not been submitted, and epoch and first_window.
+        /// Everything else belongs to the thread that calculates the stage, and the windows are handed over through ready.
+
+        struct stage {
+            stage(const sample_vector& impulse_response, int start, int end, int partition_size)
+            : size{partition_size}
+            , transform{std::size_t(2 * partition_size)} {
+                const auto points     = 2 * size;
+                const auto bins       = size + 1;
+                const auto partitions = (end - start + size - 1) / size;
+
+                lead = start / size;
+
+                // store the spectrum of each partition, scaled to undo the gain of the unscaled inverse transform
+
+                sample_vector padded(points);
+                for (auto p = 0; p < partitions; ++p) {
+                    std::fill(padded.begin(), padded.end(), 0.0);
+                    for (auto i = 0; i < size && start + p * size + i < end; ++i)
+                        padded[i] = impulse_response[start + p * size + i] / points;
+
+                    responses_real.emplace_back(bins);
+                    responses_imag.emplace_back(bins);
+                    transform.forward(padded.data(), responses_real.back().data(), responses_imag.back().data());
+                }
+
+                delay_line_real.resize(partitions, sample_vector(bins));
+                delay_line_imag.resize(partitions, sample_vector(bins));
+                accumulator_real.resize(bins);
+                accumulator_imag.resize(bins);
+                time.resize(points);
+                result.resize(points);
+                for (auto& w : windows)
+                    w.resize(size);
+                for (auto& r : ready)
+                    r = -1;    // the windows before the first calculation are silent
+                for (auto& e : queue)
+                    e.input.resize(size);
+            }
+
+
+            /// Clear the input history. Called by the thread that calculates the stage.
+
+            void clear() {
+                std::fill(time.begin(), time.end(), 0.0);
+                for (auto& spectrum : delay_line_real)
+                    std::fill(spectrum.begin(), spectrum.end(), 0.0);
+                for (auto& spectrum : delay_line_imag)
+                    std::fill(spectrum.begin(), spectrum.end(), 0.0);
+            }
+
+
+            /// Return the output of the stage for the window of the given index.
+            /// Three windows are kept: one being read, one ready to be read next, and one being calculated.
+
+            const sample* window(std::uint64_t index) const {
+                return windows[index % 3].data();
+            }
+
+
+            /// Calculate the stage from the partitions of input in its queue.
+            /// Every partition enters the delay line, but only the newest is calculated: the windows of any before it are
+            /// already late, so they are skipped rather than delaying the newest one too.
+            /// @return	True if there was any input to calculate.
+
+            bool calculate() {
+                const auto bins       = size + 1;
+                const auto partitions = delay_line_real.size();
+
+                auto next = consumed.load(std::memory_order_relaxed);
+                auto last = submitted.load(std::memory_order_acquire);
+                if (next == last)
+                    return false;
+
+                for (; next != last; ++next) {
+                    auto& entry = queue[next % k_queue_size];
+
+                    if (entry.epoch != calculated_epoch) {
+                        clear();
+                        calculated_epoch = entry.epoch;
+                    }
+
+                    // the time buffer holds the last two partitions of input, and the newest spectrum goes to the front of the delay line
+
+                    std::copy(time.begin() + size, time.end(), time.begin());
+                    std::copy(entry.input.begin(), entry.input.end(), time.begin() + size);
+                    auto target = entry.target;
+                    consumed.store(next + 1, std::memory_order_release);    // the audio thread may reuse the entry now
+
+                    head = (head + partitions - 1) % partitions;
+                    transform.forward(time.data(), delay_line_real[head].data(), delay_line_imag[head].data());
+
+                    if (next + 1 != last) {
+                        skipped.fetch_add(1, std::memory_order_relaxed);
+                        continue;
+                    }
+
+                    auto ar = accumulator_real.data();
+                    auto ai = accumulator_imag.data();
+
+                    std::fill_n(ar, bins, 0.0);
+                    std::fill_n(ai, bins, 0.0);
+                    for (auto p = 0; p < partitions; ++p) {
+                        const auto hr = responses_real[p].data();
+                        const auto hi = responses_imag[p].data();
+                        const auto xr = delay_line_real[(head + p) % partitions].data();
+                        const auto xi = delay_line_imag[(head + p) % partitions].data();
+
+                        for (auto i = 0; i < bins; ++i) {
+                            ar[i] += hr[i] * xr[i] - hi[i] * xi[i];
+                            ai[i] += hr[i] * xi[i] + hi[i] * xr[i];
+                        }
+                    }
+                    transform.inverse(ar, ai, result.data());
+
+                    // the second half of the overlap-save result is the valid output
+
+                    std::copy_n(result.data() + size, size, windows[target % 3].data());
+                    ready[target % 3].store(target, std::memory_order_release);
+                }
+                return true;
+            }
+
+
+            /// A partition of input waiting to be calculated.
+
+            struct entry {
+                sample_vector	input;
+                std::int64_t	target	{};		// the index of the window it is the last input for
+                std::uint64_t	epoch	{};		// the number of times the stage had been cleared when it was submitted
+            };
+
+
+            int						size;					// partition size
+            int						lead			{};		// partitions between the start of the response and this stage
+            real_fft				transform;
+            vector<sample_vector>	responses_real;			// [partition] spectra of the impulse response
+            vector<sample_vector>	responses_imag;
+            vector<sample_vector>	delay_line_real;		// [partition] spectra of past input, newest at head
+            vector<sample_vector>	delay_line_imag;
+            std::size_t				head			{};
+            sample_vector			accumulator_real;
+            sample_vector			accumulator_imag;
+            sample_vector			time;					// the last two partitions of input
+            sample_vector			result;
+            sample_vector			windows[3];				// output windows of one partition
+            std::atomic<std::int64_t>	ready[3];			// the index of the window each holds
+            std::uint64_t			calculated_epoch	{};	// the epoch of the input in the delay line
+
+            entry					queue[k_queue_size];
+            std::atomic<std::uint64_t>	submitted	{};		// partitions put into the queue
+            std::atomic<std::uint64_t>	consumed	{};		// partitions taken from the queue
+            std::atomic<std::uint64_t>	skipped		{};		// partitions whose window was dropped
+            std::uint64_t			epoch			{};		// incremented to clear the stage before its next input
+            std::int64_t			first_window	{};		// the first window calculated after the last clear()
+        };
+
+
+        /// Queue a partition of input for a stage once it is complete, and calculate it unless the background thread will.
+        /// If the queue is full the partition is dropped, and the stage starts again from silence with the next one.
+
+        void submit(int index) {
+            auto& s = *m_stages[index];
+            auto  n = s.submitted.load(std::memory_order_relaxed);
+
+            if (n - s.consumed.load(std::memory_order_acquire) == k_queue_size) {
+                ++s.epoch;
+                s.skipped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            auto& e = s.queue[n % k_queue_size];
+            for (auto i = 0; i < s.size; ++i)
+                e.input[i] = m_input[(m_time - s.size + i) & m_input_mask];
+
+            // the window that starts where this input ends, plus the number of partitions before the stage starts
+            e.target = static_cast<std::int64_t>(m_time / s.size) - 1 + s.lead;
+            e.epoch  = s.epoch;
+            s.submitted.store(n + 1, std::memory_order_release);
+
+            if (index == 0 || !m_worker.joinable())
+                s.calculate();
+        }
+
+
+        /// The background thread. Stages are calculated shortest first since they are due soonest.
+        /// It learns the time between partitions of the shortest stage as they arrive, so that it can sleep until
+        /// the next one is nearly due instead of checking for it all the time.
+
+        void work() {
+            using clock = std::chrono::steady_clock;
+
+            const std::chrono::microseconds shortest_sleep {k_shortest_sleep};
+            const std::chrono::microseconds longest_sleep {k_longest_sleep};
+
+            auto&				shortest	= *m_stages[1];
+            auto				seen		= shortest.submitted.load(std::memory_order_acquire);
+            auto				arrival		= clock::now();			// when the last partition of the shortest stage was noticed
+            auto				arrived		= false;
+            clock::duration		period		{};						// the estimated time between its partitions
+            clock::duration		backoff		{shortest_sleep};
+
+            while (!m_quit.load(std::memory_order_acquire)) {
+                auto submitted = shortest.submitted.load(std::memory_order_acquire);
+                if (submitted != seen) {
+                    // the estimate follows shorter intervals at once, so as not to sleep through a partition,
+                    // and longer ones slowly, while a gap of more than four periods means the input stopped for a while
+                    auto now		= clock::now();
+                    auto interval	= (now - arrival) / static_cast<int>(submitted - seen);
+                    if (arrived && (period == clock::duration::zero() || interval < period))
+                        period = interval;
+                    else if (arrived && interval < 4 * period)
+                        period += (interval - period) / 8;
+                    arrived	= true;
+                    arrival	= now;
+                    seen	= submitted;
+                }
+
+                auto busy = false;
+                for (auto s = 1; s < m_stages.size() && !busy; ++s)
+                    busy = m_stages[s]->calculate();
+                if (busy) {
+                    backoff = shortest_sleep;
+                    continue;
+                }
+
+                auto now = clock::now();
+                if (period != clock::duration::zero() && now - arrival < 4 * period) {
+                    auto due = arrival + period * 7 / 8;
+                    if (now < due)
+                        std::this_thread::sleep_until(due);
+                    else
+                        std::this_thread::sleep_for(std::max<clock::duration>(period / 32, shortest_sleep));
+                }
+                else {
+                    std::this_thread::sleep_for(backoff);
+                    backoff = std::min<clock::duration>(backoff * 2, longest_sleep);
+                }
+            }
+        }
+
+
+        int							m_block_size	{};
+        vector<std::unique_ptr<stage>>	m_stages;
+        sample_vector				m_input;						// ring of recent input
+        std::uint64_t				m_input_mask	{};
+        std::uint64_t				m_time			{};				// samples processed since creation or clear()
+
+        std::thread					m_worker;
+        std::atomic<bool>			m_quit			{};
+    };
+
+
+}    // namespace c74::min::lib
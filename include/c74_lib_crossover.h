@@ -0,0 +1,100 @@
+/// @file
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include "c74_lib_biquad.h"
+
+namespace c74::min::lib {
+
+
+    ///	Single-channel, fourth-order <a href="https://en.wikipedia.org/wiki/Linkwitz%E2%80%93Riley_filter">Linkwitz-Riley</a> crossover.
+    ///	Splits a signal into low and high bands that sum back to an allpass response with a flat magnitude.
+    ///	Each side is a pair of cascaded second-order Butterworth sections.
+
+    class linkwitz_riley {
+    public:
+        /// Coefficients shared by all channels split at the same frequency.
+
+        struct coefficients {
+            filters::biquad_coefficients lowpass;     ///< one of the two identical lowpass sections
+            filters::biquad_coefficients highpass;    ///< one of the two identical highpass sections
+            filters::biquad_coefficients allpass;     ///< the phase response of the summed bands, used to align other bands
+        };
+
+
+        /// Calculate the coefficients for a crossover frequency.
+        /// @param	frequency			The crossover frequency in hertz.
+        /// @param	sampling_frequency	The sampling frequency of the environment in hertz.
+        /// @return						The coefficients for the crossover.
+
+        static coefficients design(number frequency, number sampling_frequency) {
+            constexpr auto q = 0.7071067811865476;    // Butterworth
+            return {filters::lowpass(frequency, q, sampling_frequency), filters::highpass(frequency, q, sampling_frequency),
+                filters::allpass(frequency, q, sampling_frequency)};
+        }
+
+
+        /// Set the crossover frequency.
+        /// @param	frequency			The crossover frequency in hertz.
+        /// @param	sampling_frequency	The sampling frequency of the environment in hertz.
+
+        void frequency(number frequency, number sampling_frequency) {
+            set(design(frequency, sampling_frequency));
+        }
+
+
+        /// Set precalculated coefficients.
+        /// @param	new_coefficients	Coefficients returned by design().
+
+        void set(const coefficients& new_coefficients) {
+            for (auto& filter : m_lowpass)
+                filter.coefficients(new_coefficients.lowpass);
+            for (auto& filter : m_highpass)
+                filter.coefficients(new_coefficients.highpass);
+        }
+
+
+        /// Clear the filter's history
+
+        void clear() {
+            for (auto& filter : m_lowpass)
+                filter.clear();
+            for (auto& filter : m_highpass)
+                filter.clear();
+        }
+
+
+        /// Split one sample.
+        /// @param	x		The input sample.
+        /// @param	low		Receives the low band.
+        /// @param	high	Receives the high band.
+
+        void operator()(sample x, sample& low, sample& high) {
+            low  = m_lowpass[1](m_lowpass[0](x));
+            high = m_highpass[1](m_highpass[0](x));
+        }
+
+
+        /// Split a vector of samples.
+        /// @param	input			The samples to split.
+        /// @param	low				Storage for the low band. May not be the same as input.
+        /// @param	high			Storage for the high band. May be the same as input.
+        /// @param	frame_count		The number of samples to process.
+
+        void process(const sample* input, sample* low, sample* high, std::size_t frame_count) {
+            m_lowpass[0].process(input, low, frame_count);
+            m_lowpass[1].process(low, low, frame_count);
+            m_highpass[0].process(input, high, frame_count);
+            m_highpass[1].process(high, high, frame_count);
+        }
+
+    private:
+        biquad m_lowpass[2];     ///< cascaded Butterworth lowpass sections
+        biquad m_highpass[2];    ///< cascaded Butterworth highpass sections
+    };
+
+
+}    // namespace c74::min::lib
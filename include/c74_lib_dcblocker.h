@@ -5,7 +5,9 @@
 
 #pragma once
 
-#include "c74_min_api.h"
+#include "c74_lib_denormal.h"
+
+#include <array>
 
 namespace c74::min::lib {
 
@@ -14,6 +16,22 @@ namespace c74::min::lib {
 
     class dcblocker {
     public:
+        /// Flush the filter's feedback history to zero once it decays below denormal::threshold.
+        /// With a feedback coefficient of 0.9997 the history takes millions of samples to decay through the subnormal range otherwise.
+        /// @param	new_flush	True to flush the history. Default is false.
+
+        void flush_denormals(bool new_flush) {
+            m_flush = new_flush;
+        }
+
+        /// Determine if the filter's feedback history is flushed to zero once it decays below denormal::threshold.
+        /// @return	True if the history is flushed.
+
+        bool flush_denormals() {
+            return m_flush;
+        }
+
+
         /// Clear the filter's history
 
         void clear() {
@@ -26,14 +44,108 @@ namespace c74::min::lib {
 
         sample operator()(sample x) {
             auto y = x - x_1 + y_1 * 0.9997;
-            y_1    = y;
-            x_1    = x;
+            if (m_flush)
+                y = denormal::flush(y);
+            y_1 = y;
+            x_1 = x;
             return y;
         }
 
     private:
         sample x_1{};    ///< feedforward history
         sample y_1{};    ///< feedback history
+        bool   m_flush{};    ///< flush the feedback history to zero when it becomes very small
+    };
+
+
+    ///	A bank of N dc-blocking filters, e.g. for a multichannel input.
+    ///	The histories are stored as arrays and every channel is updated by the same loop,
+    ///	so the compiler can update several channels with each vector instruction.
+    ///	@tparam	channel_count	The number of filters in the bank.
+
+    template<int channel_count>
+    class dcblocker_bank {
+    public:
+        using frame = std::array<sample, channel_count>;    ///< one sample for each channel
+
+
+        /// Flush the feedback histories to zero once they decay below denormal::threshold.
+        /// @param	new_flush	True to flush the histories. Default is false.
+
+        void flush_denormals(bool new_flush) {
+            m_flush = new_flush;
+        }
+
+        /// Determine if the feedback histories are flushed to zero once they decay below denormal::threshold.
+        /// @return	True if the histories are flushed.
+
+        bool flush_denormals() {
+            return m_flush;
+        }
+
+
+        /// Clear the history of all channels.
+
+        void clear() {
+            x_1.fill(0.0);
+            y_1.fill(0.0);
+        }
+
+
+        /// Calculate one sample for every channel.
+        /// @param	x	The input sample for each channel.
+        ///	@return		The calculated sample for each channel.
+
+        frame operator()(const frame& x) {
+            tick(x.data());
+            return y_1;
+        }
+
+
+        /// Calculate a vector of interleaved frames, i.e. channel_count samples per frame.
+        /// @param	input			The frames to filter.
+        /// @param	output			Storage for the filtered frames. May be the same as input.
+        /// @param	frame_count		The number of frames to process.
+
+        void process(const sample* input, sample* output, std::size_t frame_count) {
+            for (auto i = 0; i < frame_count; ++i) {
+                tick(input + i * channel_count);
+                std::copy_n(y_1.data(), channel_count, output + i * channel_count);
+            }
+        }
+
+
+        /// Calculate n-samples for channel_count channels.
+        /// The number of channels at the input and output must match the channel count of the bank.
+
+        void operator()(audio_bundle input, audio_bundle output) {
+            frame x;
+
+            for (auto i = 0; i < input.frame_count(); ++i) {
+                for (auto channel = 0; channel < channel_count; ++channel)
+                    x[channel] = input.samples(channel)[i];
+                tick(x.data());
+                for (auto channel = 0; channel < channel_count; ++channel)
+                    output.samples(channel)[i] = y_1[channel];
+            }
+        }
+
+    private:
+        void tick(const sample* x) {
+            for (auto channel = 0; channel < channel_count; ++channel) {
+                auto y       = x[channel] - x_1[channel] + y_1[channel] * 0.9997;
+                x_1[channel] = x[channel];
+                y_1[channel] = y;
+            }
+            if (m_flush) {
+                for (auto& y : y_1)
+                    y = denormal::flush(y);
+            }
+        }
+
+        frame	x_1{};		///< feedforward histories
+        frame	y_1{};		///< feedback histories
+        bool	m_flush{};	///< flush the feedback histories to zero when they become very small
     };
 
 
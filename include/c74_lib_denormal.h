@@ -0,0 +1,125 @@
+/// @file
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include "c74_min_api.h"
+
+#include <cstdint>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define MIN_LIB_DENORMAL_MXCSR 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define MIN_LIB_DENORMAL_FPCR 1
+#endif
+
+
+namespace c74::min::lib {
+
+    /// Tools for avoiding <a href="https://en.wikipedia.org/wiki/Subnormal_number">subnormal numbers</a>.
+    /// Feedback processors decay toward zero once their input goes silent, and on most CPUs every operation
+    /// on the resulting subnormal values is many times slower than on normal values.
+    ///
+    /// Two remedies are provided.
+    /// A guard sets the flush-to-zero and denormals-are-zero modes of the CPU for the duration of a block.
+    /// The processors with feedback can also flush their own history, which works regardless of how the host has set up the CPU.
+
+    namespace denormal {
+
+
+        /// Values with a smaller magnitude than this are flushed to zero.
+        /// At roughly -300 dB this is far below anything audible but still far above the subnormal range,
+        /// so a decaying signal is flushed long before it becomes subnormal.
+
+        constexpr number threshold = 1e-15;
+
+
+        /// Flush a sample to zero if its magnitude is below the threshold.
+        /// @param	x	The sample to flush.
+        /// @return		The sample, or zero.
+
+        constexpr sample flush(sample x) noexcept {
+            return (x < threshold && x > -threshold) ? 0.0 : x;
+        }
+
+
+        ///	Enable flush-to-zero and denormals-are-zero for the current thread while in scope.
+        ///	The previous state of the floating point control register is restored when the guard goes out of scope,
+        ///	so guards may be nested and it is safe to use them in code called by a host that manages the register itself.
+        ///	On platforms without these modes the guard does nothing.
+        ///
+        ///	@code
+        ///	void operator()(audio_bundle input, audio_bundle output) {
+        ///		denormal::guard g;
+        ///		// ...
+        ///	}
+        ///	@endcode
+
+        class guard {
+        public:
+            guard() noexcept {
+                m_saved = get();
+                set(m_saved | k_flags);
+            }
+
+            ~guard() noexcept {
+                set(m_saved);
+            }
+
+            guard(const guard&) = delete;
+            guard& operator=(const guard&) = delete;
+
+
+            /// Determine if the guard changes the behavior of the CPU on this platform.
+            /// @return	True if flush-to-zero is available.
+
+            static constexpr bool supported() {
+                return k_flags != 0;
+            }
+
+        private:
+#if defined(MIN_LIB_DENORMAL_MXCSR)
+            using register_type = unsigned int;
+            static constexpr register_type k_flags = 0x8040;    // FTZ (bit 15) and DAZ (bit 6)
+
+            static register_type get() noexcept {
+                return _mm_getcsr();
+            }
+
+            static void set(register_type value) noexcept {
+                _mm_setcsr(value);
+            }
+#elif defined(MIN_LIB_DENORMAL_FPCR) && !defined(_MSC_VER)
+            using register_type = std::uint64_t;
+            static constexpr register_type k_flags = 1 << 24;    // FZ (bit 24)
+
+            static register_type get() noexcept {
+                register_type value;
+                asm volatile("mrs %0, fpcr" : "=r"(value));
+                return value;
+            }
+
+            static void set(register_type value) noexcept {
+                asm volatile("msr fpcr, %0" : : "r"(value));
+            }
+#else
+            using register_type = unsigned int;
+            static constexpr register_type k_flags = 0;
+
+            static register_type get() noexcept {
+                return 0;
+            }
+
+            static void set(register_type) noexcept {}
+#endif
+
+            register_type m_saved;
+        };
+
+
+    }    // namespace denormal
+
+}    // namespace c74::min::lib
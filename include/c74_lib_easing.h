@@ -5,6 +5,11 @@
 
 #pragma once
 
+#include "c74_lib_interpolator.h"
+
+#include <array>
+#include <utility>
+
 namespace c74::min::lib::easing {
 
 
@@ -21,42 +26,59 @@ namespace c74::min::lib::easing {
 
     /// The "in-back" easing function as formalized and popularized by Robert Penner.
     /// @tparam	T		The type of number to use for the calculations (e.g. float, double, number, or sample).
+    ///	@tparam	math_policy		How the elementary functions are evaluated: math::precise by default, or math::fast.
     ///	@param	x		The value to feed as input into the easing function.
     ///	@return			The output of the easing function.
 
-    template<typename T>
+    template<typename T, class math_policy = math::precise>
     T in_back(T x) {
-        return x * x * x - x * sin(x * M_PI);
+        return x * x * x - x * math_policy::sin(x * M_PI);
     }
 
 
     /// The "in-out-back" easing function as formalized and popularized by Robert Penner.
     /// @tparam	T		The type of number to use for the calculations (e.g. float, double, number, or sample).
+    ///	@tparam	math_policy		How the elementary functions are evaluated: math::precise by default, or math::fast.
     ///	@param	x		The value to feed as input into the easing function.
     ///	@return			The output of the easing function.
 
-    template<typename T>
+    template<typename T, class math_policy = math::precise>
     T in_out_back(T x) {
-        if (x < 0.5) {
-            double f = 2 * x;
-            return 0.5 * (f * f * f - f * sin(f * M_PI));
-        }
-        else {
-            double f = (1 - (2 * x - 1));
-            return 0.5 * (1 - (f * f * f - f * sin(f * M_PI))) + 0.5;
-        }
+        // both halves are the same curve, so the argument and the result are selected rather than branched on
+        bool	first	= x < 0.5;
+        double	f		= math::select(first, 2 * x, (1 - (2 * x - 1)));
+        double	y		= f * f * f - f * math_policy::sin(f * M_PI);
+        return math::select(first, 0.5 * y, 0.5 * (1 - y) + 0.5);
     }
 
 
     /// The "out-back" easing function as formalized and popularized by Robert Penner.
     /// @tparam	T		The type of number to use for the calculations (e.g. float, double, number, or sample).
+    ///	@tparam	math_policy		How the elementary functions are evaluated: math::precise by default, or math::fast.
     ///	@param	x		The value to feed as input into the easing function.
     ///	@return			The output of the easing function.
 
-    template<typename T>
+    template<typename T, class math_policy = math::precise>
     T out_back(T x) {
         double f = 1.0 - x;
-        return 1 - (f * f * f - f * sin(f * M_PI));
+        return 1 - (f * f * f - f * math_policy::sin(f * M_PI));
+    }
+
+
+    /// The four parabolas of the bounce functions, which meet at 4/11, 8/11 and 9/10.
+    /// Every parabola is evaluated and the result is selected with math::select() rather than branched on.
+    ///	@param	x		The value to feed as input into the curve.
+    ///	@return			The output of the curve.
+
+    inline double bounce(double x) {
+        double a = (121 * x * x) / 16.0;
+        double b = (363 / 40.0 * x * x) - (99 / 10.0 * x) + 17 / 5.0;
+        double c = (4356 / 361.0 * x * x) - (35442 / 1805.0 * x) + 16061 / 1805.0;
+        double d = (54 / 5.0 * x * x) - (513 / 25.0 * x) + 268 / 25.0;
+
+        double y = math::select(x < 9 / 10.0, c, d);
+        y        = math::select(x < 8 / 11.0, b, y);
+        return math::select(x < 4 / 11.0, a, y);
     }
 
 
@@ -67,18 +89,7 @@ namespace c74::min::lib::easing {
 
     template<typename T>
     T in_bounce(T x) {
-        double f = 1.0 - x;
-        double y;
-
-        if (f < 4 / 11.0)
-            y = (121 * f * f) / 16.0;
-        else if (f < 8 / 11.0)
-            y = (363 / 40.0 * f * f) - (99 / 10.0 * f) + 17 / 5.0;
-        else if (f < 9 / 10.0)
-            y = (4356 / 361.0 * f * f) - (35442 / 1805.0 * f) + 16061 / 1805.0;
-        else
-            y = (54 / 5.0 * f * f) - (513 / 25.0 * f) + 268 / 25.0;
-        return 1.0 - y;
+        return 1.0 - bounce(1.0 - x);
     }
 
 
@@ -89,34 +100,9 @@ namespace c74::min::lib::easing {
 
     template<typename T>
     T in_out_bounce(T x) {
-        if (x < 0.5) {
-            double f = 1 - 2 * x;
-            double y;
-
-            if (f < 4 / 11.0)
-                y = (121 * f * f) / 16.0;
-            else if (f < 8 / 11.0)
-                y = (363 / 40.0 * f * f) - (99 / 10.0 * f) + 17 / 5.0;
-            else if (f < 9 / 10.0)
-                y = (4356 / 361.0 * f * f) - (35442 / 1805.0 * f) + 16061 / 1805.0;
-            else
-                y = (54 / 5.0 * f * f) - (513 / 25.0 * f) + 268 / 25.0;
-            return 0.5 * (1 - y);
-        }
-        else {
-            double f = x * 2 - 1;
-            double y;
-
-            if (f < 4 / 11.0)
-                y = (121 * f * f) / 16.0;
-            else if (f < 8 / 11.0)
-                y = (363 / 40.0 * f * f) - (99 / 10.0 * f) + 17 / 5.0;
-            else if (f < 9 / 10.0)
-                y = (4356 / 361.0 * f * f) - (35442 / 1805.0 * f) + 16061 / 1805.0;
-            else
-                y = (54 / 5.0 * f * f) - (513 / 25.0 * f) + 268 / 25.0;
-            return 0.5 * y + 0.5;
-        }
+        bool	first	= x < 0.5;
+        double	y		= bounce(math::select(first, 1 - 2 * x, x * 2 - 1));
+        return math::select(first, 0.5 * (1 - y), 0.5 * y + 0.5);
     }
 
 
@@ -127,14 +113,7 @@ namespace c74::min::lib::easing {
 
     template<typename T>
     T out_bounce(T x) {
-        if (x < 4 / 11.0)
-            return (121 * x * x) / 16.0;
-        else if (x < 8 / 11.0)
-            return (363 / 40.0 * x * x) - (99 / 10.0 * x) + 17 / 5.0;
-        else if (x < 9 / 10.0)
-            return (4356 / 361.0 * x * x) - (35442 / 1805.0 * x) + 16061 / 1805.0;
-        else
-            return (54 / 5.0 * x * x) - (513 / 25.0 * x) + 268 / 25.0;
+        return bounce(x);
     }
 
 
@@ -157,14 +136,10 @@ namespace c74::min::lib::easing {
 
     template<typename T>
     T in_out_circular(T x) {
-        if (x < 0.5) {
-            x = 1 - 4 * (x * x);
-            return 0.5 * (1 - sqrt( std::max(x, 0.0) ));
-        }
-        else {
-            x = -((2 * x) - 3) * ((2 * x) - 1);
-            return 0.5 * (sqrt( std::max(x, 0.0) ) + 1);
-        }
+        bool	first	= x < 0.5;
+        double	r		= math::select(first, 1 - 4 * (x * x), -((2 * x) - 3) * ((2 * x) - 1));
+        double	y		= std::sqrt( math::select(r > 0.0, r, 0.0) );
+        return math::select(first, 0.5 * (1 - y), 0.5 * (y + 1));
     }
 
 
@@ -198,12 +173,8 @@ namespace c74::min::lib::easing {
 
     template<typename T>
     T in_out_cubic(T x) {
-        if (x < 0.5)
-            return 4.0 * x * x * x;
-        else {
-            double f = ((2 * x) - 2);
-            return 0.5 * f * f * f + 1;
-        }
+        double f = ((2 * x) - 2);
+        return math::select(x < 0.5, 4.0 * x * x * x, 0.5 * f * f * f + 1);
     }
 
 
@@ -221,81 +192,82 @@ namespace c74::min::lib::easing {
 
     /// The "in-elastic" easing function as formalized and popularized by Robert Penner.
     /// @tparam	T		The type of number to use for the calculations (e.g. float, double, number, or sample).
+    ///	@tparam	math_policy		How the elementary functions are evaluated: math::precise by default, or math::fast.
     ///	@param	x		The value to feed as input into the easing function.
     ///	@return			The output of the easing function.
 
-    template<typename T>
+    template<typename T, class math_policy = math::precise>
     T in_elastic(T x) {
-        return sin(6.5 * M_PI * x) * pow(2, 10 * (x - 1));
+        return math_policy::sin(6.5 * M_PI * x) * math_policy::exp2(10 * (x - 1));
     }
 
 
     /// The "in-out-elastic" easing function as formalized and popularized by Robert Penner.
     /// @tparam	T		The type of number to use for the calculations (e.g. float, double, number, or sample).
+    ///	@tparam	math_policy		How the elementary functions are evaluated: math::precise by default, or math::fast.
     ///	@param	x		The value to feed as input into the easing function.
     ///	@return			The output of the easing function.
 
-    template<typename T>
+    template<typename T, class math_policy = math::precise>
     T in_out_elastic(T x) {
-        if (x < 0.5)
-            return 0.5 * sin(6.5 * M_PI * (2 * x)) * pow(2, 10 * ((2 * x) - 1));
-        else
-            return 0.5 * (sin(-6.5 * M_PI * ((2 * x - 1) + 1)) * pow(2, -10 * (2 * x - 1)) + 2);
+        // the second half is the first one mirrored, so only the signs of the arguments are selected
+        bool	first	= x < 0.5;
+        double	s		= math::select(first, 1.0, -1.0);
+        double	y		= math_policy::sin(s * 6.5 * M_PI * (2 * x)) * math_policy::exp2(s * 10 * ((2 * x) - 1));
+        return math::select(first, 0.5 * y, 0.5 * (y + 2));
     }
 
 
     /// The "out-elastic" easing function as formalized and popularized by Robert Penner.
     /// @tparam	T		The type of number to use for the calculations (e.g. float, double, number, or sample).
+    ///	@tparam	math_policy		How the elementary functions are evaluated: math::precise by default, or math::fast.
     ///	@param	x		The value to feed as input into the easing function.
     ///	@return			The output of the easing function.
 
-    template<typename T>
+    template<typename T, class math_policy = math::precise>
     T out_elastic(T x) {
-        return sin(-6.5 * M_PI * (x + 1)) * pow(2, -10 * x) + 1;
+        return math_policy::sin(-6.5 * M_PI * (x + 1)) * math_policy::exp2(-10 * x) + 1;
     }
 
 
     /// The "in-exponential" easing function as formalized and popularized by Robert Penner.
     /// @tparam	T		The type of number to use for the calculations (e.g. float, double, number, or sample).
+    ///	@tparam	math_policy		How the elementary functions are evaluated: math::precise by default, or math::fast.
     ///	@param	x		The value to feed as input into the easing function.
     ///	@return			The output of the easing function.
 
-    template<typename T>
+    template<typename T, class math_policy = math::precise>
     T in_exponential(T x) {
-        if (x == 0.0)
-            return x;
-        else
-            return pow(2, 10 * (x - 1));
+        double y = math_policy::exp2(10 * (x - 1));
+        return math::select(x == 0.0, x, y);
     }
 
 
     /// The "in-out-exponential" easing function as formalized and popularized by Robert Penner.
     /// @tparam	T		The type of number to use for the calculations (e.g. float, double, number, or sample).
+    ///	@tparam	math_policy		How the elementary functions are evaluated: math::precise by default, or math::fast.
     ///	@param	x		The value to feed as input into the easing function.
     ///	@return			The output of the easing function.
 
-    template<typename T>
+    template<typename T, class math_policy = math::precise>
     T in_out_exponential(T x) {
-        if (x == 0.0 || x == 1.0)
-            return x;
-        else if (x < 0.5)
-            return 0.5 * pow(2, (20 * x) - 10);
-        else
-            return -0.5 * pow(2, (-20 * x) + 10) + 1;
+        bool	first	= x < 0.5;
+        double	y		= 0.5 * math_policy::exp2(math::select(first, (20 * x) - 10, (-20 * x) + 10));
+        y				= math::select(first, y, -y + 1);
+        return math::select(x == 0.0 || x == 1.0, x, y);
     }
 
 
     /// The "out-exponential" easing function as formalized and popularized by Robert Penner.
     /// @tparam	T		The type of number to use for the calculations (e.g. float, double, number, or sample).
+    ///	@tparam	math_policy		How the elementary functions are evaluated: math::precise by default, or math::fast.
     ///	@param	x		The value to feed as input into the easing function.
     ///	@return			The output of the easing function.
 
-    template<typename T>
+    template<typename T, class math_policy = math::precise>
     T out_exponential(T x) {
-        if (x == 1.0)
-            return x;
-        else
-            return 1 - pow(2, -10 * x);
+        double y = 1 - math_policy::exp2(-10 * x);
+        return math::select(x == 1.0, x, y);
     }
 
 
@@ -317,10 +289,7 @@ namespace c74::min::lib::easing {
 
     template<typename T>
     T in_out_quadratic(T x) {
-        if (x < 0.5)
-            return 2 * x * x;
-        else
-            return (-2 * x * x) + (4 * x) - 1;
+        return math::select(x < 0.5, 2 * x * x, (-2 * x * x) + (4 * x) - 1);
     }
 
 
@@ -353,12 +322,8 @@ namespace c74::min::lib::easing {
 
     template<typename T>
     T in_out_quartic(T x) {
-        if (x < 0.5)
-            return 8 * x * x * x * x;
-        else {
-            double f = (x - 1);
-            return -8 * f * f * f * f + 1;
-        }
+        double f = (x - 1);
+        return math::select(x < 0.5, 8 * x * x * x * x, -8 * f * f * f * f + 1);
     }
 
 
@@ -392,12 +357,8 @@ namespace c74::min::lib::easing {
 
     template<typename T>
     T in_out_quintic(T x) {
-        if (x < 0.5)
-            return 16 * x * x * x * x * x;
-        else {
-            double f = ((2 * x) - 2);
-            return 0.5 * f * f * f * f * f + 1;
-        }
+        double f = ((2 * x) - 2);
+        return math::select(x < 0.5, 16 * x * x * x * x * x, 0.5 * f * f * f * f * f + 1);
     }
 
 
@@ -415,34 +376,37 @@ namespace c74::min::lib::easing {
 
     /// The "in-sine" easing function as formalized and popularized by Robert Penner.
     /// @tparam	T		The type of number to use for the calculations (e.g. float, double, number, or sample).
+    ///	@tparam	math_policy		How the elementary functions are evaluated: math::precise by default, or math::fast.
     ///	@param	x		The value to feed as input into the easing function.
     ///	@return			The output of the easing function.
 
-    template<typename T>
+    template<typename T, class math_policy = math::precise>
     T in_sine(T x) {
-        return sin((x - 1) * M_PI * 0.5) + 1;
+        return math_policy::sin((x - 1) * M_PI * 0.5) + 1;
     }
 
 
     /// The "in-out-sine" easing function as formalized and popularized by Robert Penner.
     /// @tparam	T		The type of number to use for the calculations (e.g. float, double, number, or sample).
+    ///	@tparam	math_policy		How the elementary functions are evaluated: math::precise by default, or math::fast.
     ///	@param	x		The value to feed as input into the easing function.
     ///	@return			The output of the easing function.
 
-    template<typename T>
+    template<typename T, class math_policy = math::precise>
     T in_out_sine(T x) {
-        return 0.5 * (1 - cos(x * M_PI));
+        return 0.5 * (1 - math_policy::cos(x * M_PI));
     }
 
 
     /// The "out-sine" easing function as formalized and popularized by Robert Penner.
     /// @tparam	T		The type of number to use for the calculations (e.g. float, double, number, or sample).
+    ///	@tparam	math_policy		How the elementary functions are evaluated: math::precise by default, or math::fast.
     ///	@param	x		The value to feed as input into the easing function.
     ///	@return			The output of the easing function.
 
-    template<typename T>
+    template<typename T, class math_policy = math::precise>
     T out_sine(T x) {
-        return sin(x * M_PI * 0.5);
+        return math_policy::sin(x * M_PI * 0.5);
     }
 
 
@@ -585,4 +549,326 @@ namespace c74::min::lib::easing {
     }
 
 
+    /// One of the standard easing functions chosen at compile time, as a stateless function object.
+    /// Where the curve is known in advance, using it as a template argument lets the compiler inline it
+    /// and fuse it with the arithmetic around it, which neither apply() nor a function pointer allow.
+    /// It can also stand in for a two-point interpolator, e.g. as an eased crossfade.
+    /// @tparam	F				The easing function as enumerated in the #easing::function enum.
+    /// @tparam	math_policy		How the elementary functions are evaluated: math::precise by default, or math::fast.
+
+    template<easing::function F, class math_policy = math::precise>
+    struct curve {
+        static_assert(F != easing::function::enum_count, "enum_count is not an easing function");
+
+        static constexpr easing::function name = F;    ///< the easing function
+
+
+        /// Apply the easing function to a number.
+        /// @tparam	T		The type of number to use for the calculations (e.g. float, double, number, or sample).
+        ///	@param	x		The value to feed as input into the easing function.
+        ///	@return			The "eased" output.
+
+        template<typename T>
+        T operator()(T x) const noexcept {
+            if constexpr (F == easing::function::linear)
+                return linear<T>(x);
+            else if constexpr (F == easing::function::in_back)
+                return in_back<T, math_policy>(x);
+            else if constexpr (F == easing::function::in_out_back)
+                return in_out_back<T, math_policy>(x);
+            else if constexpr (F == easing::function::out_back)
+                return out_back<T, math_policy>(x);
+            else if constexpr (F == easing::function::in_bounce)
+                return in_bounce<T>(x);
+            else if constexpr (F == easing::function::in_out_bounce)
+                return in_out_bounce<T>(x);
+            else if constexpr (F == easing::function::out_bounce)
+                return out_bounce<T>(x);
+            else if constexpr (F == easing::function::in_circular)
+                return in_circular<T>(x);
+            else if constexpr (F == easing::function::in_out_circular)
+                return in_out_circular<T>(x);
+            else if constexpr (F == easing::function::out_circular)
+                return out_circular<T>(x);
+            else if constexpr (F == easing::function::in_cubic)
+                return in_cubic<T>(x);
+            else if constexpr (F == easing::function::in_out_cubic)
+                return in_out_cubic<T>(x);
+            else if constexpr (F == easing::function::out_cubic)
+                return out_cubic<T>(x);
+            else if constexpr (F == easing::function::in_elastic)
+                return in_elastic<T, math_policy>(x);
+            else if constexpr (F == easing::function::in_out_elastic)
+                return in_out_elastic<T, math_policy>(x);
+            else if constexpr (F == easing::function::out_elastic)
+                return out_elastic<T, math_policy>(x);
+            else if constexpr (F == easing::function::in_exponential)
+                return in_exponential<T, math_policy>(x);
+            else if constexpr (F == easing::function::in_out_exponential)
+                return in_out_exponential<T, math_policy>(x);
+            else if constexpr (F == easing::function::out_exponential)
+                return out_exponential<T, math_policy>(x);
+            else if constexpr (F == easing::function::in_quadratic)
+                return in_quadratic<T>(x);
+            else if constexpr (F == easing::function::in_out_quadratic)
+                return in_out_quadratic<T>(x);
+            else if constexpr (F == easing::function::out_quadratic)
+                return out_quadratic<T>(x);
+            else if constexpr (F == easing::function::in_quartic)
+                return in_quartic<T>(x);
+            else if constexpr (F == easing::function::in_out_quartic)
+                return in_out_quartic<T>(x);
+            else if constexpr (F == easing::function::out_quartic)
+                return out_quartic<T>(x);
+            else if constexpr (F == easing::function::in_quintic)
+                return in_quintic<T>(x);
+            else if constexpr (F == easing::function::in_out_quintic)
+                return in_out_quintic<T>(x);
+            else if constexpr (F == easing::function::out_quintic)
+                return out_quintic<T>(x);
+            else if constexpr (F == easing::function::in_sine)
+                return in_sine<T, math_policy>(x);
+            else if constexpr (F == easing::function::in_out_sine)
+                return in_out_sine<T, math_policy>(x);
+            else if constexpr (F == easing::function::out_sine)
+                return out_sine<T, math_policy>(x);
+        }
+
+
+        /// Interpolate between two values along the easing function.
+        /// @param x1		The value at delta = 0
+        /// @param x2		The value at delta = 1
+        /// @param delta 	Fractional location between x1 and x2, which is fed into the easing function
+        /// @return			The interpolated value
+
+        template<typename T>
+        T operator()(T x1, T x2, double delta) const noexcept {
+            return x1 + (*this)(static_cast<T>(delta)) * (x2 - x1);
+        }
+
+
+        /// Apply the easing function to a vector of numbers.
+        /// The loop has no calls when the elementary functions are inlined, so the compiler can vectorize it.
+        ///	@param	in		The values to feed as input into the easing function.
+        ///	@param	out		Storage for the "eased" output, which may be the same as the input.
+        ///	@param	count	The number of values.
+
+        template<typename T>
+        static void process(const T* in, T* out, std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i)
+                out[i] = curve{}(in[i]);
+        }
+    };
+
+
+    /// The signature of curve::process().
+    /// @tparam	T		The type of number to use for the calculations.
+
+    template<typename T>
+    using kernel = void (*)(const T* in, T* out, std::size_t count);
+
+
+    /// Make the table of kernels for every easing function, in the order of the #easing::function enum.
+
+    template<class math_policy, typename T, std::size_t... I>
+    constexpr std::array<kernel<T>, sizeof...(I)> make_kernels(std::index_sequence<I...>) {
+        return {{ &curve<static_cast<easing::function>(I), math_policy>::template process<T>... }};
+    }
+
+
+    /// The block kernel of every easing function, indexed by the #easing::function enum.
+    /// Each kernel is instantiated once, and selecting one at run time costs a single indirect call per block.
+    /// @tparam	math_policy		How the elementary functions are evaluated: math::precise by default, or math::fast.
+    /// @tparam	T				The type of number to use for the calculations.
+
+    template<class math_policy = math::precise, typename T = sample>
+    constexpr auto kernels = make_kernels<math_policy, T>(std::make_index_sequence<static_cast<std::size_t>(easing::function::enum_count)>());
+
+
+    /// Apply one of the standard easing functions to a vector of numbers.
+    /// The function is selected once for the whole vector rather than for every value, through the #easing::kernels table.
+    /// Use math::fast as the policy to inline the elementary functions of the back, elastic, exponential and sine functions.
+    /// @tparam	math_policy		How the elementary functions are evaluated: math::precise by default, or math::fast.
+    /// @tparam	T				The type of number to use for the calculations (e.g. float, double, number, or sample).
+    /// @param	name			The easing function to apply as enumerated in the #easing::function enum.
+    ///	@param	in				The values to feed as input into the easing function.
+    ///	@param	out				Storage for the "eased" output, which may be the same as the input.
+    ///	@param	count			The number of values.
+
+    template<class math_policy = math::precise, typename T>
+    void apply(easing::function name, const T* in, T* out, std::size_t count) {
+        assert(name < easing::function::enum_count);
+        kernels<math_policy, T>[static_cast<std::size_t>(name)](in, out, count);
+    }
+
+
+    /// A precomputed table of one of the standard easing functions, for curves that are costly to evaluate
+    /// such as the back, bounce and elastic functions.
+    /// The function is sampled at evenly spaced points over [0, 1] when the table is created, and values between them are interpolated.
+    /// With the default Catmull-Rom spline and 1024 points the error is below 1e-6 for the smooth functions, e.g. in_elastic and out_back.
+    /// The in-out functions join two curves at 0.5, where the error is larger, e.g. 5e-5 for in_out_elastic.
+    /// The bounce functions have corners, the circular functions have an infinite slope at one end and
+    /// the exponential functions jump at an end, so those are only accurate to about 1e-2 and should be evaluated directly instead.
+    /// Input is clamped to [0, 1]. Creating a table allocates, so it should be done outside of the audio thread.
+    /// @tparam	interpolator_type	The interpolator for values between the points, which is called with four points.
+
+    template<class interpolator_type = interpolator::spline<>>
+    class table {
+    public:
+        /// Create a table.
+        /// @param	name	The easing function as enumerated in the #easing::function enum.
+        /// @param	size	The number of intervals between the points.
+
+        explicit table(easing::function name, int size = 1024)
+        : m_function { name }
+        , m_size { std::max(size, 1) }
+        , m_values(m_size + 3) {
+            for (auto i = 0; i <= m_size; ++i)
+                m_values[i + 1] = apply(name, static_cast<number>(i) / m_size);
+
+            // the points beyond the ends continue the parabola through the last three points, which keeps the spline third order there
+            if (m_size > 1) {
+                m_values[0]          = 3.0 * (m_values[1] - m_values[2]) + m_values[3];
+                m_values[m_size + 2] = 3.0 * (m_values[m_size + 1] - m_values[m_size]) + m_values[m_size - 1];
+            }
+            else {
+                m_values[0]          = 2.0 * m_values[1] - m_values[2];
+                m_values[m_size + 2] = 2.0 * m_values[m_size + 1] - m_values[m_size];
+            }
+        }
+
+
+        /// Return the easing function.
+        /// @return	The easing function.
+
+        easing::function function() const {
+            return m_function;
+        }
+
+
+        /// Look up one value.
+        ///	@param	x	The value to feed as input into the easing function.
+        ///	@return		The "eased" output.
+
+        sample operator()(sample x) {
+            auto position = std::min(std::max(x, 0.0), 1.0) * m_size;
+            auto index    = std::min(static_cast<int>(position), m_size - 1);
+            auto p        = &m_values[index];
+
+            return m_interpolator(p[0], p[1], p[2], p[3], position - index);
+        }
+
+
+        /// Look up a vector of values.
+        ///	@param	in		The values to feed as input into the easing function.
+        ///	@param	out		Storage for the "eased" output, which may be the same as the input.
+        ///	@param	count	The number of values.
+
+        void operator()(const sample* in, sample* out, std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i)
+                out[i] = (*this)(in[i]);
+        }
+
+
+    private:
+        easing::function	m_function;
+        int					m_size;
+        sample_vector		m_values;		// the points at i / size are at [i + 1], with one more point beyond each end
+        interpolator_type	m_interpolator;
+    };
+
+
+
+    /// A ramp from one value to another over a number of samples, shaped by an easing function.
+    /// The ramp can be evaluated at control rate: the easing function is then applied only every few samples
+    /// and the samples between are interpolated. With linear interpolation the error is at most
+    /// (interval / duration)^2 * max|f''| * |to - from| / 8, where f'' is the second derivative of the easing function.
+    /// Functions with corners, such as the bounce functions, are less accurate at their corners.
+
+    class ramp {
+    public:
+        /// Set the easing function.
+        /// @param	name	The easing function as enumerated in the #easing::function enum.
+
+        void function(easing::function name) {
+            m_function = name;
+        }
+
+
+        /// Return the easing function.
+        /// @return	The easing function.
+
+        easing::function function() const {
+            return m_function;
+        }
+
+
+        /// Evaluate the easing function only every few samples in process().
+        /// @param	interval	The spacing of evaluations in samples. An interval of one, the default, evaluates every sample.
+        /// @param	kind		The interpolation between evaluations, interpolator::type::linear or interpolator::type::spline.
+
+        void control_rate(int interval, interpolator::type kind = interpolator::type::linear) {
+            m_interval = std::max(interval, 1);
+            m_kind     = kind;
+        }
+
+
+        /// Start a new ramp.
+        /// @param	from		The value at the start of the ramp.
+        /// @param	to			The value at the end of the ramp, which is held once it is reached.
+        /// @param	duration	The length of the ramp in samples.
+
+        void start(number from, number to, int duration) {
+            m_from     = from;
+            m_to       = to;
+            m_duration = std::max(duration, 1);
+            m_index    = 0;
+        }
+
+
+        /// Return whether the ramp is still moving.
+        /// @return	True until the end value has been reached.
+
+        bool active() const {
+            return m_index < m_duration;
+        }
+
+
+        /// Calculate one sample, always evaluating the easing function.
+        ///	@return		Calculated sample
+
+        sample operator()() {
+            if (!active())
+                return m_to;
+            return value(++m_index);
+        }
+
+
+        /// Calculate a vector of samples.
+        /// @param	output			Storage for the samples.
+        /// @param	frame_count		The number of samples to calculate.
+
+        void process(sample* output, std::size_t frame_count) {
+            auto run = static_cast<int>(std::min<std::size_t>(frame_count, m_duration - m_index));
+
+            interpolator::knots([this](int i) { return value(i); }, m_kind, m_interval, m_index, run, m_duration, output);
+            m_index += run;
+            std::fill(output + run, output + frame_count, m_to);
+        }
+
+
+    private:
+        number value(int index) const {
+            return m_from + (m_to - m_from) * apply(m_function, static_cast<number>(index) / m_duration);
+        }
+
+        easing::function	m_function	{ easing::function::linear };
+        interpolator::type	m_kind		{ interpolator::type::linear };
+        int					m_interval	{ 1 };
+        number				m_from		{};
+        number				m_to		{};
+        int					m_duration	{ 1 };
+        int					m_index		{ 1 };
+    };
+
 }    // namespace c74::min::lib::easing
@@ -0,0 +1,522 @@
+/// @file
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include "c74_min_api.h"
+
+#include <complex>
+#include <map>
+#include <memory>
+#include <mutex>
+
+
+namespace c74::min::lib {
+
+
+    ///	<a href="https://en.wikipedia.org/wiki/Fast_Fourier_transform">Fast Fourier transform</a> of complex data.
+    ///
+    ///	Sizes may be any product of 2, 3 and 5. The transform is a mixed-radix Stockham autosort algorithm,
+    ///	which needs no bit-reversal pass, with dedicated butterflies for radix 2, 3, 4 and 5.
+    ///	Data is processed in split form, with the real and imaginary parts in separate arrays,
+    ///	so the butterflies are plain arithmetic on contiguous samples that the compiler can vectorize.
+    ///
+    ///	The twiddle factors for each size are calculated once and shared by all instances of that size.
+    ///	Each instance has its own scratch memory, so transforms do not allocate and may be used on the audio thread,
+    ///	but an instance must not be used by two threads at once.
+    ///
+    ///	Transforms are not scaled, so a forward transform followed by an inverse transform multiplies the data by size().
+
+    class fft {
+    public:
+        using complex = std::complex<sample>;
+
+
+        /// Create an fft instance for a given size.
+        /// The first instance of each size calculates its twiddle factors, so create instances before processing begins.
+        /// @param	a_size	The number of points in the transform. Must be a product of 2, 3 and 5.
+
+        explicit fft(std::size_t a_size)
+        : m_plan{plan::get(a_size)} {
+            for (auto& buffer : m_scratch)
+                buffer.resize(a_size);
+        }
+
+
+        /// Determine if a size can be transformed.
+        /// @param	size	The number of points.
+        /// @return			True if the size is a product of 2, 3 and 5.
+
+        static bool supported(std::size_t size) {
+            if (size == 0)
+                return false;
+            for (auto radix : {2, 3, 5}) {
+                while (size % radix == 0)
+                    size /= radix;
+            }
+            return size == 1;
+        }
+
+
+        /// Return the number of points in the transform.
+        /// @return	The size of the transform.
+
+        std::size_t size() const {
+            return m_plan->size;
+        }
+
+
+        /// Calculate the forward transform of split complex data.
+        /// @param	real_in		The real parts of the size() input points.
+        /// @param	imag_in		The imaginary parts of the input points.
+        /// @param	real_out	Storage for the real parts of the result. May be the same as real_in.
+        /// @param	imag_out	Storage for the imaginary parts of the result. May be the same as imag_in.
+
+        void forward(const sample* real_in, const sample* imag_in, sample* real_out, sample* imag_out) {
+            transform<false>(real_in, imag_in, real_out, imag_out);
+        }
+
+
+        /// Calculate the inverse transform of split complex data.
+        /// @param	real_in		The real parts of the size() input points.
+        /// @param	imag_in		The imaginary parts of the input points.
+        /// @param	real_out	Storage for the real parts of the result. May be the same as real_in.
+        /// @param	imag_out	Storage for the imaginary parts of the result. May be the same as imag_in.
+
+        void inverse(const sample* real_in, const sample* imag_in, sample* real_out, sample* imag_out) {
+            transform<true>(real_in, imag_in, real_out, imag_out);
+        }
+
+
+        /// Calculate the forward transform of interleaved complex data in place.
+        /// This converts to and from split form, so the split functions are faster.
+        /// @param	data	The size() points to transform.
+
+        void forward(complex* data) {
+            interleaved<false>(data);
+        }
+
+
+        /// Calculate the inverse transform of interleaved complex data in place.
+        /// This converts to and from split form, so the split functions are faster.
+        /// @param	data	The size() points to transform.
+
+        void inverse(complex* data) {
+            interleaved<true>(data);
+        }
+
+
+    private:
+        /// The factorization and twiddle factors for one size, shared by all instances of that size.
+
+        struct plan {
+            struct pass {
+                int				radix;
+                std::size_t		m;				// length of each sub-transform after this pass
+                std::size_t		stride;			// distance between the points of one sub-transform
+                sample_vector	twiddle_real;	// [p * (radix - 1) + k - 1] = e^(-2 pi i p k / (m * radix))
+                sample_vector	twiddle_imag;
+            };
+
+            std::size_t		size;
+            vector<pass>	passes;
+
+
+            explicit plan(std::size_t a_size)
+            : size{a_size} {
+                assert(supported(size));
+
+                // radix 4 needs fewer operations per point than two passes of radix 2
+
+                vector<int> radices;
+                auto        remaining = size;
+
+                while (remaining % 4 == 0) {
+                    radices.push_back(4);
+                    remaining /= 4;
+                }
+                for (auto radix : {2, 3, 5}) {
+                    while (remaining % radix == 0) {
+                        radices.push_back(radix);
+                        remaining /= radix;
+                    }
+                }
+
+                auto n      = size;
+                auto stride = std::size_t(1);
+
+                for (auto radix : radices) {
+                    pass p;
+                    p.radix  = radix;
+                    p.m      = n / radix;
+                    p.stride = stride;
+
+                    for (auto j = 0; j < p.m; ++j) {
+                        for (auto k = 1; k < radix; ++k) {
+                            auto angle = -2.0 * M_PI * j * k / n;
+                            p.twiddle_real.push_back(cos(angle));
+                            p.twiddle_imag.push_back(sin(angle));
+                        }
+                    }
+
+                    passes.push_back(std::move(p));
+                    n = n / radix;
+                    stride *= radix;
+                }
+            }
+
+
+            /// Return the plan for a size, creating it if this is the first request.
+
+            static std::shared_ptr<const plan> get(std::size_t size) {
+                static std::mutex                                          mutex;
+                static std::map<std::size_t, std::shared_ptr<const plan>> cache;
+
+                std::lock_guard<std::mutex> lock {mutex};
+                auto&                       entry = cache[size];
+                if (!entry)
+                    entry = std::make_shared<const plan>(size);
+                return entry;
+            }
+        };
+
+
+        /// Run all passes, alternating between the scratch buffers so that the last pass writes to the output.
+
+        template<bool inverse>
+        void transform(const sample* real_in, const sample* imag_in, sample* real_out, sample* imag_out) {
+            const auto& passes = m_plan->passes;
+            const auto  count  = passes.size();
+
+            if (count == 0) {    // a size of 1
+                real_out[0] = real_in[0];
+                imag_out[0] = imag_in[0];
+                return;
+            }
+
+            // a single pass cannot read and write the same memory
+            if (count == 1 && real_in == real_out) {
+                std::copy_n(real_in, size(), m_scratch[2].data());
+                std::copy_n(imag_in, size(), m_scratch[3].data());
+                real_in = m_scratch[2].data();
+                imag_in = m_scratch[3].data();
+            }
+
+            for (auto i = 0; i < count; ++i) {
+                auto last = (i == count - 1);
+                auto xr   = (i == 0) ? real_in : m_scratch[(i - 1) % 2 * 2].data();
+                auto xi   = (i == 0) ? imag_in : m_scratch[(i - 1) % 2 * 2 + 1].data();
+                auto yr   = last ? real_out : m_scratch[i % 2 * 2].data();
+                auto yi   = last ? imag_out : m_scratch[i % 2 * 2 + 1].data();
+
+                switch (passes[i].radix) {
+                    case 2:
+                        run<2, inverse>(passes[i], xr, xi, yr, yi);
+                        break;
+                    case 3:
+                        run<3, inverse>(passes[i], xr, xi, yr, yi);
+                        break;
+                    case 4:
+                        run<4, inverse>(passes[i], xr, xi, yr, yi);
+                        break;
+                    case 5:
+                        run<5, inverse>(passes[i], xr, xi, yr, yi);
+                        break;
+                }
+            }
+        }
+
+
+        /// One Stockham pass: for every sub-transform p and offset q,
+        /// y[q + stride * (radix * p + k)] = w^(p * k) * sum over j of x[q + stride * (p + j * m)] * e^(-2 pi i j k / radix)
+
+        template<int radix, bool inverse>
+        static void run(const plan::pass& pass, const sample* xr, const sample* xi, sample* yr, sample* yi) {
+            const auto m      = pass.m;
+            const auto stride = pass.stride;
+            const auto sign   = inverse ? 1.0 : -1.0;    // sign of the exponent
+
+            for (std::size_t p = 0; p < m; ++p) {
+                sample wr[radix];
+                sample wi[radix];
+                for (auto k = 1; k < radix; ++k) {
+                    wr[k] = pass.twiddle_real[p * (radix - 1) + k - 1];
+                    wi[k] = -sign * pass.twiddle_imag[p * (radix - 1) + k - 1];
+                }
+
+                const auto in  = stride * p;
+                const auto out = stride * radix * p;
+
+                for (std::size_t q = 0; q < stride; ++q) {
+                    sample ar[radix], ai[radix], br[radix], bi[radix];
+
+                    for (auto j = 0; j < radix; ++j) {
+                        ar[j] = xr[in + q + stride * m * j];
+                        ai[j] = xi[in + q + stride * m * j];
+                    }
+
+                    butterfly<radix>(sign, ar, ai, br, bi);
+
+                    yr[out + q] = br[0];
+                    yi[out + q] = bi[0];
+                    for (auto k = 1; k < radix; ++k) {
+                        yr[out + q + stride * k] = br[k] * wr[k] - bi[k] * wi[k];
+                        yi[out + q + stride * k] = br[k] * wi[k] + bi[k] * wr[k];
+                    }
+                }
+            }
+        }
+
+
+        /// Discrete Fourier transform of radix points, where the exponent of the kernel has the given sign.
+
+        template<int radix>
+        static void butterfly(sample sign, const sample* ar, const sample* ai, sample* br, sample* bi) {
+            if constexpr (radix == 2) {
+                br[0] = ar[0] + ar[1];
+                bi[0] = ai[0] + ai[1];
+                br[1] = ar[0] - ar[1];
+                bi[1] = ai[0] - ai[1];
+            }
+            else if constexpr (radix == 3) {
+                constexpr auto c = -0.5;
+                constexpr auto s = 0.86602540378443864676;    // sin(2 pi / 3)
+
+                auto tr = ar[1] + ar[2];
+                auto ti = ai[1] + ai[2];
+                auto mr = ar[0] + c * tr;
+                auto mi = ai[0] + c * ti;
+                auto dr = sign * s * (ar[1] - ar[2]);    // i * sign * s * (a1 - a2)
+                auto di = sign * s * (ai[1] - ai[2]);
+
+                br[0] = ar[0] + tr;
+                bi[0] = ai[0] + ti;
+                br[1] = mr - di;
+                bi[1] = mi + dr;
+                br[2] = mr + di;
+                bi[2] = mi - dr;
+            }
+            else if constexpr (radix == 4) {
+                auto t0r = ar[0] + ar[2];
+                auto t0i = ai[0] + ai[2];
+                auto t1r = ar[0] - ar[2];
+                auto t1i = ai[0] - ai[2];
+                auto t2r = ar[1] + ar[3];
+                auto t2i = ai[1] + ai[3];
+                auto t3r = -sign * (ai[1] - ai[3]);    // i * sign * (a1 - a3)
+                auto t3i = sign * (ar[1] - ar[3]);
+
+                br[0] = t0r + t2r;
+                bi[0] = t0i + t2i;
+                br[1] = t1r + t3r;
+                bi[1] = t1i + t3i;
+                br[2] = t0r - t2r;
+                bi[2] = t0i - t2i;
+                br[3] = t1r - t3r;
+                bi[3] = t1i - t3i;
+            }
+            else if constexpr (radix == 5) {
+                constexpr auto c1 = 0.30901699437494742410;     // cos(2 pi / 5)
+                constexpr auto c2 = -0.80901699437494742410;    // cos(4 pi / 5)
+                constexpr auto s1 = 0.95105651629515357212;     // sin(2 pi / 5)
+                constexpr auto s2 = 0.58778525229247312917;     // sin(4 pi / 5)
+
+                auto b1r = ar[1] + ar[4];
+                auto b1i = ai[1] + ai[4];
+                auto b2r = ar[2] + ar[3];
+                auto b2i = ai[2] + ai[3];
+                auto d1r = ar[1] - ar[4];
+                auto d1i = ai[1] - ai[4];
+                auto d2r = ar[2] - ar[3];
+                auto d2i = ai[2] - ai[3];
+
+                auto t1r = ar[0] + c1 * b1r + c2 * b2r;
+                auto t1i = ai[0] + c1 * b1i + c2 * b2i;
+                auto t2r = ar[0] + c2 * b1r + c1 * b2r;
+                auto t2i = ai[0] + c2 * b1i + c1 * b2i;
+
+                // i * sign * (s1 * d1 + s2 * d2) and i * sign * (s2 * d1 - s1 * d2)
+                auto u1r = -sign * (s1 * d1i + s2 * d2i);
+                auto u1i = sign * (s1 * d1r + s2 * d2r);
+                auto u2r = -sign * (s2 * d1i - s1 * d2i);
+                auto u2i = sign * (s2 * d1r - s1 * d2r);
+
+                br[0] = ar[0] + b1r + b2r;
+                bi[0] = ai[0] + b1i + b2i;
+                br[1] = t1r + u1r;
+                bi[1] = t1i + u1i;
+                br[4] = t1r - u1r;
+                bi[4] = t1i - u1i;
+                br[2] = t2r + u2r;
+                bi[2] = t2i + u2i;
+                br[3] = t2r - u2r;
+                bi[3] = t2i - u2i;
+            }
+        }
+
+
+        template<bool inverse>
+        void interleaved(complex* data) {
+            auto re = m_scratch[4].data();
+            auto im = m_scratch[5].data();
+
+            for (auto i = 0; i < size(); ++i) {
+                re[i] = data[i].real();
+                im[i] = data[i].imag();
+            }
+
+            transform<inverse>(re, im, re, im);
+
+            for (auto i = 0; i < size(); ++i)
+                data[i] = {re[i], im[i]};
+        }
+
+
+        std::shared_ptr<const plan>		m_plan;
+        sample_vector					m_scratch[6];	// two pairs of split buffers for alternate passes, and one for interleaved data
+    };
+
+
+    ///	Fast Fourier transform of real data.
+    ///
+    ///	A real sequence of N points is packed into a complex sequence of N/2 points, which is transformed with the fft class,
+    ///	and the result is then untangled into the N/2 + 1 unique bins of the real transform.
+    ///	This takes roughly half the work of a complex transform of the same size.
+    ///	Spectra are stored in split form, with N/2 + 1 real parts and N/2 + 1 imaginary parts.
+    ///
+    ///	Transforms are not scaled, so a forward transform followed by an inverse transform multiplies the data by size().
+
+    class real_fft {
+    public:
+        /// Create a real fft instance for a given size.
+        /// @param	a_size	The number of real points in the transform. Must be twice a product of 2, 3 and 5.
+
+        explicit real_fft(std::size_t a_size)
+        : m_half{a_size / 2} {
+            assert(a_size % 2 == 0);
+
+            for (auto k = 0; k <= a_size / 2; ++k) {
+                m_twiddle_real.push_back(cos(-2.0 * M_PI * k / a_size));
+                m_twiddle_imag.push_back(sin(-2.0 * M_PI * k / a_size));
+            }
+            for (auto& buffer : m_scratch)
+                buffer.resize(a_size / 2);
+        }
+
+
+        /// Return the number of real points in the transform.
+        /// @return	The size of the transform.
+
+        std::size_t size() const {
+            return m_half.size() * 2;
+        }
+
+
+        /// Return the number of bins in the spectrum, which is size() / 2 + 1.
+        /// @return	The number of complex bins.
+
+        std::size_t bin_count() const {
+            return m_half.size() + 1;
+        }
+
+
+        /// Calculate the forward transform.
+        /// @param	input		The size() real input points.
+        /// @param	real_out	Storage for the real parts of the bin_count() bins.
+        /// @param	imag_out	Storage for the imaginary parts of the bins.
+
+        void forward(const sample* input, sample* real_out, sample* imag_out) {
+            const auto m  = m_half.size();
+            auto       zr = m_scratch[0].data();
+            auto       zi = m_scratch[1].data();
+
+            for (auto n = 0; n < m; ++n) {
+                zr[n] = input[2 * n];
+                zi[n] = input[2 * n + 1];
+            }
+            m_half.forward(zr, zi, real_out, imag_out);
+
+            // X[k] = E[k] + w^k O[k], where E and O are the transforms of the even and odd points:
+            // E[k] = (Z[k] + conj(Z[m - k])) / 2 and O[k] = (Z[k] - conj(Z[m - k])) / 2i
+
+            auto z0r = real_out[0];
+            auto z0i = imag_out[0];
+            real_out[0] = z0r + z0i;
+            imag_out[0] = 0.0;
+            real_out[m] = z0r - z0i;
+            imag_out[m] = 0.0;
+
+            for (std::size_t k = 1; k <= m / 2; ++k) {
+                auto j   = m - k;
+                auto akr = real_out[k], aki = imag_out[k];
+                auto ajr = real_out[j], aji = imag_out[j];
+
+                untangle(k, akr, aki, ajr, aji, real_out[k], imag_out[k]);
+                if (j != k)
+                    untangle(j, ajr, aji, akr, aki, real_out[j], imag_out[j]);
+            }
+        }
+
+
+        /// Calculate the inverse transform.
+        /// @param	real_in		The real parts of the bin_count() bins.
+        /// @param	imag_in		The imaginary parts of the bins.
+        /// @param	output		Storage for the size() real points.
+
+        void inverse(const sample* real_in, const sample* imag_in, sample* output) {
+            const auto m  = m_half.size();
+            auto       zr = m_scratch[0].data();
+            auto       zi = m_scratch[1].data();
+
+            // Z[k] = E[k] + i O[k], scaled by two, where E[k] = (X[k] + conj(X[m - k])) / 2 and O[k] = (X[k] - conj(X[m - k])) / 2w^k
+
+            for (std::size_t k = 0; k < m; ++k) {
+                auto j  = m - k;
+                auto er = real_in[k] + real_in[j];
+                auto ei = imag_in[k] - imag_in[j];
+                auto dr = real_in[k] - real_in[j];
+                auto di = imag_in[k] + imag_in[j];
+
+                // o = d * conj(w^k), since w^k has a magnitude of one
+                auto wr = m_twiddle_real[k];
+                auto wi = m_twiddle_imag[k];
+                auto or_ = dr * wr + di * wi;
+                auto oi  = di * wr - dr * wi;
+
+                zr[k] = er - oi;
+                zi[k] = ei + or_;
+            }
+            m_half.inverse(zr, zi, m_scratch[2].data(), m_scratch[3].data());
+
+            for (auto n = 0; n < m; ++n) {
+                output[2 * n]     = m_scratch[2][n];
+                output[2 * n + 1] = m_scratch[3][n];
+            }
+        }
+
+
+    private:
+        /// Calculate bin k of the real transform from bins k and m - k of the packed transform.
+
+        void untangle(std::size_t k, sample zkr, sample zki, sample zjr, sample zji, sample& xr, sample& xi) const {
+            auto er = 0.5 * (zkr + zjr);
+            auto ei = 0.5 * (zki - zji);
+            auto or_ = 0.5 * (zki + zji);     // (Z[k] - conj(Z[j])) / 2i
+            auto oi  = -0.5 * (zkr - zjr);
+            auto wr  = m_twiddle_real[k];
+            auto wi  = m_twiddle_imag[k];
+
+            xr = er + or_ * wr - oi * wi;
+            xi = ei + or_ * wi + oi * wr;
+        }
+
+        fft				m_half;				// complex transform of size / 2
+        sample_vector	m_twiddle_real;		// [k] = e^(-2 pi i k / size) for k in [0, size / 2]
+        sample_vector	m_twiddle_imag;
+        sample_vector	m_scratch[4];
+    };
+
+
+}    // namespace c74::min::lib
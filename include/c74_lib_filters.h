@@ -45,4 +45,162 @@ namespace c74::min::lib::filters {
     }
 
 
+    /// Coefficients for a second-order section.
+    /// Values are normalized such that the leading feedback coefficient (a0) is 1.0 and is not stored.
+
+    struct biquad_coefficients {
+        number b0{1.0};    ///< feedforward coefficient for the current input
+        number b1{0.0};    ///< feedforward coefficient for the input 1 sample ago
+        number b2{0.0};    ///< feedforward coefficient for the input 2 samples ago
+        number a1{0.0};    ///< feedback coefficient for the output 1 sample ago
+        number a2{0.0};    ///< feedback coefficient for the output 2 samples ago
+    };
+
+
+    /// Design a second-order lowpass filter.
+    /// @param	frequency			The cutoff frequency in hertz.
+    /// @param	q					The resonance of the filter. A value of 0.7071 yields a Butterworth response.
+    /// @param	sampling_frequency	The sampling frequency of the environment in hertz.
+    ///	@return						The coefficients for the filter.
+    /// @see	https://www.w3.org/TR/audio-eq-cookbook/
+
+    inline biquad_coefficients lowpass(number frequency, number q, number sampling_frequency) {
+        auto w0    = 2.0 * M_PI * frequency / sampling_frequency;
+        auto cosw0 = cos(w0);
+        auto alpha = sin(w0) / (2.0 * q);
+        auto a0    = 1.0 + alpha;
+
+        return {(1.0 - cosw0) * 0.5 / a0, (1.0 - cosw0) / a0, (1.0 - cosw0) * 0.5 / a0, -2.0 * cosw0 / a0, (1.0 - alpha) / a0};
+    }
+
+
+    /// Design a second-order highpass filter.
+    /// @param	frequency			The cutoff frequency in hertz.
+    /// @param	q					The resonance of the filter. A value of 0.7071 yields a Butterworth response.
+    /// @param	sampling_frequency	The sampling frequency of the environment in hertz.
+    ///	@return						The coefficients for the filter.
+    /// @see	https://www.w3.org/TR/audio-eq-cookbook/
+
+    inline biquad_coefficients highpass(number frequency, number q, number sampling_frequency) {
+        auto w0    = 2.0 * M_PI * frequency / sampling_frequency;
+        auto cosw0 = cos(w0);
+        auto alpha = sin(w0) / (2.0 * q);
+        auto a0    = 1.0 + alpha;
+
+        return {(1.0 + cosw0) * 0.5 / a0, -(1.0 + cosw0) / a0, (1.0 + cosw0) * 0.5 / a0, -2.0 * cosw0 / a0, (1.0 - alpha) / a0};
+    }
+
+
+    /// Design a second-order allpass filter.
+    /// @param	frequency			The frequency in hertz at which the phase shift is 180 degrees.
+    /// @param	q					The sharpness of the phase transition.
+    /// @param	sampling_frequency	The sampling frequency of the environment in hertz.
+    ///	@return						The coefficients for the filter.
+    /// @see	https://www.w3.org/TR/audio-eq-cookbook/
+
+    inline biquad_coefficients allpass(number frequency, number q, number sampling_frequency) {
+        auto w0    = 2.0 * M_PI * frequency / sampling_frequency;
+        auto cosw0 = cos(w0);
+        auto alpha = sin(w0) / (2.0 * q);
+        auto a0    = 1.0 + alpha;
+
+        return {(1.0 - alpha) / a0, -2.0 * cosw0 / a0, 1.0, -2.0 * cosw0 / a0, (1.0 - alpha) / a0};
+    }
+
+
+    /// Design a second-order bandpass filter with a peak gain of 0 dB.
+    /// @param	frequency			The center frequency in hertz.
+    /// @param	q					The ratio of the center frequency to the bandwidth.
+    /// @param	sampling_frequency	The sampling frequency of the environment in hertz.
+    ///	@return						The coefficients for the filter.
+    /// @see	https://www.w3.org/TR/audio-eq-cookbook/
+
+    inline biquad_coefficients bandpass(number frequency, number q, number sampling_frequency) {
+        auto w0    = 2.0 * M_PI * frequency / sampling_frequency;
+        auto cosw0 = cos(w0);
+        auto alpha = sin(w0) / (2.0 * q);
+        auto a0    = 1.0 + alpha;
+
+        return {alpha / a0, 0.0, -alpha / a0, -2.0 * cosw0 / a0, (1.0 - alpha) / a0};
+    }
+
+
+    /// Design a second-order notch filter.
+    /// @param	frequency			The frequency in hertz that is removed.
+    /// @param	q					The ratio of the notch frequency to the width of the notch.
+    /// @param	sampling_frequency	The sampling frequency of the environment in hertz.
+    ///	@return						The coefficients for the filter.
+    /// @see	https://www.w3.org/TR/audio-eq-cookbook/
+
+    inline biquad_coefficients notch(number frequency, number q, number sampling_frequency) {
+        auto w0    = 2.0 * M_PI * frequency / sampling_frequency;
+        auto cosw0 = cos(w0);
+        auto alpha = sin(w0) / (2.0 * q);
+        auto a0    = 1.0 + alpha;
+
+        return {1.0 / a0, -2.0 * cosw0 / a0, 1.0 / a0, -2.0 * cosw0 / a0, (1.0 - alpha) / a0};
+    }
+
+
+    /// Design a second-order peaking equalizer.
+    /// @param	frequency			The center frequency in hertz.
+    /// @param	q					The ratio of the center frequency to the bandwidth.
+    /// @param	gain_in_db			The gain at the center frequency in decibels.
+    /// @param	sampling_frequency	The sampling frequency of the environment in hertz.
+    ///	@return						The coefficients for the filter.
+    /// @see	https://www.w3.org/TR/audio-eq-cookbook/
+
+    inline biquad_coefficients peaking(number frequency, number q, number gain_in_db, number sampling_frequency) {
+        auto A     = pow(10.0, gain_in_db / 40.0);
+        auto w0    = 2.0 * M_PI * frequency / sampling_frequency;
+        auto cosw0 = cos(w0);
+        auto alpha = sin(w0) / (2.0 * q);
+        auto a0    = 1.0 + alpha / A;
+
+        return {(1.0 + alpha * A) / a0, -2.0 * cosw0 / a0, (1.0 - alpha * A) / a0, -2.0 * cosw0 / a0, (1.0 - alpha / A) / a0};
+    }
+
+
+    /// Design a second-order low shelving equalizer.
+    /// @param	frequency			The midpoint frequency of the shelf in hertz.
+    /// @param	q					The steepness of the shelf. A value of 0.7071 yields the steepest slope without overshoot.
+    /// @param	gain_in_db			The gain below the shelf frequency in decibels.
+    /// @param	sampling_frequency	The sampling frequency of the environment in hertz.
+    ///	@return						The coefficients for the filter.
+    /// @see	https://www.w3.org/TR/audio-eq-cookbook/
+
+    inline biquad_coefficients lowshelf(number frequency, number q, number gain_in_db, number sampling_frequency) {
+        auto A     = pow(10.0, gain_in_db / 40.0);
+        auto w0    = 2.0 * M_PI * frequency / sampling_frequency;
+        auto cosw0 = cos(w0);
+        auto beta  = 2.0 * sqrt(A) * sin(w0) / (2.0 * q);
+        auto a0    = (A + 1.0) + (A - 1.0) * cosw0 + beta;
+
+        return {A * ((A + 1.0) - (A - 1.0) * cosw0 + beta) / a0, 2.0 * A * ((A - 1.0) - (A + 1.0) * cosw0) / a0,
+            A * ((A + 1.0) - (A - 1.0) * cosw0 - beta) / a0, -2.0 * ((A - 1.0) + (A + 1.0) * cosw0) / a0,
+            ((A + 1.0) + (A - 1.0) * cosw0 - beta) / a0};
+    }
+
+
+    /// Design a second-order high shelving equalizer.
+    /// @param	frequency			The midpoint frequency of the shelf in hertz.
+    /// @param	q					The steepness of the shelf. A value of 0.7071 yields the steepest slope without overshoot.
+    /// @param	gain_in_db			The gain above the shelf frequency in decibels.
+    /// @param	sampling_frequency	The sampling frequency of the environment in hertz.
+    ///	@return						The coefficients for the filter.
+    /// @see	https://www.w3.org/TR/audio-eq-cookbook/
+
+    inline biquad_coefficients highshelf(number frequency, number q, number gain_in_db, number sampling_frequency) {
+        auto A     = pow(10.0, gain_in_db / 40.0);
+        auto w0    = 2.0 * M_PI * frequency / sampling_frequency;
+        auto cosw0 = cos(w0);
+        auto beta  = 2.0 * sqrt(A) * sin(w0) / (2.0 * q);
+        auto a0    = (A + 1.0) - (A - 1.0) * cosw0 + beta;
+
+        return {A * ((A + 1.0) + (A - 1.0) * cosw0 + beta) / a0, -2.0 * A * ((A - 1.0) + (A + 1.0) * cosw0) / a0,
+            A * ((A + 1.0) + (A - 1.0) * cosw0 - beta) / a0, 2.0 * ((A - 1.0) - (A + 1.0) * cosw0) / a0,
+            ((A + 1.0) - (A - 1.0) * cosw0 - beta) / a0};
+    }
+
+
 }    // namespace c74::min::lib::filters
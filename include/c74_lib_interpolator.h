@@ -5,6 +5,11 @@
 
 #pragma once
 
+#include "c74_lib_denormal.h"
+#include "c74_lib_math.h"
+
+#include <array>
+
 // Visual Studio 2015 doesn't have full support for constexpr
 #if !defined(_MSC_VER) || (_MSC_VER > 1900)
 #define MIN_CONSTEXPR constexpr
@@ -177,7 +182,9 @@ namespace c74::min::lib {
 
             MIN_CONSTEXPR T operator()(T x1, T x2, double delta) noexcept {
                 T out = x1 + delta * (x2 - mY1);
-                mY1   = out;
+                if (mFlush)
+                    out = denormal::flush(out);
+                mY1 = out;
                 return out;
             }
 
@@ -203,15 +210,32 @@ namespace c74::min::lib {
                 mY1 = T(0.0);
             }
 
+
+            /// Flush the interpolator history to zero once it decays below denormal::threshold.
+            /// @param	new_flush	True to flush the history. Default is false.
+
+            void flush_denormals(bool new_flush) {
+                mFlush = new_flush;
+            }
+
+            /// Determine if the interpolator history is flushed to zero once it decays below denormal::threshold.
+            /// @return	True if the history is flushed.
+
+            bool flush_denormals() {
+                return mFlush;
+            }
+
         private:
-            T mY1 = T(0.0);
+            T    mY1    = T(0.0);
+            bool mFlush = false;
         };
 
 
         /// Cosine interpolator
-        ///	@tparam	T		The data type to interpolate. By default this is the number type.
+        ///	@tparam	T				The data type to interpolate. By default this is the number type.
+        ///	@tparam	math_policy		How the cosine is evaluated: math::precise by default, or math::fast.
 
-        template<class T = number>
+        template<class T = number, class math_policy = math::precise>
         class cosine : public base<T> {
         public:
             static const int delay = 1;
@@ -223,7 +247,7 @@ namespace c74::min::lib {
             /// @return			The interpolated value
 
             MIN_CONSTEXPR T operator()(T x1, T x2, double delta) noexcept {
-                T a = 0.5 * (1.0 - cos(delta * M_PI));
+                T a = 0.5 * (1.0 - math_policy::cos(delta * M_PI));
                 return x1 + a * (x2 - x1);
             }
 
@@ -456,5 +480,77 @@ namespace c74::min::lib {
                 = static_cast<int>(type::hermite);    ///< index of the hermite interpolator, stored to avoid repeat casting
         };
 
+
+
+        /// Calculate a run of samples of a function of time from its values at knots spaced evenly in time.
+        /// This saves evaluating a function that is expensive but changes slowly at every sample,
+        /// e.g. an envelope that modulates a parameter.
+        /// The function is evaluated at every multiple of the interval and at the end, so the output is exact at those samples.
+        /// Between them, linear interpolation is within interval^2 * max|f''| / 8 of the function, with the derivative taken per sample.
+        /// Spline interpolation is a Catmull-Rom cubic, which extrapolates linearly beyond the first and last knots,
+        /// so it is exact for straight lines.
+        /// @param	function	The function, called as function(index) for sample indices in the range [0, end].
+        /// @param	kind		The interpolation, type::linear or type::spline.
+        /// @param	interval	The spacing of the knots in samples. An interval of one evaluates the function at every sample.
+        /// @param	begin		The index of the sample before the first one to calculate.
+        /// @param	count		The number of samples to calculate, no more than end - begin.
+        /// @param	end			The last index at which the function may be evaluated.
+        /// @param	output		Storage for the samples at indices begin + 1 to begin + count.
+
+        template<class function_type>
+        void knots(function_type&& function, type kind, int interval, int begin, int count, int end, sample* output) {
+            if (interval <= 1) {
+                for (auto i = 1; i <= count; ++i)
+                    *output++ = function(begin + i);
+                return;
+            }
+
+            linear<>	linear_interpolator;
+            spline<>	spline_interpolator;
+            auto		index	= begin;
+            const auto	last	= begin + count;
+
+            // the knots evaluated for the previous interval, which the next one shares, so each is evaluated only once
+            std::array<int, 4>		known_index { -1, -1, -1, -1 };
+            std::array<number, 4>	known_value {};
+            auto knot = [&](int i) -> number {
+                for (auto k = 0; k < 4; ++k) {
+                    if (known_index[k] == i)
+                        return known_value[k];
+                }
+                return function(i);
+            };
+
+            while (index < last) {
+                const auto a    = (index / interval) * interval;
+                const auto b    = std::min(a + interval, end);
+                const auto stop = std::min(b, last);
+                const auto x1   = knot(a);
+                const auto x2   = knot(b);
+
+                if (kind == type::spline) {
+                    // the outer knots have the same spacing as the inner two, which is shorter for the last interval
+                    const auto d  = b - a;
+                    const auto x0 = a - d >= 0 ? knot(a - d) : 2.0 * x1 - x2;
+                    const auto x3 = b + d <= end ? knot(b + d) : 2.0 * x2 - x1;
+                    for (auto i = index + 1; i <= stop; ++i)
+                        *output++ = spline_interpolator(x0, x1, x2, x3, static_cast<double>(i - a) / d);
+
+                    known_index = { a - d >= 0 ? a - d : -1, a, b, b + d <= end ? b + d : -1 };
+                    known_value = { x0, x1, x2, x3 };
+                }
+                else {
+                    for (auto i = index + 1; i <= stop; ++i)
+                        *output++ = linear_interpolator(x1, x2, static_cast<double>(i - a) / (b - a));
+
+                    known_index[1] = a;
+                    known_index[2] = b;
+                    known_value[1] = x1;
+                    known_value[2] = x2;
+                }
+                index = stop;
+            }
+        }
+
     }    // namespace interpolator
 }      // namespace c74::min::lib
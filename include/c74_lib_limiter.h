@@ -6,12 +6,26 @@
 #pragma once
 
 #include "c74_min_api.h"
+#include "c74_lib_denormal.h"
+#include "c74_lib_parameter.h"
 
 
 namespace c74::min::lib {
 
 
     ///	Lookahead limiter for n-channels of audio.
+    ///	The output is delayed by the lookahead, so that the gain can ramp down ahead of each peak.
+    ///
+    ///	The attribute setters may be called from a control thread while the audio thread is processing.
+    ///	They compute new coefficients and publish them through a lock-free snapshot which the audio thread
+    ///	picks up at the start of the next vector, so no locking is required by the host.
+    ///	Only one control thread may set attributes at a time. clear() must be called from the audio thread.
+    ///
+    ///	When the channels are not fully linked, every group over the threshold ramps its gain back through the lookahead window.
+    ///	The groups share one pass, and each leaves it as soon as its ramp stops lowering the gain,
+    ///	but a loud signal in many groups still costs up to the lookahead in steps for each group.
+    ///	The ramp toward a peak depends on its distance as well as its level, so the gain is not a sliding-window maximum
+    ///	and cannot be tracked with a monotonic deque without changing the response of the limiter.
 
     class limiter {
     public:
@@ -28,14 +42,33 @@ namespace c74::min::lib {
             m_channelcount = a_channel_count;
             m_samplerate = a_samplerate;
 
-            for (auto i = 0; i < m_channelcount; ++i)
-                m_dcblockers.push_back(std::make_unique<lib::dcblocker>());
+            m_dcblockers.resize(m_channelcount);
 
             m_lookahead_buffers.resize(m_channelcount);
             for (auto& buffer : m_lookahead_buffers)
                 buffer.resize(m_buffer_size);
-            m_gain_buffer.resize(m_buffer_size);
+
+            // there can never be more groups than channels, so allocate for the worst case up front
+            m_gain.resize(m_buffer_size * m_channelcount);
+            m_last.resize(m_channelcount);
+            m_hot.resize(m_channelcount);
+            m_target.resize(m_channelcount);
+            m_scanning.resize(m_channelcount);
+            m_groups.resize(m_channelcount);
+            m_pending_linking.group_of_channel.resize(m_channelcount);
+            m_ramp.resize(m_buffer_size);
+
+            // the default lookahead may not fit in a small buffer
+            m_lookahead = std::max(1, std::min(m_lookahead, m_buffer_size));
+            m_pending.lookahead = m_lookahead;
+            m_pending.lookahead_inv = 1.0 / static_cast<number>(m_lookahead);
+
             clear();
+            reset(m_release, m_mode, m_samplerate);
+            m_coefficients.read(m_active);
+            update_ramp();
+            link(m_link);
+            m_linking.update();
         }
 
 #if 0
@@ -48,6 +81,8 @@ namespace c74::min::lib {
 
         void bypass(bool a_state) {
             m_bypass = a_state;
+            m_pending.bypass = a_state;
+            publish();
         }
 
         /// Return the current state of the limiter bypass.
@@ -63,6 +98,8 @@ namespace c74::min::lib {
 
         void dcblock(bool use_dc_blocker) {
             m_dcblock = use_dc_blocker;
+            m_pending.dcblock = use_dc_blocker;
+            publish();
         }
 
         /// Return the current state of the dc-offset blocking filter applied to the input.
@@ -102,8 +139,10 @@ namespace c74::min::lib {
         ///												Must be less than or equal to the buffer size specified at creation time.
 
         void lookahead(int sample_count_for_lookahead_buffer) {
-            m_lookahead = sample_count_for_lookahead_buffer;
-            m_lookahead_inv = 1.0 / static_cast<number>(m_lookahead);
+            m_lookahead = std::max(1, std::min(sample_count_for_lookahead_buffer, m_buffer_size));
+            m_pending.lookahead = m_lookahead;
+            m_pending.lookahead_inv = 1.0 / static_cast<number>(m_lookahead);
+            publish();
         }
 
         /// Return the number of samples currently used for the lookahead function.
@@ -121,7 +160,8 @@ namespace c74::min::lib {
             using namespace dataspace;
 
             m_preamp = gain_in_db;
-            m_linear_preamp = gain::convert<gain::db, gain::linear>(m_preamp);
+            m_pending.linear_preamp = gain::convert<gain::db, gain::linear>(m_preamp);
+            publish();
         }
 
         /// Gain (db) applied prior to processing.
@@ -139,7 +179,8 @@ namespace c74::min::lib {
             using namespace dataspace;
 
             m_postamp = gain_in_db;
-            m_linear_postamp = gain::convert<gain::db, gain::linear>(m_postamp);
+            m_pending.linear_postamp = gain::convert<gain::db, gain::linear>(m_postamp);
+            publish();
         }
 
         /// Gain (db) applied after to processing.
@@ -157,7 +198,8 @@ namespace c74::min::lib {
             using namespace dataspace;
 
             m_threshold = threshold_in_db;
-            m_linear_threshold = gain::convert<gain::db, gain::linear>(m_threshold);
+            m_pending.linear_threshold = gain::convert<gain::db, gain::linear>(m_threshold);
+            publish();
         }
 
         /// Level (db) above which to apply limiting.
@@ -183,34 +225,89 @@ namespace c74::min::lib {
             return m_release;
         }
 
+        /// Options for how the gain reduction of the channels is linked.
+
+        enum class link_mode : int {
+            full,			///< the same gain reduction is applied to all channels
+            per_channel,	///< every channel is limited independently
+            grouped,		///< channels are linked within the groups specified by groups()
+            enum_count
+        };
+
+        /// Set how the gain reduction is linked between channels.
+        /// The new linking is published to the audio thread in the same way as the other attributes,
+        /// and the gain reduction is reset when the audio thread picks it up.
+        /// @param	a_mode	The new link mode.
+
+        void link(link_mode a_mode) {
+            auto& group_of_channel = m_pending_linking.group_of_channel;
+
+            m_link = a_mode;
+
+            if (m_link == link_mode::full)
+                std::fill(group_of_channel.begin(), group_of_channel.end(), 0);
+            else if (m_link == link_mode::per_channel)
+                std::iota(group_of_channel.begin(), group_of_channel.end(), 0);
+            else
+                std::copy(m_groups.begin(), m_groups.begin() + m_channelcount, group_of_channel.begin());
+
+            m_pending_linking.group_count = *std::max_element(group_of_channel.begin(), group_of_channel.end()) + 1;
+            m_linking.write(m_pending_linking);
+        }
+
+        /// Return how the gain reduction is linked between channels.
+        /// @return The current link mode.
+
+        link_mode link() {
+            return m_link;
+        }
+
+
+        /// Set the groups used when the link mode is link_mode::grouped.
+        /// For example, for 5.1 audio ordered L R C LFE Ls Rs the groups { 0, 0, 0, 1, 2, 2 } link the front channels,
+        /// limit the LFE on its own, and link the surround channels.
+        /// @param	channel_groups	The group index for each channel, in the range [0, channel count - 1].
+
+        void groups(const std::vector<int>& channel_groups) {
+            assert(channel_groups.size() == static_cast<std::size_t>(m_channelcount));
+            for (auto channel = 0; channel < m_channelcount; ++channel)
+                m_groups[channel] = MIN_CLAMP(channel_groups[channel], 0, m_channelcount - 1);
+            link(m_link);
+        }
+
 #if 0
 #pragma mark -
 #pragma mark methods
 #endif
 
         /// Reset the limiter history.
+        /// Unlike the attribute setters this touches the audio state directly and must be called from the audio thread.
+        /// It does not touch the coefficients, which are only ever published by the control thread.
 
         void clear() {
             for (auto& filter : m_dcblockers)
-                filter->clear();
+                filter.clear();
             for (auto& buffer : m_lookahead_buffers)
                 std::fill(buffer.begin(), buffer.end(), 0.0);
-            std::fill(m_gain_buffer.begin(), m_gain_buffer.end(), 1.0);
-            m_last = 1.0;
+            clear_gain();
             m_lookahead_index = 0;
-
-            reset(m_release, m_mode, m_samplerate);
         }
 
 
-        /// Reset time-dependent internal coefficients
+        /// Reset time-dependent internal coefficients.
+        /// The new coefficients are published to the audio thread in the same way as the attribute setters.
 
         void reset(number release, response_mode mode, number sample_rate) {
-            m_recover = 1000.0 / (release * sample_rate);
+            m_release = release;
+            m_mode = mode;
+            m_samplerate = sample_rate;
+            m_pending.mode = mode;
+            m_pending.recover = 1000.0 / (release * sample_rate);
             if (mode == response_mode::linear)
-                m_recover *= 0.5;
+                m_pending.recover *= 0.5;
             else // exponential
-                m_recover *= 0.707;
+                m_pending.recover *= 0.707;
+            publish();
         }
 
 #if 0
@@ -222,117 +319,226 @@ namespace c74::min::lib {
         /// The number of channels at the input and output must match the channel count of the limiter.
 
         void operator()(audio_bundle input, audio_bundle output) {
-            if (m_bypass) {
+            limit(input, nullptr, output);
+        }
+
+
+        /// Calculate n-samples for m-channels, detecting the level from a sidechain rather than from the input.
+        /// The preamp is applied to the sidechain before detection so the threshold has the same meaning in both cases.
+        /// The number of channels at the input, sidechain, and output must match the channel count of the limiter.
+
+        void operator()(audio_bundle input, audio_bundle sidechain, audio_bundle output) {
+            limit(input, &sidechain, output);
+        }
+
+
+    private:
+        /// Values derived from the attributes that are read by the audio thread.
+        /// These are computed on the control thread and handed over as a single unit.
+
+        struct coefficients {
+            number			linear_preamp		{1.0};
+            number			linear_postamp		{1.0};
+            number			linear_threshold	{1.0};
+            number			recover				{0.0};
+            int				lookahead			{100};		// in samples
+            number			lookahead_inv		{1.0 / 100};
+            response_mode	mode				{response_mode::exponential};
+            bool			dcblock				{true};
+            bool			bypass				{false};
+        };
+
+        void publish() {
+            m_coefficients.write(m_pending);
+        }
+
+
+        /// How the channels are linked, as handed to the audio thread by link().
+
+        struct linking {
+            vector<int>		group_of_channel;			// group used for each channel in the current link mode
+            int				group_count			{1};
+        };
+
+
+        /// Calculate the shape of the gain reduction ramp across the lookahead window.
+        /// The ramp is the same for every group, so it is computed once per change rather than once per group and sample.
+
+        void update_ramp() {
+            auto is_linear = (m_active.mode == response_mode::linear);
+
+            for (auto j = 0; j < m_active.lookahead; ++j) {
+                auto acc  = j * m_active.lookahead_inv;
+                m_ramp[j] = is_linear ? acc : acc * acc;
+            }
+        }
+
+
+        /// Reset the gain reduction of all groups.
+
+        void clear_gain() {
+            std::fill(m_gain.begin(), m_gain.end(), 1.0);
+            std::fill(m_last.begin(), m_last.end(), 1.0);
+        }
+
+
+        /// Limit a vector of audio, with an optional sidechain for detection.
+
+        void limit(audio_bundle& input, audio_bundle* sidechain, audio_bundle& output) {
+            denormal::guard guard;
+
+            if (m_coefficients.read(m_active))
+                update_ramp();
+            if (m_linking.update())
+                clear_gain();
+
+            const auto& c = m_active;
+            const auto& group_of_channel = m_linking.current().group_of_channel;
+
+            if (c.bypass) {
                 output = input;
                 return;
             }
 
-            int    lookahead = m_lookahead;
-            bool   is_linear = (m_mode == response_mode::linear);
-            bool   dcblock = m_dcblock;
+            int    lookahead = c.lookahead;
+            bool   is_linear = (c.mode == response_mode::linear);
+            bool   dcblock = c.dcblock;
+            int    groups = m_linking.current().group_count;
             sample v;
 
+            if (m_lookahead_index >= lookahead)
+                m_lookahead_index = 0;
+
             for (auto i = 0; i < input.frame_count(); ++i) {
-                sample hot_sample {0.0};
+                auto gain = m_gain.data() + m_lookahead_index * groups;    // the oldest row, which is played and then reused
+
+                std::fill_n(m_hot.begin(), groups, 0.0);
 
                 for (auto channel = 0; channel < m_channelcount; ++channel) {
-                    auto x = input.samples(channel);
+                    auto x     = input.samples(channel)[i];
+                    auto y     = output.samples(channel);
+                    auto group = group_of_channel[channel];
 
                     // Preprocessing (DC Blocking, Preamp)
 
-                    v = dcblock ? (*m_dcblockers[channel])(x[i]) : x[i];
-                    v *= m_linear_preamp;
+                    v = dcblock ? m_dcblockers[channel](x) : x;
+                    v *= c.linear_preamp;
+
+                    // Play the sample from one lookahead ago before its slot is reused
+
+                    auto& delayed = m_lookahead_buffers[channel][m_lookahead_index];
+                    if (sidechain)
+                        x = sidechain->samples(channel)[i];
+                    y[i]    = delayed * gain[group];
+                    delayed = v * c.linear_postamp;
 
                     // Analysis
 
-                    m_lookahead_buffers[channel][m_lookahead_index] = v * m_linear_postamp;
+                    if (sidechain)
+                        v = x * c.linear_preamp;
                     v = fabs(v);
-                    if (v > hot_sample)
-                        hot_sample = v;
-                }
 
-                if (is_linear)
-                    v = m_last + m_recover;
-                else {
-                    if (m_last > 0.01)
-                        v = m_last + m_recover * m_last;
-                    else
-                        v = m_last + m_recover;
+                    if (v > m_hot[group])
+                        m_hot[group] = v;
                 }
 
-                if (v > 1)
-                    v = 1;
-                m_gain_buffer[m_lookahead_index] = v;
+                // Recover every group from the newest gain, and note the groups whose new peak is over the threshold
 
-                int lookahead_playback = m_lookahead_index - lookahead;
-                if (lookahead_playback < 0)
-                    lookahead_playback += lookahead;
+                auto scanning = 0;
 
-                // Process
+                for (auto group = 0; group < groups; ++group) {
+                    auto last = m_last[group];
 
-                if (hot_sample * v > m_linear_threshold) {
-                    number newgain;
-                    auto   curgain = m_linear_threshold / hot_sample;
-                    auto   inc     = m_linear_threshold - curgain;
-                    auto   acc     = 0.0;
-                    auto   flag    = 0;
-
-                    for (auto j = 0; flag == 0 && j < lookahead; j++) {
-                        auto k = m_lookahead_index - j;
-
-                        if (k < 0)
-                            k += lookahead;
-
-                        if (is_linear)
-                            newgain = curgain + inc * acc;
-                        else
-                            newgain = curgain + inc * (acc * acc);
-
-                        if (newgain < m_gain_buffer[k])
-                            m_gain_buffer[k] = newgain;
-                        else
-                            flag = 1;
-                        acc = acc + m_lookahead_inv;
+                    if (is_linear || last <= 0.01)
+                        v = last + c.recover;
+                    else
+                        v = last + c.recover * last;
+                    if (v > 1)
+                        v = 1;
+                    gain[group] = v;
+
+                    if (m_hot[group] * v > c.linear_threshold) {
+                        m_target[group]      = c.linear_threshold / m_hot[group];
+                        m_scanning[scanning] = group;
+                        ++scanning;
                     }
                 }
 
-                // Apply Gain
-
-                for (auto channel = 0; channel < m_channelcount; ++channel) {
-                    auto y = output.samples(channel);
-                    y[i]   = m_lookahead_buffers[channel][lookahead_playback] * m_gain_buffer[lookahead_playback];
+                // Ramp the gain down toward each new peak across the lookahead window.
+                // All the groups over the threshold share one pass back through the window,
+                // and each group leaves the pass as soon as its ramp no longer lowers the gain.
+
+                for (auto j = 0; scanning && j < lookahead; ++j) {
+                    auto k = m_lookahead_index - j;
+                    if (k < 0)
+                        k += lookahead;
+
+                    auto row  = m_gain.data() + k * groups;
+                    auto ramp = m_ramp[j];
+                    auto kept = 0;
+
+                    for (auto n = 0; n < scanning; ++n) {
+                        auto group   = m_scanning[n];
+                        auto curgain = m_target[group];
+                        auto newgain = curgain + (c.linear_threshold - curgain) * ramp;
+
+                        if (newgain < row[group]) {
+                            row[group]       = newgain;
+                            m_scanning[kept] = group;
+                            ++kept;
+                        }
+                    }
+                    scanning = kept;
                 }
 
-                m_last = m_gain_buffer[m_lookahead_index];
+                for (auto group = 0; group < groups; ++group)
+                    m_last[group] = gain[group];
+
                 ++m_lookahead_index;
                 if (m_lookahead_index >= lookahead)
                     m_lookahead_index = 0;
             }
         }
 
-
-    private:
         int									m_channelcount		{};  	  	// number of channels
         int									m_buffer_size		{};
         number								m_samplerate		{48000};
-        vector<unique_ptr<lib::dcblocker>>	m_dcblockers;
+        vector<lib::dcblocker>				m_dcblockers;
+
+        // attribute values as seen by the control thread
+
         bool								m_dcblock			{true};
         bool								m_bypass			{false};
         response_mode						m_mode				{response_mode::exponential};
         number								m_preamp			{0.0};		// in db
-        number								m_linear_preamp		{1.0};
         number								m_postamp			{0.0};		// in db
-        number								m_linear_postamp	{1.0};
         number								m_threshold			{0.0};		// in db
-        number								m_linear_threshold	{1.0};
         number								m_release	 		{1000.0};	// in ms
-		number                              m_recover {0.0};
-        number								m_last				{0.0};
         int									m_lookahead			{100};		// in samples
-        number								m_lookahead_inv		{1/100};
+        link_mode							m_link				{link_mode::full};
+        vector<int>							m_groups;						// as set by groups()
+        coefficients						m_pending;						// next coefficients to be published
+        linking								m_pending_linking;				// next linking to be published
+
+        // hand-off from the control thread to the audio thread
+
+        snapshot<coefficients>				m_coefficients;
+        snapshot<linking>					m_linking;
+
+        // audio thread
+
+        coefficients						m_active;						// coefficients currently in use
         int									m_lookahead_index	{0};
-        vector<sample_vector>				m_lookahead_buffers;
-        sample_vector						m_gain_buffer;
+        vector<sample_vector>				m_lookahead_buffers;			// [channel]
+        sample_vector						m_ramp;							// gain reduction shape shared by all groups
+
+        // gain reduction of the link groups, also owned by the audio thread
+
+        sample_vector						m_gain;							// [position][group], so that a row holds every group
+        sample_vector						m_last;							// [group]
+        sample_vector						m_hot;							// [group]
+        sample_vector						m_target;						// [group] gain needed by the newest peak
+        vector<int>							m_scanning;						// groups still ramping down in the current pass
     };
 
 }    // namespace c74::min::lib
@@ -0,0 +1,320 @@
+/// @file
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include "c74_min_api.h"
+#include "c74_lib_biquad.h"
+#include "c74_lib_circular_storage.h"
+#include "c74_lib_denormal.h"
+
+#include <atomic>
+#include <limits>
+#include <numeric>
+
+
+namespace c74::min::lib {
+
+
+    ///	Loudness meter for n-channels of audio as specified by
+    ///	<a href="https://www.itu.int/rec/R-REC-BS.1770">ITU-R BS.1770</a> and
+    ///	<a href="https://tech.ebu.ch/publications/r128">EBU R 128</a>.
+    ///
+    ///	Each channel is K-weighted and its mean square is accumulated into 100 ms blocks.
+    ///	The most recent blocks are kept in a ring from which the momentary (400 ms) and short-term (3 s) loudness are calculated.
+    ///	Gated integrated loudness is calculated from a histogram of 400 ms block loudness with a resolution of 0.1 LU,
+    ///	so memory use does not grow with the length of the programme.
+    ///
+    ///	No memory is allocated after construction. The measurements may be read from any thread.
+
+    class loudness_meter {
+    public:
+        /// Create a loudness meter instance.
+        /// @param a_channel_count	The number of channels to measure.
+        /// @param a_samplerate		The samplerate of the audio to be measured.
+        /// @param a_vector_size	The number of samples filtered internally at once.
+        ///							Larger vectors passed to the meter are processed in several passes.
+
+        loudness_meter(int a_channel_count = 2, number a_samplerate = 48000.0, int a_vector_size = 512)
+        : m_blocks(k_short_term_blocks + 1) {
+            m_channelcount  = a_channel_count;
+            m_samplerate    = a_samplerate;
+            m_vector_size   = a_vector_size;
+            m_block_samples = std::max(1, static_cast<int>(std::round(m_samplerate * 0.1)));
+
+            m_shelf.resize(m_channelcount, biquad {k_weighting_shelf(m_samplerate)});
+            m_highpass.resize(m_channelcount, biquad {k_weighting_highpass(m_samplerate)});
+            m_weights.resize(m_channelcount, 1.0);
+            m_scratch.resize(m_vector_size);
+            m_momentary_blocks.resize(k_momentary_blocks);
+            m_short_term_blocks.resize(k_short_term_blocks);
+        }
+
+#if 0
+#pragma mark -
+#pragma mark attributes
+#endif
+
+        /// Set the weighting applied to a channel when summing.
+        /// BS.1770 specifies 1.0 for left, right, and centre, 1.41 for the surround channels, and 0.0 for the LFE.
+        /// Must be set from the audio thread or before processing begins.
+        /// @param	channel		The channel to weight.
+        /// @param	weight		The new weight for the channel.
+
+        void weight(int channel, number weight) {
+            m_weights[channel] = weight;
+        }
+
+        /// Return the weighting applied to a channel when summing.
+        /// @param	channel		The channel.
+        /// @return				The weight for the channel.
+
+        number weight(int channel) {
+            return m_weights[channel];
+        }
+
+#if 0
+#pragma mark -
+#pragma mark measurements
+#endif
+
+        /// Return the loudness of the last 400 ms.
+        /// @return	The momentary loudness in LUFS, or -infinity if there is not yet enough audio.
+
+        number momentary() const {
+            return m_momentary.load(std::memory_order_relaxed);
+        }
+
+
+        /// Return the loudness of the last 3 seconds.
+        /// @return	The short-term loudness in LUFS, or -infinity if there is not yet enough audio.
+
+        number short_term() const {
+            return m_short_term.load(std::memory_order_relaxed);
+        }
+
+
+        /// Return the gated loudness of everything measured since the last clear().
+        /// @return	The integrated loudness in LUFS, or -infinity if no block has passed the gates.
+
+        number integrated() const {
+            return m_integrated.load(std::memory_order_relaxed);
+        }
+
+#if 0
+#pragma mark -
+#pragma mark methods
+#endif
+
+        /// Reset the meter, discarding all measurements. Must be called from the audio thread.
+
+        void clear() {
+            for (auto& filter : m_shelf)
+                filter.clear();
+            for (auto& filter : m_highpass)
+                filter.clear();
+            m_blocks.zero();
+            m_histogram_counts.fill(0);
+            m_histogram_energy.fill(0.0);
+            m_block_energy   = 0.0;
+            m_block_position = 0;
+            m_block_count    = 0;
+            m_momentary.store(k_silence, std::memory_order_relaxed);
+            m_short_term.store(k_silence, std::memory_order_relaxed);
+            m_integrated.store(k_silence, std::memory_order_relaxed);
+        }
+
+#if 0
+#pragma mark -
+#pragma mark audio
+#endif
+
+        /// Measure n-samples for m-channels.
+        /// The number of channels at the input must match the channel count of the meter.
+
+        void operator()(audio_bundle input) {
+            denormal::guard guard;
+
+            long frame_count = input.frame_count();
+            long offset      = 0;
+
+            while (offset < frame_count) {
+                // never straddle a block boundary so that each pass adds to exactly one block
+                auto n = std::min<long>({m_vector_size, frame_count - offset, m_block_samples - m_block_position});
+
+                for (auto channel = 0; channel < m_channelcount; ++channel) {
+                    auto weight = m_weights[channel];
+                    if (weight == 0.0)
+                        continue;
+
+                    auto y = m_scratch.data();
+                    m_shelf[channel].process(input.samples(channel) + offset, y, n);
+                    m_highpass[channel].process(y, y, n);
+
+                    sample sum {};
+                    for (auto i = 0; i < n; ++i)
+                        sum += y[i] * y[i];
+                    m_block_energy += sum * weight;
+                }
+
+                offset += n;
+                m_block_position += n;
+                if (m_block_position == m_block_samples)
+                    complete_block();
+            }
+        }
+
+
+        /// Convert a mean square energy to loudness.
+        /// @param	energy	The weighted sum of the mean square of the K-weighted channels.
+        /// @return			The loudness in LUFS.
+
+        static number energy_to_lufs(number energy) {
+            if (energy <= 0.0)
+                return k_silence;
+            return -0.691 + 10.0 * log10(energy);
+        }
+
+
+        /// Convert loudness to mean square energy.
+        /// @param	lufs	The loudness in LUFS.
+        /// @return			The weighted sum of the mean square of the K-weighted channels.
+
+        static number lufs_to_energy(number lufs) {
+            return pow(10.0, (lufs + 0.691) / 10.0);
+        }
+
+
+        /// Calculate the coefficients of the first stage of the K-weighting pre-filter, a high shelf modelling the head.
+        /// @param	sampling_frequency	The sampling frequency of the environment in hertz.
+        /// @return						The filter coefficients.
+
+        static filters::biquad_coefficients k_weighting_shelf(number sampling_frequency) {
+            const auto f0 = 1681.974450955533;
+            const auto g  = 3.999843853973347;
+            const auto q  = 0.7071752369554196;
+            const auto k  = tan(M_PI * f0 / sampling_frequency);
+            const auto vh = pow(10.0, g / 20.0);
+            const auto vb = pow(vh, 0.4996667741545416);
+            const auto a0 = 1.0 + k / q + k * k;
+
+            return {(vh + vb * k / q + k * k) / a0, 2.0 * (k * k - vh) / a0, (vh - vb * k / q + k * k) / a0, 2.0 * (k * k - 1.0) / a0,
+                (1.0 - k / q + k * k) / a0};
+        }
+
+
+        /// Calculate the coefficients of the second stage of the K-weighting pre-filter, the RLB highpass.
+        /// @param	sampling_frequency	The sampling frequency of the environment in hertz.
+        /// @return						The filter coefficients.
+
+        static filters::biquad_coefficients k_weighting_highpass(number sampling_frequency) {
+            const auto f0 = 38.13547087602444;
+            const auto q  = 0.5003270373238773;
+            const auto k  = tan(M_PI * f0 / sampling_frequency);
+            const auto a0 = 1.0 + k / q + k * k;
+
+            return {1.0, -2.0, 1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0};
+        }
+
+
+    private:
+        static constexpr int    k_momentary_blocks  = 4;                 // 400 ms
+        static constexpr int    k_short_term_blocks = 30;                // 3 s
+        static constexpr number k_absolute_gate     = -70.0;             // LUFS
+        static constexpr number k_relative_gate     = -10.0;             // LU
+        static constexpr number k_histogram_ceiling = 10.0;              // LUFS
+        static constexpr number k_histogram_step    = 0.1;               // LU
+        static constexpr int    k_histogram_size    = 800;               // (ceiling - absolute gate) / step
+        static constexpr number k_silence           = -std::numeric_limits<number>::infinity();
+
+
+        /// Called every 100 ms to update the measurements.
+
+        void complete_block() {
+            m_blocks.write(m_block_energy / m_block_samples);
+            m_block_energy   = 0.0;
+            m_block_position = 0;
+            ++m_block_count;
+
+            if (m_block_count >= k_momentary_blocks) {
+                m_blocks.head(m_momentary_blocks);
+                auto energy = mean(m_momentary_blocks);
+                m_momentary.store(energy_to_lufs(energy), std::memory_order_relaxed);
+
+                // gating blocks are 400 ms long and overlap by 75%, so one is completed every 100 ms
+                gate(energy);
+            }
+
+            if (m_block_count >= k_short_term_blocks) {
+                m_blocks.head(m_short_term_blocks);
+                m_short_term.store(energy_to_lufs(mean(m_short_term_blocks)), std::memory_order_relaxed);
+            }
+        }
+
+
+        /// Add a gating block to the histogram and recalculate the integrated loudness.
+
+        void gate(number energy) {
+            auto lufs = energy_to_lufs(energy);
+            if (lufs <= k_absolute_gate)
+                return;
+
+            auto bin = std::min(static_cast<int>((lufs - k_absolute_gate) / k_histogram_step), k_histogram_size - 1);
+            ++m_histogram_counts[bin];
+            m_histogram_energy[bin] += energy;
+
+            // relative threshold from all blocks above the absolute gate
+            auto threshold = k_relative_gate + energy_to_lufs(histogram_mean(0));
+            auto first_bin = MIN_CLAMP(static_cast<int>(ceil((threshold - k_absolute_gate) / k_histogram_step)), 0, k_histogram_size - 1);
+
+            m_integrated.store(energy_to_lufs(histogram_mean(first_bin)), std::memory_order_relaxed);
+        }
+
+
+        /// Mean energy of all gating blocks in the histogram from a given bin upward.
+
+        number histogram_mean(int first_bin) {
+            number        energy {};
+            std::uint64_t count {};
+
+            for (auto bin = first_bin; bin < k_histogram_size; ++bin) {
+                energy += m_histogram_energy[bin];
+                count += m_histogram_counts[bin];
+            }
+            return count ? energy / count : 0.0;
+        }
+
+
+        static number mean(const sample_vector& blocks) {
+            return std::accumulate(blocks.begin(), blocks.end(), 0.0) / blocks.size();
+        }
+
+
+        int												m_channelcount		{};
+        number											m_samplerate		{48000.0};
+        int												m_vector_size		{512};
+        int												m_block_samples		{4800};
+
+        vector<biquad>									m_shelf;			// [channel] first stage of K-weighting
+        vector<biquad>									m_highpass;			// [channel] second stage of K-weighting
+        sample_vector									m_weights;			// [channel]
+        sample_vector									m_scratch;
+
+        number											m_block_energy		{};
+        int												m_block_position	{};
+        std::uint64_t									m_block_count		{};
+        circular_storage<number>						m_blocks;			// mean square of the most recent 100 ms blocks
+        sample_vector									m_momentary_blocks;
+        sample_vector									m_short_term_blocks;
+
+        std::array<std::uint64_t, k_histogram_size>		m_histogram_counts	{};
+        std::array<number, k_histogram_size>			m_histogram_energy	{};
+
+        std::atomic<number>								m_momentary			{k_silence};
+        std::atomic<number>								m_short_term		{k_silence};
+        std::atomic<number>								m_integrated		{k_silence};
+    };
+
+}    // namespace c74::min::lib
@@ -7,11 +7,20 @@
 
 #include <random>
 #include <numeric>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
 
 namespace c74::min::lib::math {
 
 
     /// Generate a random number.
+    /// Each thread seeds its own generator from std::random_device on first use.
+    /// For random numbers on the audio thread use lib::xoshiro or the generators in lib::noise instead.
     /// @param	min		The minimum value for the range in which to generate.
     /// @param	max		The maximum value for the range in which to generate.
     ///	@return			The generated pseudo-random number.
@@ -19,31 +28,246 @@ namespace c74::min::lib::math {
     /// @see 			http://en.cppreference.com/w/cpp/numeric/random
 
     inline double random(double min, double max) {
-        std::random_device               rd;
-        std::mt19937                     gen{rd()};
+        thread_local std::mt19937        gen{std::random_device{}()};
         std::uniform_real_distribution<> dis{min, max};
 
         return dis(gen);
     }
 
 
+    ///	Streaming statistics of a signal: mean, variance, rms, extremes and crest factor.
+    ///
+    ///	Values are accumulated one at a time with Welford's algorithm, or a block at a time, without storing them.
+    ///	Blocks are summarized in short chunks with independent partial sums that the compiler vectorizes,
+    ///	and each chunk is combined into the running result with the same pairwise formula used by merge().
+    ///	Because of that, statistics gathered on several threads can be merged into one result that matches a single pass.
+    ///	Nothing is allocated, so an accumulator can be used on the audio thread.
+
+    class statistics {
+    public:
+        /// Reset to the state of no values.
+
+        void clear() {
+            *this = statistics {};
+        }
+
+
+        /// Add one value.
+        /// @param	x	The value.
+
+        void operator()(double x) {
+            ++m_count;
+            auto delta = x - m_mean;
+            m_mean += delta / m_count;
+            m_m2 += delta * (x - m_mean);
+            m_minimum = std::min(m_minimum, x);
+            m_maximum = std::max(m_maximum, x);
+        }
+
+
+        /// Add a block of values.
+        /// @param	x		The values.
+        /// @param	count	The number of values.
+
+        void update(const double* x, std::size_t count) {
+            for (std::size_t offset = 0; offset < count; offset += k_chunk)
+                merge(summarize(x + offset, std::min<std::size_t>(k_chunk, count - offset)));
+        }
+
+
+        /// Add all of the values accumulated by another instance, using the pairwise formula of Chan, Golub and LeVeque.
+        /// @param	other	The statistics to combine with these.
+
+        void merge(const statistics& other) {
+            if (other.m_count == 0)
+                return;
+
+            auto count = m_count + other.m_count;
+            auto delta = other.m_mean - m_mean;
+            auto ratio = static_cast<double>(other.m_count) / count;
+
+            m_mean += delta * ratio;
+            m_m2 += other.m_m2 + delta * delta * m_count * ratio;
+            m_count   = count;
+            m_minimum = std::min(m_minimum, other.m_minimum);
+            m_maximum = std::max(m_maximum, other.m_maximum);
+        }
+
+
+        /// Return the number of values accumulated.
+        /// @return	The count.
+
+        std::size_t count() const {
+            return m_count;
+        }
+
+
+        /// Return the mean of the values.
+        /// @return	The mean, or zero if there are no values.
+
+        double mean() const {
+            return m_mean;
+        }
+
+
+        /// Return the population variance of the values.
+        /// @return	The variance, or zero if there are no values.
+
+        double variance() const {
+            return m_count ? m_m2 / m_count : 0.0;
+        }
+
+
+        /// Return the population standard deviation of the values.
+        /// @return	The standard deviation.
+
+        double deviation() const {
+            return std::sqrt(variance());
+        }
+
+
+        /// Return the root-mean-square of the values.
+        /// @return	The rms, which is zero if there are no values.
+
+        double rms() const {
+            return std::sqrt(m_mean * m_mean + variance());
+        }
+
+
+        /// Return the smallest value.
+        /// @return	The minimum, which is infinite if there are no values.
+
+        double minimum() const {
+            return m_minimum;
+        }
+
+
+        /// Return the largest value.
+        /// @return	The maximum, which is negative infinity if there are no values.
+
+        double maximum() const {
+            return m_maximum;
+        }
+
+
+        /// Return the largest absolute value.
+        /// @return	The peak, which is zero if there are no values.
+
+        double peak() const {
+            return m_count ? std::max(-m_minimum, m_maximum) : 0.0;
+        }
+
+
+        /// Return the ratio of the peak to the rms. A sine has a crest factor of sqrt(2).
+        /// @return	The crest factor, or zero if the rms is zero.
+
+        double crest_factor() const {
+            auto r = rms();
+            return r > 0.0 ? peak() / r : 0.0;
+        }
+
+
+    private:
+        static constexpr std::size_t	k_chunk		= 256;		// values summarized at once, short enough to stay in the cache for the second pass
+        static constexpr int			k_partials	= 4;		// independent partial sums, so the compiler can vectorize without reassociating
+
+
+        /// Summarize a chunk of values in two passes: the mean, then the squared deviations from it and the extremes.
+
+        static statistics summarize(const double* x, std::size_t count) {
+            double sum[k_partials] {};
+            auto   whole = count - count % k_partials;
+
+            for (std::size_t i = 0; i < whole; i += k_partials) {
+                for (auto j = 0; j < k_partials; ++j)
+                    sum[j] += x[i + j];
+            }
+            for (auto i = whole; i < count; ++i)
+                sum[0] += x[i];
+
+            auto mean = (sum[0] + sum[1] + sum[2] + sum[3]) / count;
+
+            double m2[k_partials] {};
+            double lo[k_partials];
+            double hi[k_partials];
+            for (auto j = 0; j < k_partials; ++j) {
+                lo[j] = std::numeric_limits<double>::infinity();
+                hi[j] = -std::numeric_limits<double>::infinity();
+            }
+
+            for (std::size_t i = 0; i < whole; i += k_partials) {
+                for (auto j = 0; j < k_partials; ++j) {
+                    auto d = x[i + j] - mean;
+                    m2[j] += d * d;
+                    lo[j] = std::min(lo[j], x[i + j]);
+                    hi[j] = std::max(hi[j], x[i + j]);
+                }
+            }
+            for (auto i = whole; i < count; ++i) {
+                auto d = x[i] - mean;
+                m2[0] += d * d;
+                lo[0] = std::min(lo[0], x[i]);
+                hi[0] = std::max(hi[0], x[i]);
+            }
+
+            statistics result;
+            result.m_count   = count;
+            result.m_mean    = mean;
+            result.m_m2      = m2[0] + m2[1] + m2[2] + m2[3];
+            result.m_minimum = std::min(std::min(lo[0], lo[1]), std::min(lo[2], lo[3]));
+            result.m_maximum = std::max(std::max(hi[0], hi[1]), std::max(hi[2], hi[3]));
+            return result;
+        }
+
+
+        std::size_t	m_count		{};
+        double		m_mean		{};
+        double		m_m2		{};		// sum of squared deviations from the mean
+        double		m_minimum	{ std::numeric_limits<double>::infinity() };
+        double		m_maximum	{ -std::numeric_limits<double>::infinity() };
+    };
+
+
     /// Calculate the mean and standard-deviation from a vector of numerical input.
+    /// This makes a single pass without allocating. To accumulate statistics over time, use the statistics class.
     /// @tparam T      The data type of the items in the vector of input.
     /// @param	v	A vector of numerical input.
     ///	@return		A std::pair containing the mean and the standard deviation.
 
     template<class T>
     auto mean(const std::vector<T>& v) {
-        double sum  = std::accumulate(v.begin(), v.end(), 0.0);
-        double mean = sum / v.size();
+        statistics s;
+
+        if constexpr (std::is_same_v<T, double>)
+            s.update(v.data(), v.size());
+        else {
+            for (const auto& x : v)
+                s(static_cast<double>(x));
+        }
+        return std::make_pair(s.mean(), s.deviation());
+    }
+
+
+    /// Choose between two values with an integer mask rather than a branch, so that a loop which calls it can be vectorized.
+    /// A conditional expression on floating-point values becomes a branch unless the compiler may ignore floating-point traps.
+    /// Both values are evaluated, so they should be cheap and must not have side effects.
+    /// @param	condition	The condition to test.
+    /// @param	a			The value to return when the condition is true.
+    /// @param	b			The value to return when the condition is false.
+    /// @return				Either a or b.
 
-        std::vector<double> diff(v.size());
-        std::transform(v.begin(), v.end(), diff.begin(), [mean](double x) { return x - mean; });
+    inline double select(bool condition, double a, double b) {
+        std::uint64_t a_bits;
+        std::uint64_t b_bits;
+        std::memcpy(&a_bits, &a, sizeof a_bits);
+        std::memcpy(&b_bits, &b, sizeof b_bits);
 
-        double sq_sum = std::inner_product(diff.begin(), diff.end(), diff.begin(), 0.0);
-        double stdev  = std::sqrt(sq_sum / v.size());
+        auto mask = 0 - static_cast<std::uint64_t>(condition);
+        auto bits = (a_bits & mask) | (b_bits & ~mask);
 
-        return std::make_pair(mean, stdev);
+        double result;
+        std::memcpy(&result, &bits, sizeof result);
+        return result;
     }
 
 
@@ -67,4 +291,234 @@ namespace c74::min::lib::math {
     }
 
 
+    ///	Reference implementations of the elementary functions, using the standard library.
+    ///	Processors that accept a math policy as a template parameter use this one by default.
+    ///	Each function also has a block overload that processes a vector of values.
+
+    struct precise {
+        static double sin(double x) { return std::sin(x); }
+        static double cos(double x) { return std::cos(x); }
+        static double exp(double x) { return std::exp(x); }
+        static double exp2(double x) { return std::exp2(x); }
+        static double log2(double x) { return std::log2(x); }
+        static double pow(double x, double y) { return std::pow(x, y); }
+        static double tanh(double x) { return std::tanh(x); }
+
+        static void sin(const double* in, double* out, std::size_t n) { std::transform(in, in + n, out, [](double x) { return std::sin(x); }); }
+        static void cos(const double* in, double* out, std::size_t n) { std::transform(in, in + n, out, [](double x) { return std::cos(x); }); }
+        static void exp(const double* in, double* out, std::size_t n) { std::transform(in, in + n, out, [](double x) { return std::exp(x); }); }
+        static void exp2(const double* in, double* out, std::size_t n) { std::transform(in, in + n, out, [](double x) { return std::exp2(x); }); }
+        static void log2(const double* in, double* out, std::size_t n) { std::transform(in, in + n, out, [](double x) { return std::log2(x); }); }
+        static void pow(const double* in, double y, double* out, std::size_t n) { std::transform(in, in + n, out, [y](double x) { return std::pow(x, y); }); }
+        static void tanh(const double* in, double* out, std::size_t n) { std::transform(in, in + n, out, [](double x) { return std::tanh(x); }); }
+    };
+
+
+    ///	Fast approximations of the elementary functions, for use where a few parts per billion of error is inaudible.
+    ///
+    ///	Each function reduces its argument with bit manipulation and evaluates a short polynomial, without branches or calls,
+    ///	so the block overloads compile to vector instructions on any target the compiler can vectorize for.
+    ///	The maximum errors, measured against the standard library over the stated ranges, are:
+    ///
+    ///	| function	| range							| maximum error					|
+    ///	|-----------|-------------------------------|-------------------------------|
+    ///	| sin, cos	| [-1e6, 1e6]					| 2e-9 absolute					|
+    ///	| exp2		| [-1022, 1023]					| 1e-8 relative					|
+    ///	| exp		| [-708, 709]					| 1e-8 relative					|
+    ///	| log2		| positive normal numbers		| 1.5e-9 absolute				|
+    ///	| pow		| x > 0, result normal			| 1e-8 + 1e-9 * abs(y) relative	|
+    ///	| tanh		| finite numbers				| 5e-9 absolute					|
+    ///
+    ///	Outside these ranges exp2 and exp saturate near their values at the ends of the range,
+    ///	pow returns 0 for x <= 0, and log2 is not meaningful for zero, negative or subnormal input.
+
+    struct fast {
+
+        /// Sine of x in radians.
+
+        static double sin(double x) {
+            return sin_cos(x, 0);
+        }
+
+
+        /// Cosine of x in radians.
+
+        static double cos(double x) {
+            return sin_cos(x, 1);
+        }
+
+
+        /// 2 raised to the power x.
+
+        static double exp2(double x) {
+            // round to the nearest integer by adding 1.5 * 2^52, which leaves the integer in the low bits
+            auto shifted = x + k_round;
+            auto k       = shifted - k_round;
+            auto f       = (x - k) * k_ln2;    // |f| <= ln(2) / 2
+
+            auto p = 1.0 + f * (1.0 + f * (1.0 / 2 + f * (1.0 / 6 + f * (1.0 / 24 + f * (1.0 / 120 + f * (1.0 / 720 + f * (1.0 / 5040)))))));
+            return p * power_of_two(shifted);
+        }
+
+
+        /// e raised to the power x.
+
+        static double exp(double x) {
+            return exp2(x * k_log2e);
+        }
+
+
+        /// Base 2 logarithm of x.
+
+        static double log2(double x) {
+            std::int64_t bits;
+            std::memcpy(&bits, &x, sizeof bits);
+
+            // split into exponent and mantissa, with the mantissa in [sqrt(1/2), sqrt(2))
+            // all in the integer domain, which vectorizes where conversions and selects would not
+            auto mantissa_bits = (bits & 0x000FFFFFFFFFFFFFLL) | 0x3FF0000000000000LL;
+            auto large         = static_cast<std::int64_t>(mantissa_bits > k_sqrt2_bits);
+            auto exponent      = (bits >> 52) - 1023 + large;
+            mantissa_bits -= large << 52;
+
+            double m;
+            std::memcpy(&m, &mantissa_bits, sizeof m);
+
+            // ln(m) = 2 atanh(t) with t = (m - 1) / (m + 1), and |t| < 0.172
+            auto t  = (m - 1.0) / (m + 1.0);
+            auto t2 = t * t;
+            auto ln = 2.0 * t * (1.0 + t2 * (1.0 / 3 + t2 * (1.0 / 5 + t2 * (1.0 / 7 + t2 * (1.0 / 9)))));
+
+            // convert the exponent with the rounding constant, since a vector conversion from 64-bit integers is rarely available
+            auto   exponent_bits = exponent + 0x4338000000000000LL;
+            double e;
+            std::memcpy(&e, &exponent_bits, sizeof e);
+
+            return (e - k_round) + ln * k_log2e;
+        }
+
+
+        /// x raised to the power y, for x > 0. Returns zero for x <= 0.
+
+        static double pow(double x, double y) {
+            auto result = exp2(y * log2(x));
+
+            // clear the result for x <= 0 with an integer mask, since converting the comparison to a number stops the compiler from vectorizing
+            std::int64_t x_bits;
+            std::int64_t result_bits;
+            std::memcpy(&x_bits, &x, sizeof x_bits);
+            std::memcpy(&result_bits, &result, sizeof result_bits);
+            result_bits &= -static_cast<std::int64_t>(x_bits > 0);
+            std::memcpy(&result, &result_bits, sizeof result);
+            return result;
+        }
+
+
+        /// Hyperbolic tangent of x.
+
+        static double tanh(double x) {
+            // exp2() saturates rather than overflowing, so the quotient goes smoothly to +/-1
+            auto e = exp2(x * (2.0 * k_log2e));
+            return (e - 1.0) / (e + 1.0);
+        }
+
+
+        /// Block overloads, which may process in-place.
+
+        static void sin(const double* in, double* out, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i)
+                out[i] = sin(in[i]);
+        }
+
+        static void cos(const double* in, double* out, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i)
+                out[i] = cos(in[i]);
+        }
+
+        static void exp(const double* in, double* out, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i)
+                out[i] = exp(in[i]);
+        }
+
+        static void exp2(const double* in, double* out, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i)
+                out[i] = exp2(in[i]);
+        }
+
+        static void log2(const double* in, double* out, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i)
+                out[i] = log2(in[i]);
+        }
+
+        static void pow(const double* in, double y, double* out, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i)
+                out[i] = pow(in[i], y);
+        }
+
+        static void tanh(const double* in, double* out, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i)
+                out[i] = tanh(in[i]);
+        }
+
+
+    private:
+        static constexpr double k_round = 6755399441055744.0;    // 1.5 * 2^52
+        static constexpr double k_ln2   = 0.69314718055994530942;
+        static constexpr double k_log2e = 1.44269504088896340736;
+        static constexpr std::int64_t k_sqrt2_bits = 0x3FF6A09E667F3BCDLL;    // sqrt(2)
+
+
+        /// 2 to the power of the integer in the low bits of a number offset by k_round.
+        /// The integer is clamped to the range of normal exponents, in the integer domain since clamping the double
+        /// before reinterpreting it stops the compiler from vectorizing.
+
+        static double power_of_two(double shifted) {
+            std::int64_t k;
+            std::memcpy(&k, &shifted, sizeof k);
+            k = std::min<std::int64_t>(std::max<std::int64_t>(k - 0x4338000000000000LL, -1022), 1023);
+
+            auto   bits = (k + 1023) << 52;
+            double result;
+            std::memcpy(&result, &bits, sizeof result);
+            return result;
+        }
+
+
+        /// Sine of x plus a number of quarter turns.
+        /// The argument is reduced to |r| <= pi/4 with pi/2 split into two parts, so that the product with the quadrant is exact.
+
+        static double sin_cos(double x, std::int64_t quarter_turns) {
+            constexpr double two_over_pi = 0.63661977236758134308;
+            constexpr double pi_2_high   = 1.57079632673412561417e+00;    // the first 33 bits of pi/2
+            constexpr double pi_2_low    = 6.07710050650619224932e-11;    // pi/2 - pi_2_high
+
+            auto shifted = x * two_over_pi + k_round;
+            auto k       = shifted - k_round;
+            auto r       = (x - k * pi_2_high) - k * pi_2_low;
+            auto r2      = r * r;
+
+            std::int64_t quadrant;
+            std::memcpy(&quadrant, &shifted, sizeof quadrant);
+            quadrant += quarter_turns;
+
+            auto s = r * (1.0 - r2 * (1.0 / 6 - r2 * (1.0 / 120 - r2 * (1.0 / 5040 - r2 * (1.0 / 362880)))));
+            auto c = 1.0 - r2 * (1.0 / 2 - r2 * (1.0 / 24 - r2 * (1.0 / 720 - r2 * (1.0 / 40320 - r2 * (1.0 / 3628800)))));
+
+            // select the cosine in odd quadrants and negate in the second half of the turn, with masks rather than branches
+            std::uint64_t s_bits;
+            std::uint64_t c_bits;
+            std::memcpy(&s_bits, &s, sizeof s_bits);
+            std::memcpy(&c_bits, &c, sizeof c_bits);
+
+            auto q    = static_cast<std::uint64_t>(quadrant);
+            auto odd  = 0 - (q & 1);
+            auto bits = ((s_bits & ~odd) | (c_bits & odd)) ^ ((q & 2) << 62);
+
+            double result;
+            std::memcpy(&result, &bits, sizeof result);
+            return result;
+        }
+    };
+
+
 }    // namespace c74::min::lib::math
@@ -0,0 +1,567 @@
+/// @file
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include "c74_min_api.h"
+#include "c74_lib_crossover.h"
+#include "c74_lib_limiter.h"
+
+#include <array>
+#include <limits>
+#include <memory>
+
+
+namespace c74::min::lib {
+
+
+    ///	Multiband lookahead limiter for n-channels of audio.
+    ///
+    ///	The input is split into bands with fourth-order Linkwitz-Riley crossovers.
+    ///	Each band below a crossover is passed through the allpass response of the crossovers above it,
+    ///	so the bands remain phase-coherent and sum back to a flat magnitude response.
+    ///	Every band is limited independently with the same lookahead, so the bands stay time-aligned,
+    ///	and the sum is then passed through a final brickwall stage to catch overs created by summation.
+    ///
+    ///	Like onepole_bank, the state of the bands is stored band-interleaved, as one array of bands per channel and lookahead position.
+    ///	The detection, gain recovery and gain ramps of all bands are computed by the same loops over that array,
+    ///	so the compiler can handle several bands with each vector instruction, and the bands are summed as they are played.
+    ///	The crossover tree is run a sample at a time for each channel and is not vectorized:
+    ///	every section depends on the output of the one before it, and a time-skewed tree that ran the sections side by side
+    ///	measured no faster while adding latency. The tree is most of the cost, so with 4 bands
+    ///	processing takes about 5-6 times as long as the single-band limiter.
+    ///	As with the limiter, the attributes may be set from a control thread while audio is processing.
+    /// @tparam	band_count	The number of bands. Must be at least 2.
+
+    template<int band_count = 4>
+    class multiband_limiter {
+        static_assert(band_count >= 2, "a multiband limiter needs at least two bands");
+
+        static constexpr int k_crossover_count = band_count - 1;
+        static constexpr int k_allpass_count   = (band_count - 1) * (band_count - 2) / 2;
+
+    public:
+        using frame         = std::array<sample, band_count>;    ///< one sample for each band
+        using response_mode = limiter::response_mode;
+
+
+        /// Create a multiband limiter instance.
+        /// @param a_channel_count	The number of channels to process with the limiter.
+        /// @param a_buffer_size	The maximum number of samples that may be used for the lookahead function.
+        /// @param a_samplerate		The samplerate at which the limiter will operate.
+
+        multiband_limiter(int a_channel_count = 2, int a_buffer_size = 512, number a_samplerate = 48000.0) {
+            m_channelcount = a_channel_count;
+            m_buffer_size  = a_buffer_size;
+            m_samplerate   = a_samplerate;
+
+            m_brickwall = std::make_unique<lib::limiter>(m_channelcount, a_buffer_size, m_samplerate);
+            m_brickwall->dcblock(false);
+            m_brickwall->release(50.0);
+            m_brickwall->lookahead(32);
+
+            m_crossovers.resize(m_channelcount);
+            m_allpasses.resize(m_channelcount);
+            m_dcblockers.resize(m_channelcount);
+
+            m_lookahead_buffer.resize(m_buffer_size * m_channelcount);
+            m_gain.resize(m_buffer_size);
+
+            for (auto k = 0; k < k_crossover_count; ++k)
+                m_frequencies[k] = 150.0 * pow(40.0, (k + 0.5) / k_crossover_count);    // spread logarithmically from 150 Hz to 6 kHz
+            update();
+            m_crossover_coefficients.read(m_active_crossovers);
+            apply();
+
+            m_lookahead = std::max(1, std::min(m_lookahead, m_buffer_size));
+            m_pending.lookahead     = m_lookahead;
+            m_pending.lookahead_inv = 1.0 / static_cast<number>(m_lookahead);
+            m_ramp.resize(m_buffer_size);
+            for (auto b = 0; b < band_count; ++b)
+                recover(b);
+            publish();
+            m_band_coefficients.read(m_active);
+            clear();
+            update_ramp();
+        }
+
+#if 0
+#pragma mark -
+#pragma mark attributes
+#endif
+
+        /// Set the frequency of one of the crossovers.
+        /// Frequencies should increase with the index of the crossover.
+        /// @param	index		The crossover to change in the range [0, band_count - 2].
+        /// @param	frequency	The new crossover frequency in hertz.
+
+        void frequency(int index, number frequency) {
+            assert(index >= 0 && index < k_crossover_count);
+            m_frequencies[index] = MIN_CLAMP(frequency, 1.0, m_samplerate * 0.49);
+            update();
+        }
+
+        /// Return the frequency of one of the crossovers.
+        /// @param	index	The crossover in the range [0, band_count - 2].
+        /// @return			The crossover frequency in hertz.
+
+        number frequency(int index) {
+            return m_frequencies[index];
+        }
+
+
+        /// Level (db) above which to apply limiting in one band.
+        /// @param	band			The band in the range [0, band_count - 1], lowest frequencies first.
+        /// @param	threshold_in_db	New value in decibels.
+
+        void threshold(int band, number threshold_in_db) {
+            using namespace dataspace;
+
+            m_threshold[band] = threshold_in_db;
+            m_pending.linear_threshold[band] = gain::convert<gain::db, gain::linear>(threshold_in_db);
+            publish();
+        }
+
+        /// Level (db) above which to apply limiting in one band.
+        /// @param	band	The band in the range [0, band_count - 1].
+        /// @return			The current value in decibels.
+
+        number threshold(int band) {
+            return m_threshold[band];
+        }
+
+
+        /// Gain (db) applied to one band prior to processing.
+        /// @param	band		The band in the range [0, band_count - 1].
+        /// @param	gain_in_db	New value in decibels.
+
+        void preamp(int band, number gain_in_db) {
+            using namespace dataspace;
+
+            m_preamp[band] = gain_in_db;
+            m_pending.linear_preamp[band] = gain::convert<gain::db, gain::linear>(gain_in_db);
+            publish();
+        }
+
+        /// Gain (db) applied to one band prior to processing.
+        /// @param	band	The band in the range [0, band_count - 1].
+        /// @return			The current value in decibels.
+
+        number preamp(int band) {
+            return m_preamp[band];
+        }
+
+
+        /// Gain (db) applied to one band after processing.
+        /// @param	band		The band in the range [0, band_count - 1].
+        /// @param	gain_in_db	New value in decibels.
+
+        void postamp(int band, number gain_in_db) {
+            using namespace dataspace;
+
+            m_postamp[band] = gain_in_db;
+            m_pending.linear_postamp[band] = gain::convert<gain::db, gain::linear>(gain_in_db);
+            publish();
+        }
+
+        /// Gain (db) applied to one band after processing.
+        /// @param	band	The band in the range [0, band_count - 1].
+        /// @return			The current value in decibels.
+
+        number postamp(int band) {
+            return m_postamp[band];
+        }
+
+
+        /// Millisecond release time of one band.
+        /// @param	band				The band in the range [0, band_count - 1].
+        /// @param	release_time_in_ms	New release time.
+
+        void release(int band, number release_time_in_ms) {
+            m_release[band] = release_time_in_ms;
+            recover(band);
+            publish();
+        }
+
+        /// Millisecond release time of one band.
+        /// @param	band	The band in the range [0, band_count - 1].
+        /// @return			The current value in milliseconds.
+
+        number release(int band) {
+            return m_release[band];
+        }
+
+
+        /// Set the shape used for the release response in all bands.
+        /// @param	a_mode	The new shape for the mode.
+
+        void mode(response_mode a_mode) {
+            m_mode = a_mode;
+            m_pending.mode = a_mode;
+            for (auto b = 0; b < band_count; ++b)
+                recover(b);
+            publish();
+        }
+
+        /// Return the shape used for the release response in all bands.
+        /// @return The current mode.
+
+        response_mode mode() {
+            return m_mode;
+        }
+
+
+        /// Turn on/off the dc-offset blocking filter applied to the lowest band, the only one in which dc can end up.
+        /// @param	use_dc_blocker	The new active state of the dc-blocker.
+
+        void dcblock(bool use_dc_blocker) {
+            m_dcblock = use_dc_blocker;
+            m_pending.dcblock = use_dc_blocker;
+            publish();
+        }
+
+        /// Return the current state of the dc-offset blocking filter.
+        /// @return The current active state of the dcblocker.
+
+        bool dcblock() {
+            return m_dcblock;
+        }
+
+
+        /// Number of samples to look ahead in every band.
+        /// @param sample_count_for_lookahead_buffer	The number of samples to look ahead.
+        ///												Must be less than or equal to the buffer size specified at creation time.
+
+        void lookahead(int sample_count_for_lookahead_buffer) {
+            m_lookahead = std::max(1, std::min(sample_count_for_lookahead_buffer, m_buffer_size));
+            m_pending.lookahead = m_lookahead;
+            m_pending.lookahead_inv = 1.0 / static_cast<number>(m_lookahead);
+            publish();
+        }
+
+        /// Return the number of samples currently used for the lookahead function in every band.
+        /// @return The current lookahead value.
+
+        int lookahead() {
+            return m_lookahead;
+        }
+
+
+        /// Change the samplerate at which the limiter operates.
+        /// The crossovers, the release of every band and the brickwall stage are recalculated for the new samplerate,
+        /// and published to the audio thread in the same way as the other attributes.
+        /// @param	a_samplerate	The new samplerate in hertz.
+
+        void samplerate(number a_samplerate) {
+            m_samplerate = a_samplerate;
+
+            for (auto& frequency : m_frequencies)
+                frequency = MIN_CLAMP(frequency, 1.0, m_samplerate * 0.49);
+            update();
+
+            for (auto b = 0; b < band_count; ++b)
+                recover(b);
+            publish();
+
+            m_brickwall->reset(m_brickwall->release(), m_brickwall->mode(), m_samplerate);
+        }
+
+        /// Return the samplerate at which the limiter operates.
+        /// @return	The samplerate in hertz.
+
+        number samplerate() {
+            return m_samplerate;
+        }
+
+
+        /// Level (db) of the final brickwall stage.
+        /// @param ceiling_in_db New value in decibels.
+
+        void ceiling(number ceiling_in_db) {
+            m_brickwall->threshold(ceiling_in_db);
+        }
+
+        /// Level (db) of the final brickwall stage.
+        /// @return The current value in decibels.
+
+        number ceiling() {
+            return m_brickwall->threshold();
+        }
+
+
+        /// Access the final brickwall limiter.
+        /// @return	A reference to the brickwall limiter.
+
+        lib::limiter& brickwall() {
+            return *m_brickwall;
+        }
+
+
+        /// Return the total delay introduced by the lookahead of the bands and the brickwall stage.
+        /// @return	The latency in samples.
+
+        int latency() {
+            return m_lookahead + m_brickwall->lookahead();
+        }
+
+#if 0
+#pragma mark -
+#pragma mark methods
+#endif
+
+        /// Reset the limiter history. Must be called from the audio thread.
+
+        void clear() {
+            for (auto& channel : m_crossovers)
+                for (auto& crossover : channel)
+                    crossover.clear();
+            for (auto& channel : m_allpasses)
+                for (auto& filter : channel)
+                    filter.clear();
+            for (auto& filter : m_dcblockers)
+                filter.clear();
+
+            std::fill(m_lookahead_buffer.begin(), m_lookahead_buffer.end(), frame {});
+            for (auto& gain : m_gain)
+                gain.fill(1.0);
+            m_last.fill(1.0);
+            m_lookahead_index = 0;
+
+            m_brickwall->clear();
+        }
+
+#if 0
+#pragma mark -
+#pragma mark audio
+#endif
+
+        /// Calculate n-samples for m-channels.
+        /// The number of channels at the input and output must match the channel count of the limiter.
+
+        void operator()(audio_bundle input, audio_bundle output) {
+            denormal::guard guard;
+
+            if (m_crossover_coefficients.read(m_active_crossovers))
+                apply();
+            if (m_band_coefficients.read(m_active))
+                update_ramp();
+
+            const auto& c         = m_active;
+            auto        lookahead = c.lookahead;
+            bool        is_linear = (c.mode == response_mode::linear);
+
+            if (m_lookahead_index >= lookahead)
+                m_lookahead_index = 0;
+
+            for (auto i = 0; i < input.frame_count(); ++i) {
+                auto& gain = m_gain[m_lookahead_index];    // the oldest gains, which are played and then reused
+                frame hot {};
+
+                for (auto channel = 0; channel < m_channelcount; ++channel) {
+                    auto  x       = split(channel, input.samples(channel)[i]);
+                    auto& delayed = m_lookahead_buffer[m_lookahead_index * m_channelcount + channel];
+                    auto  y       = 0.0;
+
+                    if (c.dcblock)
+                        x[0] = m_dcblockers[channel](x[0]);
+
+                    // Play and sum the bands from one lookahead ago, store the new bands in their place, and detect
+
+                    for (auto b = 0; b < band_count; ++b) {
+                        auto v = x[b] * c.linear_preamp[b];
+
+                        y += delayed[b] * gain[b];
+                        delayed[b] = v * c.linear_postamp[b];
+                        hot[b]     = std::max(hot[b], std::abs(v));
+                    }
+                    output.samples(channel)[i] = y;
+                }
+
+                // Recover every band from the newest gain, and ramp down toward the new peaks over the threshold.
+                // The bands share each pass back through the lookahead window until none of them lowers the gain any further.
+
+                frame target;
+                bool  scanning = false;
+                std::array<bool, band_count> lowering;
+
+                for (auto b = 0; b < band_count; ++b) {
+                    auto last = m_last[b];
+                    auto v    = (is_linear || last <= 0.01) ? last + c.recover[b] : last + c.recover[b] * last;
+
+                    gain[b]     = std::min(v, 1.0);
+                    lowering[b] = hot[b] * gain[b] > c.linear_threshold[b];
+                    target[b]   = c.linear_threshold[b] / std::max(hot[b], std::numeric_limits<sample>::min());
+                    scanning    = scanning || lowering[b];
+                }
+
+                for (auto j = 0; scanning && j < lookahead; ++j) {
+                    auto k = m_lookahead_index - j;
+                    if (k < 0)
+                        k += lookahead;
+
+                    auto& row  = m_gain[k];
+                    auto  ramp = m_ramp[j];
+
+                    scanning = false;
+                    for (auto b = 0; b < band_count; ++b) {
+                        auto newgain = target[b] + (c.linear_threshold[b] - target[b]) * ramp;
+
+                        lowering[b] = lowering[b] && newgain < row[b];
+                        row[b]      = lowering[b] ? newgain : row[b];
+                        scanning    = scanning || lowering[b];
+                    }
+                }
+
+                m_last = gain;
+
+                ++m_lookahead_index;
+                if (m_lookahead_index >= lookahead)
+                    m_lookahead_index = 0;
+            }
+
+            (*m_brickwall)(output, output);
+        }
+
+
+    private:
+        using crossover_coefficients = std::array<linkwitz_riley::coefficients, k_crossover_count>;
+
+
+        /// Values derived from the band attributes that are read by the audio thread, one per band.
+
+        struct coefficients {
+            frame			linear_preamp;
+            frame			linear_postamp;
+            frame			linear_threshold;
+            frame			recover;
+            int				lookahead			{100};		// in samples
+            number			lookahead_inv		{1.0 / 100};
+            response_mode	mode				{response_mode::exponential};
+            bool			dcblock				{true};
+        };
+
+        void publish() {
+            m_band_coefficients.write(m_pending);
+        }
+
+
+        /// Calculate the release coefficient of one band, as limiter::reset() does.
+
+        void recover(int band) {
+            m_pending.recover[band] = 1000.0 / (m_release[band] * m_samplerate);
+            if (m_mode == response_mode::linear)
+                m_pending.recover[band] *= 0.5;
+            else // exponential
+                m_pending.recover[band] *= 0.707;
+        }
+
+
+        /// Calculate the shape of the gain reduction ramp across the lookahead window, shared by all bands.
+
+        void update_ramp() {
+            auto is_linear = (m_active.mode == response_mode::linear);
+
+            for (auto j = 0; j < m_active.lookahead; ++j) {
+                auto acc  = j * m_active.lookahead_inv;
+                m_ramp[j] = is_linear ? acc : acc * acc;
+            }
+        }
+
+
+        /// Split one sample of a channel into bands.
+
+        frame split(int channel, sample x) {
+            frame bands;
+            auto& crossovers = m_crossovers[channel];
+            auto& allpasses  = m_allpasses[channel];
+            auto  ap         = 0;
+
+            for (auto k = 0; k < k_crossover_count; ++k) {
+                crossovers[k](x, bands[k], x);
+                for (auto m = k + 1; m < k_crossover_count; ++m)
+                    bands[k] = allpasses[ap++](bands[k]);
+            }
+            bands[band_count - 1] = x;
+            return bands;
+        }
+
+
+        /// Design the crossovers and publish them to the audio thread.
+
+        void update() {
+            crossover_coefficients c;
+            for (auto k = 0; k < k_crossover_count; ++k)
+                c[k] = linkwitz_riley::design(m_frequencies[k], m_samplerate);
+            m_crossover_coefficients.write(c);
+        }
+
+        /// Load the active crossover coefficients into the filters.
+
+        void apply() {
+            for (auto& channel : m_crossovers)
+                for (auto k = 0; k < k_crossover_count; ++k)
+                    channel[k].set(m_active_crossovers[k]);
+
+            for (auto& channel : m_allpasses) {
+                auto ap = 0;
+                for (auto k = 0; k < k_crossover_count; ++k)
+                    for (auto m = k + 1; m < k_crossover_count; ++m)
+                        channel[ap++].coefficients(m_active_crossovers[m].allpass);
+            }
+        }
+
+        int															m_channelcount		{};
+        int															m_buffer_size		{};
+        number														m_samplerate		{48000};
+
+        // attribute values as seen by the control thread
+
+        std::array<number, k_crossover_count>						m_frequencies		{};		// in hertz
+        frame														m_threshold			{};		// in db
+        frame														m_preamp			{};		// in db
+        frame														m_postamp			{};		// in db
+        std::array<number, band_count>								m_release			{make_release()};	// in ms
+        response_mode												m_mode				{response_mode::exponential};
+        bool														m_dcblock			{true};
+        int															m_lookahead			{100};		// in samples
+        coefficients												m_pending			{make_coefficients()};
+
+        // hand-off from the control thread to the audio thread
+
+        snapshot<crossover_coefficients>							m_crossover_coefficients;
+        snapshot<coefficients>										m_band_coefficients;
+
+        // audio thread
+
+        crossover_coefficients										m_active_crossovers	{};
+        coefficients												m_active			{};
+        vector<std::array<linkwitz_riley, k_crossover_count>>		m_crossovers;		// [channel][crossover]
+        vector<std::array<biquad, k_allpass_count>>					m_allpasses;		// [channel][compensation]
+        vector<lib::dcblocker>										m_dcblockers;		// [channel], for the lowest band
+        vector<frame>												m_lookahead_buffer;	// [position * channel count + channel][band]
+        vector<frame>												m_gain;				// [position][band]
+        frame														m_last				{};		// [band] newest gain
+        sample_vector												m_ramp;				// gain reduction shape shared by all bands
+        int															m_lookahead_index	{0};
+        std::unique_ptr<lib::limiter>								m_brickwall;
+
+
+        static std::array<number, band_count> make_release() {
+            std::array<number, band_count> release;
+            release.fill(1000.0);
+            return release;
+        }
+
+        static coefficients make_coefficients() {
+            coefficients c;
+            c.linear_preamp.fill(1.0);
+            c.linear_postamp.fill(1.0);
+            c.linear_threshold.fill(1.0);
+            c.recover.fill(0.0);
+            return c;
+        }
+    };
+
+}    // namespace c74::min::lib
@@ -0,0 +1,395 @@
+/// @file
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include "c74_min_api.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+
+namespace c74::min::lib {
+
+
+    ///	A fast pseudo-random number engine, safe to use on the audio thread.
+    ///	It uses the <a href="https://prng.di.unimi.it">xoshiro256++</a> generator, which has a period of 2^256 - 1 and passes all common statistical tests.
+    ///
+    ///	The engine runs sixteen independent streams side by side, each started 2^128 steps apart along the sequence,
+    ///	and takes the output from each stream in turn. A block fill therefore applies the same operations to sixteen independent states,
+    ///	which the compiler vectorizes, and the sequence is the same whether it is drawn one value or one block at a time.
+    ///
+    ///	The engine satisfies the requirements of UniformRandomBitGenerator so it can also be used with the distributions of the standard library.
+    ///	It holds no pointers and never allocates.
+
+    class xoshiro {
+        static constexpr int k_lanes = 16;
+
+    public:
+        using result_type = std::uint64_t;
+
+
+        /// Create an engine.
+        /// @param	seed	The seed. By default every instance is seeded differently.
+
+        explicit xoshiro(std::uint64_t seed = unique_seed()) {
+            this->seed(seed);
+        }
+
+
+        /// Restart the sequence from a seed.
+        /// Placing the streams along the sequence takes several thousand steps, so avoid reseeding in every audio vector.
+        /// @param	seed	The seed. Any value, including zero, is valid.
+
+        void seed(std::uint64_t seed) {
+            // expand the seed to the full state with splitmix64, as recommended by the authors of xoshiro
+            std::array<std::uint64_t, 4> state;
+            for (auto& s : state) {
+                seed += 0x9E3779B97F4A7C15ULL;
+                auto z = seed;
+                z      = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z      = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                s      = z ^ (z >> 31);
+            }
+
+            for (auto lane = 0; lane < k_lanes; ++lane) {
+                m_lanes.s0[lane] = state[0];
+                m_lanes.s1[lane] = state[1];
+                m_lanes.s2[lane] = state[2];
+                m_lanes.s3[lane] = state[3];
+                jump(state);
+            }
+            m_lane = 0;
+        }
+
+
+        /// Return a different seed every time it is called, from any thread.
+        /// The count is scrambled with the murmur3 finalizer, since consecutive seeds that differ by the step of seed()
+        /// would expand to states that share three of their four words.
+        /// @return	A seed.
+
+        static std::uint64_t unique_seed() {
+            static std::atomic<std::uint64_t> counter {0x2545F4914F6CDD1DULL};
+            auto z = counter.fetch_add(1, std::memory_order_relaxed);
+            z      = (z ^ (z >> 33)) * 0xFF51AFD7ED558CCDULL;
+            z      = (z ^ (z >> 33)) * 0xC4CEB9FE1A85EC53ULL;
+            return z ^ (z >> 33);
+        }
+
+
+        static constexpr result_type min() {
+            return 0;
+        }
+
+
+        static constexpr result_type max() {
+            return ~result_type(0);
+        }
+
+
+        /// Generate 64 random bits.
+        /// @return	The next value in the sequence.
+
+        result_type operator()() {
+            auto r = step(m_lanes, m_lane);
+            m_lane = (m_lane + 1) & (k_lanes - 1);
+            return r;
+        }
+
+
+        /// Generate a number with a uniform distribution.
+        /// @return	A number in the range [0, 1).
+
+        number uniform() {
+            return to_unit((*this)());
+        }
+
+
+        /// Generate a number with a uniform distribution.
+        /// @param	min		The lowest value that may be generated.
+        /// @param	max		The upper bound of the range, which is not generated.
+        /// @return			A number in the range [min, max).
+
+        number uniform(number min, number max) {
+            return min + (max - min) * uniform();
+        }
+
+
+        /// Generate a number with a uniform distribution in the range [-1, 1).
+        /// @return	The generated number.
+
+        number bipolar() {
+            return to_bipolar((*this)());
+        }
+
+
+        /// Fill a vector with numbers uniformly distributed in the range [-1, 1).
+        /// The result is the same as calling bipolar() for each sample.
+        /// @param	output			Storage for the numbers.
+        /// @param	frame_count		The number of values to generate.
+
+        void fill(sample* output, std::size_t frame_count) {
+            std::size_t i = 0;
+
+            // finish the round of lanes in progress, then take whole rounds
+            for (; i < frame_count && m_lane != 0; ++i)
+                output[i] = bipolar();
+
+            for (; i + k_lanes <= frame_count; i += k_lanes) {
+                auto o = output + i;
+                for (auto lane = 0; lane < k_lanes; ++lane)
+                    o[lane] = to_bipolar(step(m_lanes, lane));
+            }
+
+            for (; i < frame_count; ++i)
+                output[i] = bipolar();
+        }
+
+
+    private:
+        static std::uint64_t rotate(std::uint64_t x, int k) {
+            return (x << k) | (x >> (64 - k));
+        }
+
+
+        /// The four words of the state of every lane.
+
+        struct state {
+            std::array<std::uint64_t, k_lanes>	s0;		// [lane]
+            std::array<std::uint64_t, k_lanes>	s1;
+            std::array<std::uint64_t, k_lanes>	s2;
+            std::array<std::uint64_t, k_lanes>	s3;
+        };
+
+
+        /// Advance one lane of the state.
+
+        static std::uint64_t step(state& s, int lane) {
+            auto s0 = s.s0[lane];
+            auto s1 = s.s1[lane];
+            auto s2 = s.s2[lane];
+            auto s3 = s.s3[lane];
+
+            auto result = rotate(s0 + s3, 23) + s0;
+            auto t      = s1 << 17;
+
+            s2 ^= s0;
+            s3 ^= s1;
+            s1 ^= s2;
+            s0 ^= s3;
+            s2 ^= t;
+            s3 = rotate(s3, 45);
+
+            s.s0[lane] = s0;
+            s.s1[lane] = s1;
+            s.s2[lane] = s2;
+            s.s3[lane] = s3;
+            return result;
+        }
+
+
+        /// Advance a state by 2^128 steps.
+
+        static void jump(std::array<std::uint64_t, 4>& s) {
+            constexpr std::uint64_t polynomial[] = {0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL};
+
+            std::array<std::uint64_t, 4> result {};
+            for (auto word : polynomial) {
+                for (auto bit = 0; bit < 64; ++bit) {
+                    if (word & (std::uint64_t(1) << bit)) {
+                        for (auto i = 0; i < 4; ++i)
+                            result[i] ^= s[i];
+                    }
+
+                    // a step of the generator, without the output
+                    auto t = s[1] << 17;
+                    s[2] ^= s[0];
+                    s[3] ^= s[1];
+                    s[1] ^= s[2];
+                    s[0] ^= s[3];
+                    s[2] ^= t;
+                    s[3] = rotate(s[3], 45);
+                }
+            }
+            s = result;
+        }
+
+
+        /// Convert the upper 52 bits to a number in [0, 1) by placing them in the mantissa of a number in [1, 2).
+        /// Unlike a conversion from a 64-bit integer, this is available as a vector instruction everywhere.
+
+        static number to_unit(std::uint64_t r) {
+            auto   bits = (r >> 12) | 0x3FF0000000000000ULL;
+            double x;
+            std::memcpy(&x, &bits, sizeof x);
+            return x - 1.0;
+        }
+
+
+        /// Convert the upper 52 bits to a number in [-1, 1), from a number in [2, 4).
+
+        static number to_bipolar(std::uint64_t r) {
+            auto   bits = (r >> 12) | 0x4000000000000000ULL;
+            double x;
+            std::memcpy(&x, &bits, sizeof x);
+            return x - 3.0;
+        }
+
+
+        state	m_lanes;
+        int		m_lane	{};		// the lane that produces the next value
+    };
+
+
+    /// Noise generators for dither, modulation and test signals.
+    /// Each generator owns its own engine, so instances on different channels are uncorrelated.
+
+    namespace noise {
+
+
+        ///	White noise, uniformly distributed in the range [-1, 1).
+
+        class white {
+        public:
+            /// Create a white noise generator.
+            /// @param	seed	The seed of the random number engine. By default every instance is seeded differently.
+
+            explicit white(std::uint64_t seed = xoshiro::unique_seed())
+            : m_engine{seed} {}
+
+
+            /// Calculate one sample.
+            ///	@return		Calculated sample
+
+            sample operator()() {
+                return m_engine.bipolar();
+            }
+
+
+            /// Calculate a vector of samples.
+            /// @param	output			Storage for the samples.
+            /// @param	frame_count		The number of samples to calculate.
+
+            void process(sample* output, std::size_t frame_count) {
+                m_engine.fill(output, frame_count);
+            }
+
+        private:
+            xoshiro	m_engine;
+        };
+
+
+        ///	Pink noise, with equal power in every octave.
+        ///	White noise is shaped by Paul Kellet's refined filter, a parallel bank of seven one-pole filters
+        ///	that is within 0.05 dB of a -3 dB per octave slope above 9.2 Hz at 44.1 kHz.
+        ///	The rms level is about 0.22, with occasional peaks slightly above 1.
+
+        class pink {
+        public:
+            /// Create a pink noise generator.
+            /// @param	seed	The seed of the random number engine. By default every instance is seeded differently.
+
+            explicit pink(std::uint64_t seed = xoshiro::unique_seed())
+            : m_engine{seed} {}
+
+
+            /// Clear the filter history.
+
+            void clear() {
+                m_b.fill(0.0);
+            }
+
+
+            /// Calculate one sample.
+            ///	@return		Calculated sample
+
+            sample operator()() {
+                return filter(m_engine.bipolar());
+            }
+
+
+            /// Calculate a vector of samples.
+            /// @param	output			Storage for the samples.
+            /// @param	frame_count		The number of samples to calculate.
+
+            void process(sample* output, std::size_t frame_count) {
+                m_engine.fill(output, frame_count);
+                for (auto i = 0; i < frame_count; ++i)
+                    output[i] = filter(output[i]);
+            }
+
+        private:
+            sample filter(sample white) {
+                auto w = white * 0.5;    // the filter expects white noise with about a quarter of full scale rms
+
+                m_b[0]  = 0.99886 * m_b[0] + w * 0.0555179;
+                m_b[1]  = 0.99332 * m_b[1] + w * 0.0750759;
+                m_b[2]  = 0.96900 * m_b[2] + w * 0.1538520;
+                m_b[3]  = 0.86650 * m_b[3] + w * 0.3104856;
+                m_b[4]  = 0.55000 * m_b[4] + w * 0.5329522;
+                m_b[5]  = -0.7616 * m_b[5] - w * 0.0168980;
+                auto y  = m_b[0] + m_b[1] + m_b[2] + m_b[3] + m_b[4] + m_b[5] + m_b[6] + w * 0.5362;
+                m_b[6]  = w * 0.115926;
+                return y * 0.25;
+            }
+
+            xoshiro					m_engine;
+            std::array<number, 7>	m_b {};
+        };
+
+
+        ///	Brown noise, with a -6 dB per octave slope, from white noise through a leaky integrator.
+        ///	The leak makes the slope level off below about 14 Hz at 44.1 kHz, so the output does not drift.
+        ///	The rms level is about 0.3, with occasional peaks slightly above 1.
+
+        class brown {
+        public:
+            /// Create a brown noise generator.
+            /// @param	seed	The seed of the random number engine. By default every instance is seeded differently.
+
+            explicit brown(std::uint64_t seed = xoshiro::unique_seed())
+            : m_engine{seed} {}
+
+
+            /// Clear the integrator.
+
+            void clear() {
+                m_y = 0.0;
+            }
+
+
+            /// Calculate one sample.
+            ///	@return		Calculated sample
+
+            sample operator()() {
+                return filter(m_engine.bipolar());
+            }
+
+
+            /// Calculate a vector of samples.
+            /// @param	output			Storage for the samples.
+            /// @param	frame_count		The number of samples to calculate.
+
+            void process(sample* output, std::size_t frame_count) {
+                m_engine.fill(output, frame_count);
+                for (auto i = 0; i < frame_count; ++i)
+                    output[i] = filter(output[i]);
+            }
+
+        private:
+            sample filter(sample white) {
+                m_y = 0.998 * m_y + 0.032 * white;
+                return m_y;
+            }
+
+            xoshiro	m_engine;
+            number	m_y {};
+        };
+
+
+    }    // namespace noise
+}    // namespace c74::min::lib
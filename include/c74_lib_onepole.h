@@ -5,12 +5,20 @@
 
 #pragma once
 
+#include "c74_lib_denormal.h"
+#include "c74_lib_math.h"
+
+#include <array>
+#include <atomic>
+#include <limits>
+#include <thread>
 
 namespace c74::min::lib {
 
 
     ///	Single-channel, basic <a href="https://en.wikipedia.org/wiki/Low-pass_filter">low-pass filter</a>.
     ///	Handy for use in smoothing control signals or damping high frequency components.
+    ///	The coefficient is stored atomically so that it may be changed from a control thread while the audio thread is filtering.
 
     class onepole {
     public:
@@ -23,30 +31,69 @@ namespace c74::min::lib {
         }
 
 
+        /// Copy constructor.
+        /// @param	other	The filter whose coefficient and history will be copied.
+
+        onepole(const onepole& other)
+        : b_1{other.b_1.load(std::memory_order_relaxed)}
+        , y_1{other.y_1}
+        , m_flush{other.m_flush} {}
+
+
+        /// Copy assignment.
+        /// @param	other	The filter whose coefficient and history will be copied.
+
+        onepole& operator=(const onepole& other) {
+            b_1.store(other.b_1.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            y_1     = other.y_1;
+            m_flush = other.m_flush;
+            return *this;
+        }
+
+
         /// Set filter coefficient directly.
+        /// This is safe to call from any thread.
         /// @param new_coefficient	The new value of the feedback coefficient in the range [0.0, 1.0].
 
         void coefficient(number new_coefficient) {
             new_coefficient = MIN_CLAMP(new_coefficient, 0.0, 1.0);
-            b_1             = new_coefficient;
-            a_0             = 1 - new_coefficient;
+            b_1.store(new_coefficient, std::memory_order_relaxed);
         }
 
         /// Get the current coefficent of the filter.
         /// @return	The value of the feedback coefficient.
 
         number coefficient() {
-            return b_1;
+            return b_1.load(std::memory_order_relaxed);
         }
 
 
         /// Set filter coefficient using a cutoff frequency.
+        /// This is safe to call from any thread.
         /// @param cutoff_frequency		The cutoff frequency in hertz.
         /// @param sampling_frequency	The sample frequency in hertz.
         ///	@see http://musicdsp.org/showArchiveComment.php?ArchiveID=237
+        /// @tparam math_policy			How the exponential is evaluated: math::precise by default, or math::fast.
 
+        template<class math_policy = math::precise>
         void frequency(number cutoff_frequency, number sampling_frequency) {
-            coefficient(1.0 - exp(-2.0 * M_PI * cutoff_frequency / sampling_frequency));
+            coefficient(1.0 - math_policy::exp(-2.0 * M_PI * cutoff_frequency / sampling_frequency));
+        }
+
+
+        /// Flush the filter's history to zero once it decays below denormal::threshold.
+        /// Use this when the host does not enable flush-to-zero and a denormal::guard cannot be used.
+        /// @param	new_flush	True to flush the history. Default is false.
+
+        void flush_denormals(bool new_flush) {
+            m_flush = new_flush;
+        }
+
+        /// Determine if the filter's history is flushed to zero once it decays below denormal::threshold.
+        /// @return	True if the history is flushed.
+
+        bool flush_denormals() {
+            return m_flush;
         }
 
 
@@ -69,15 +116,292 @@ namespace c74::min::lib {
         ///	@return		Calculated sample
 
         sample operator()(sample x) {
-            auto y = (x * a_0) + (y_1 * b_1);
-            y_1    = y;
+            auto b = b_1.load(std::memory_order_relaxed);
+            auto y = (x * (1 - b)) + (y_1 * b);
+            if (m_flush)
+                y = denormal::flush(y);
+            y_1 = y;
             return y;
         }
 
+
+        /// Calculate a vector of samples.
+        /// @param	input			The samples to filter.
+        /// @param	output			Storage for the filtered samples. May be the same as input.
+        /// @param	frame_count		The number of samples to process.
+
+        void process(const sample* input, sample* output, std::size_t frame_count) {
+            auto b = b_1.load(std::memory_order_relaxed);
+            y_1    = filter(input, output, frame_count, 1.0 - b, b, y_1);
+            if (m_flush)
+                y_1 = denormal::flush(y_1);
+        }
+
+
+        /// Calculate a long vector of samples offline, splitting the work across several threads.
+        ///
+        /// The recurrence y[n] = a * x[n] + b * y[n-1] is linear, so a chunk filtered from a history of zero differs from
+        /// the true output only by the carried history decaying through it: y[n] = z[n] + b^(n+1) * y[-1].
+        /// Each thread first filters its own chunk from zero. The history carried out of every chunk is then found
+        /// in a short serial pass, and finally each thread adds the decayed carry to its chunk.
+        /// The result matches process() to within floating-point rounding and the filter's history is updated in the same way.
+        ///
+        /// This allocates and starts threads, so it is not suitable for use on the audio thread.
+        /// @param	input			The samples to filter.
+        /// @param	output			Storage for the filtered samples. May be the same as input.
+        /// @param	frame_count		The number of samples to process.
+        /// @param	thread_count	The number of threads to use. Defaults to the number of hardware threads.
+
+        void render(const sample* input, sample* output, std::size_t frame_count, unsigned int thread_count = std::thread::hardware_concurrency()) {
+            const std::size_t minimum_chunk = 65536;    // below this the threads cost more than they save
+
+            thread_count = static_cast<unsigned int>(std::min<std::size_t>(std::max(thread_count, 1u), frame_count / minimum_chunk));
+            if (thread_count <= 1) {
+                process(input, output, frame_count);
+                return;
+            }
+
+            const auto b          = b_1.load(std::memory_order_relaxed);
+            const auto a          = 1.0 - b;
+            const auto chunk_size = (frame_count + thread_count - 1) / thread_count;
+
+            auto begin = [&](unsigned int chunk) { return std::min(chunk * chunk_size, frame_count); };
+            auto end   = [&](unsigned int chunk) { return std::min((chunk + 1) * chunk_size, frame_count); };
+
+            // Filter every chunk from a history of zero, except the first which starts from the true history
+
+            sample_vector       carry(thread_count);
+            vector<std::thread> threads;
+
+            // join the threads already started if starting another throws, since destroying a joinable thread terminates
+            struct joiner {
+                ~joiner() {
+                    for (auto& thread : threads) {
+                        if (thread.joinable())
+                            thread.join();
+                    }
+                }
+                vector<std::thread>& threads;
+            } join_on_exit {threads};
+
+            for (auto chunk = 0u; chunk < thread_count; ++chunk) {
+                threads.emplace_back([&, chunk]() {
+                    auto first   = begin(chunk);
+                    carry[chunk] = filter(input + first, output + first, end(chunk) - first, a, b, chunk == 0 ? y_1 : 0.0);
+                });
+            }
+            for (auto& thread : threads)
+                thread.join();
+            threads.clear();
+
+            // Carry the history through the chunks, which needs one step per chunk
+
+            for (auto chunk = 1u; chunk < thread_count; ++chunk)
+                carry[chunk] += std::pow(b, static_cast<number>(end(chunk) - begin(chunk))) * carry[chunk - 1];
+
+            // Add the decayed history carried into each chunk
+
+            for (auto chunk = 1u; chunk < thread_count; ++chunk) {
+                threads.emplace_back([&, chunk]() {
+                    auto first = begin(chunk);
+                    decay(output + first, end(chunk) - first, b, carry[chunk - 1]);
+                });
+            }
+            for (auto& thread : threads)
+                thread.join();
+
+            y_1 = output[frame_count - 1];
+            if (m_flush)
+                y_1 = denormal::flush(y_1);
+        }
+
+    private:
+        /// Filter a vector from the given history and return the new history.
+
+        static sample filter(const sample* input, sample* output, std::size_t frame_count, number a, number b, sample y) {
+            for (std::size_t i = 0; i < frame_count; ++i) {
+                y         = input[i] * a + y * b;
+                output[i] = y;
+            }
+            return y;
+        }
+
+
+        /// Add a history decaying through a vector, i.e. output[n] += b^(n+1) * y.
+        /// The powers are advanced in several independent lanes so that the loop vectorizes,
+        /// and the loop ends early once the history has decayed below the smallest normal number.
+
+        static void decay(sample* output, std::size_t frame_count, number b, sample y) {
+            constexpr auto             lanes = 8;
+            std::array<sample, lanes>  powers;
+            const auto                 stride = std::pow(b, static_cast<number>(lanes));
+            std::size_t                i      = 0;
+
+            powers[0] = y * b;
+            for (auto k = 1; k < lanes; ++k)
+                powers[k] = powers[k - 1] * b;
+
+            for (; i + lanes <= frame_count; i += lanes) {
+                if (std::abs(powers[0]) < std::numeric_limits<sample>::min())
+                    return;
+                for (auto k = 0; k < lanes; ++k) {
+                    output[i + k] += powers[k];
+                    powers[k] *= stride;
+                }
+            }
+            for (auto k = 0; i < frame_count; ++i, ++k)
+                output[i] += powers[k];
+        }
+
+        std::atomic<number> b_1{0.5};    ///< feedback coefficient, the gain coefficient is derived as 1 - b_1
+        sample              y_1{};       ///< previous output sample
+        bool                m_flush{};   ///< flush the history to zero when it becomes very small
+    };
+
+
+    ///	A bank of N independent low-pass filters, e.g. for smoothing many control signals at once.
+    ///	The coefficients and histories are stored as arrays and every channel is updated by the same loop,
+    ///	so the compiler can update several channels with each vector instruction.
+    ///	Unlike the onepole, the coefficients are not atomic: set them from the audio thread or before processing begins.
+    ///	@tparam	channel_count	The number of filters in the bank.
+
+    template<int channel_count>
+    class onepole_bank {
+    public:
+        using frame = std::array<sample, channel_count>;    ///< one sample for each channel
+
+
+        /// Default constructor.
+        /// @param	initial_coefficient		Sets the gain coefficient that is applied to samples from history for all channels.
+        ///									Default value is 0.5.
+
+        explicit onepole_bank(number initial_coefficient = 0.5) {
+            this->coefficient(initial_coefficient);
+        }
+
+
+        /// Set the coefficient of all channels.
+        /// @param new_coefficient	The new value of the feedback coefficient in the range [0.0, 1.0].
+
+        void coefficient(number new_coefficient) {
+            for (auto channel = 0; channel < channel_count; ++channel)
+                coefficient(channel, new_coefficient);
+        }
+
+        /// Set the coefficient of one channel.
+        /// @param channel			The channel.
+        /// @param new_coefficient	The new value of the feedback coefficient in the range [0.0, 1.0].
+
+        void coefficient(int channel, number new_coefficient) {
+            new_coefficient = MIN_CLAMP(new_coefficient, 0.0, 1.0);
+            b_1[channel]    = new_coefficient;
+            a_0[channel]    = 1.0 - new_coefficient;
+        }
+
+        /// Get the current coefficent of one channel.
+        /// @param channel	The channel.
+        /// @return			The value of the feedback coefficient.
+
+        number coefficient(int channel) {
+            return b_1[channel];
+        }
+
+
+        /// Set the coefficient of one channel using a cutoff frequency.
+        /// @param channel				The channel.
+        /// @param cutoff_frequency		The cutoff frequency in hertz.
+        /// @param sampling_frequency	The sample frequency in hertz.
+        /// @tparam math_policy			How the exponential is evaluated: math::precise by default, or math::fast.
+
+        template<class math_policy = math::precise>
+        void frequency(int channel, number cutoff_frequency, number sampling_frequency) {
+            coefficient(channel, 1.0 - math_policy::exp(-2.0 * M_PI * cutoff_frequency / sampling_frequency));
+        }
+
+
+        /// Flush the histories to zero once they decay below denormal::threshold.
+        /// @param	new_flush	True to flush the histories. Default is false.
+
+        void flush_denormals(bool new_flush) {
+            m_flush = new_flush;
+        }
+
+        /// Determine if the histories are flushed to zero once they decay below denormal::threshold.
+        /// @return	True if the histories are flushed.
+
+        bool flush_denormals() {
+            return m_flush;
+        }
+
+
+        /// Clear the history of all channels.
+
+        void clear() {
+            y_1.fill(0.0);
+        }
+
+
+        /// Retrieve the history of one channel.
+        /// @param channel	The channel.
+        /// @return			The value stored in the channel's history.
+
+        sample history(int channel) {
+            return y_1[channel];
+        }
+
+
+        /// Calculate one sample for every channel.
+        /// @param	x	The input sample for each channel.
+        ///	@return		The calculated sample for each channel.
+
+        frame operator()(const frame& x) {
+            tick(x.data());
+            return y_1;
+        }
+
+
+        /// Calculate a vector of interleaved frames, i.e. channel_count samples per frame.
+        /// @param	input			The frames to filter.
+        /// @param	output			Storage for the filtered frames. May be the same as input.
+        /// @param	frame_count		The number of frames to process.
+
+        void process(const sample* input, sample* output, std::size_t frame_count) {
+            for (std::size_t i = 0; i < frame_count; ++i) {
+                tick(input + i * channel_count);
+                std::copy_n(y_1.data(), channel_count, output + i * channel_count);
+            }
+        }
+
+
+        /// Calculate n-samples for channel_count channels.
+        /// The number of channels at the input and output must match the channel count of the bank.
+
+        void operator()(audio_bundle input, audio_bundle output) {
+            frame x;
+
+            for (auto i = 0; i < input.frame_count(); ++i) {
+                for (auto channel = 0; channel < channel_count; ++channel)
+                    x[channel] = input.samples(channel)[i];
+                tick(x.data());
+                for (auto channel = 0; channel < channel_count; ++channel)
+                    output.samples(channel)[i] = y_1[channel];
+            }
+        }
+
     private:
-        number a_0{0.5};    ///< gain coefficient
-        number b_1{0.5};    ///< feedback coefficient
-        sample y_1{};       ///< previous output sample
+        void tick(const sample* x) {
+            for (auto channel = 0; channel < channel_count; ++channel)
+                y_1[channel] = x[channel] * a_0[channel] + y_1[channel] * b_1[channel];
+            if (m_flush) {
+                for (auto& y : y_1)
+                    y = denormal::flush(y);
+            }
+        }
+
+        std::array<number, channel_count>	a_0{};		///< gain coefficients
+        std::array<number, channel_count>	b_1{};		///< feedback coefficients
+        frame								y_1{};		///< previous output samples
+        bool								m_flush{};	///< flush the histories to zero when they become very small
     };
 
 }    // namespace c74::min::lib
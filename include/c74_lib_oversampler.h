@@ -0,0 +1,265 @@
+/// @file
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include "c74_min_api.h"
+
+
+namespace c74::min::lib {
+
+
+    ///	A single-channel half-band FIR filter for changing the sampling rate by a factor of two.
+    ///
+    ///	Every other coefficient of a half-band filter is zero, except the center which is 0.5.
+    ///	Split into its two polyphase components, one is a short FIR filter and the other is a plain delay,
+    ///	so interpolating or decimating by two costs one dot product per base-rate sample.
+    ///	The dot products run over contiguous memory, which the compiler vectorizes.
+    ///
+    ///	The coefficients are a Kaiser-windowed sinc with roughly 90 dB of stopband attenuation.
+
+    class halfband {
+    public:
+        /// Create a half-band filter.
+        /// @param	a_half_length	The number of non-zero coefficients in the FIR polyphase component.
+        ///							The filter has 4 * a_half_length - 1 taps and a steeper transition band as this increases.
+        /// @param	a_vector_size	The largest number of base-rate samples that will be processed at once.
+
+        explicit halfband(int a_half_length = 16, int a_vector_size = 512) {
+            m_taps        = 2 * a_half_length;
+            m_vector_size = a_vector_size;
+
+            // design the full filter, centered on index m_taps - 1
+
+            const auto length = 2 * m_taps - 1;
+            const auto center = m_taps - 1;
+            const auto beta   = 9.0;    // Kaiser window for about 90 dB attenuation
+            sample_vector h(length);
+
+            for (auto n = 0; n < length; ++n) {
+                auto t      = n - center;
+                auto sinc   = t == 0 ? 1.0 : sin(M_PI * t / 2.0) / (M_PI * t / 2.0);
+                auto r      = 2.0 * n / (length - 1) - 1.0;
+                auto window = bessel_i0(beta * sqrt(1.0 - r * r)) / bessel_i0(beta);
+                h[n]        = 0.5 * sinc * window;
+            }
+
+            // keep the even-indexed coefficients, normalized so that the gain at dc is exactly one, in reverse order for the dot product
+
+            number sum {};
+            for (auto k = 0; k < m_taps; ++k)
+                sum += h[2 * k];
+            m_coefficients.resize(m_taps);
+            for (auto k = 0; k < m_taps; ++k)
+                m_coefficients[m_taps - 1 - k] = h[2 * k] * 0.5 / sum;
+
+            m_up.resize(m_taps - 1 + m_vector_size);
+            m_down_even.resize(m_taps - 1 + m_vector_size);
+            m_down_odd.resize(m_taps / 2 + m_vector_size);
+        }
+
+
+        /// Return the delay caused by interpolating and then decimating with this filter.
+        /// @return	The latency in samples at the higher rate.
+
+        number latency() const {
+            return 2.0 * (m_taps - 1);
+        }
+
+
+        /// Clear the filter's history
+
+        void clear() {
+            std::fill(m_up.begin(), m_up.end(), 0.0);
+            std::fill(m_down_even.begin(), m_down_even.end(), 0.0);
+            std::fill(m_down_odd.begin(), m_down_odd.end(), 0.0);
+        }
+
+
+        /// Interpolate by a factor of two.
+        /// @param	input			The samples at the lower rate.
+        /// @param	output			Storage for 2 * frame_count samples at the higher rate.
+        /// @param	frame_count		The number of samples at the lower rate. May not exceed the vector size.
+
+        void upsample(const sample* input, sample* output, std::size_t frame_count) {
+            assert(frame_count <= m_vector_size);
+
+            const auto history = m_taps - 1;
+            const auto delay   = m_taps / 2;    // the center tap, as an offset into the buffer
+            auto       buffer  = m_up.data();
+            auto       c       = m_coefficients.data();
+
+            std::copy_n(input, frame_count, buffer + history);
+
+            for (auto i = 0; i < frame_count; ++i) {
+                auto x = buffer + i;
+                sample y {};
+                for (auto k = 0; k < m_taps; ++k)
+                    y += c[k] * x[k];
+
+                output[2 * i]     = 2.0 * y;
+                output[2 * i + 1] = x[delay];
+            }
+
+            std::copy_n(buffer + frame_count, history, buffer);
+        }
+
+
+        /// Decimate by a factor of two.
+        /// @param	input			2 * frame_count samples at the higher rate.
+        /// @param	output			Storage for the samples at the lower rate. May be the same as input.
+        /// @param	frame_count		The number of samples at the lower rate. May not exceed the vector size.
+
+        void downsample(const sample* input, sample* output, std::size_t frame_count) {
+            assert(frame_count <= m_vector_size);
+
+            const auto even_history = m_taps - 1;
+            const auto odd_history  = m_taps / 2;
+            auto       even         = m_down_even.data();
+            auto       odd          = m_down_odd.data();
+            auto       c            = m_coefficients.data();
+
+            for (auto i = 0; i < frame_count; ++i) {
+                even[even_history + i] = input[2 * i];
+                odd[odd_history + i]   = input[2 * i + 1];
+            }
+
+            for (auto i = 0; i < frame_count; ++i) {
+                auto x = even + i;
+                sample y {};
+                for (auto k = 0; k < m_taps; ++k)
+                    y += c[k] * x[k];
+
+                output[i] = y + 0.5 * odd[i];
+            }
+
+            std::copy_n(even + frame_count, even_history, even);
+            std::copy_n(odd + frame_count, odd_history, odd);
+        }
+
+
+    private:
+        /// Modified Bessel function of the first kind, order zero, for the Kaiser window.
+
+        static number bessel_i0(number x) {
+            number sum  = 1.0;
+            number term = 1.0;
+            for (auto k = 1; k < 50; ++k) {
+                term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                sum += term;
+            }
+            return sum;
+        }
+
+        int				m_taps			{};		// coefficients in the FIR polyphase component
+        int				m_vector_size	{};
+        sample_vector	m_coefficients;			// reversed
+        sample_vector	m_up;					// history followed by new input
+        sample_vector	m_down_even;
+        sample_vector	m_down_odd;
+    };
+
+
+    ///	Run a single-sample processor at a multiple of the sampling rate, to reduce aliasing from nonlinear processing.
+    ///	The signal is interpolated by cascaded half-band filters, processed, and decimated by the same filters in reverse.
+    ///	The first stage has the steepest filter since it sets the usable bandwidth; later stages only need to
+    ///	reject images far from the audio band so they are much shorter.
+    ///
+    ///	@code
+    ///	lib::saturation					shaper;
+    ///	lib::oversampler<4>				oversampler;
+    ///
+    ///	oversampler.process(input, output, frame_count, shaper);
+    ///	@endcode
+    ///
+    ///	@tparam	factor	The oversampling factor: 2, 4 or 8.
+
+    template<int factor>
+    class oversampler {
+        static_assert(factor == 2 || factor == 4 || factor == 8, "oversampling factor must be 2, 4 or 8");
+
+        static constexpr int k_stage_count = factor == 2 ? 1 : (factor == 4 ? 2 : 3);
+
+    public:
+        /// Create an oversampler instance.
+        /// @param	a_vector_size	The number of base-rate samples processed internally at once.
+        ///							Larger vectors are processed in several passes.
+
+        explicit oversampler(int a_vector_size = 512) {
+            m_vector_size = a_vector_size;
+
+            for (auto s = 0; s < k_stage_count; ++s)
+                m_stages.emplace_back(s == 0 ? 16 : 6, m_vector_size << s);
+
+            m_buffers[0].resize(m_vector_size * factor);
+            m_buffers[1].resize(m_vector_size * factor);
+        }
+
+
+        /// Return the delay caused by the oversampling filters.
+        /// This may be a fractional number of samples when the factor is larger than 2.
+        /// @return	The latency in samples at the base rate.
+
+        number latency() const {
+            number total {};
+            for (auto s = 0; s < k_stage_count; ++s)
+                total += m_stages[s].latency() / (2 << s);
+            return total;
+        }
+
+
+        /// Clear the history of the oversampling filters.
+
+        void clear() {
+            for (auto& stage : m_stages)
+                stage.clear();
+        }
+
+
+        /// Process a vector of samples at the higher rate.
+        /// @param	input			The samples to process.
+        /// @param	output			Storage for the processed samples. May be the same as input.
+        /// @param	frame_count		The number of samples to process.
+        /// @param	processor		A function or object called as processor(sample) for every sample at the higher rate,
+        ///							e.g. an instance of lib::saturation.
+
+        template<class processor_type>
+        void process(const sample* input, sample* output, std::size_t frame_count, processor_type&& processor) {
+            for (std::size_t offset = 0; offset < frame_count; offset += m_vector_size) {
+                auto n = std::min<std::size_t>(m_vector_size, frame_count - offset);
+                auto a = m_buffers[0].data();
+                auto b = m_buffers[1].data();
+
+                // Interpolate
+
+                m_stages[0].upsample(input + offset, a, n);
+                for (auto s = 1; s < k_stage_count; ++s) {
+                    m_stages[s].upsample(a, b, n << s);
+                    std::swap(a, b);
+                }
+
+                // Process
+
+                const auto count = n * factor;
+                for (auto i = 0; i < count; ++i)
+                    a[i] = processor(a[i]);
+
+                // Decimate
+
+                for (auto s = k_stage_count - 1; s > 0; --s)
+                    m_stages[s].downsample(a, a, n << s);
+                m_stages[0].downsample(a, output + offset, n);
+            }
+        }
+
+
+    private:
+        int					m_vector_size	{};
+        vector<halfband>	m_stages;			// [0] is nearest the base rate
+        sample_vector		m_buffers[2];
+    };
+
+
+}    // namespace c74::min::lib
@@ -0,0 +1,184 @@
+/// @file
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
+
+namespace c74::min::lib {
+
+
+    ///	Lock-free hand-off of a block of parameter values from a control thread to the audio thread.
+    ///
+    ///	This is a triple buffer: the control thread always writes into a private back buffer and publishes it with one atomic exchange.
+    ///	The audio thread picks up the most recently published values, typically once at the top of each vector,
+    ///	so that a set of related coefficients is always seen as a consistent whole.
+    ///	Neither side ever blocks, and the audio thread never allocates. Intermediate values written faster than they are read are dropped.
+    ///	There may only be one writing thread and one reading thread.
+    /// @tparam	T	The type of the values being passed. Must be trivially copyable to be fetched with read().
+    ///				Other types, such as a vector of per-channel values, may be used in place with update() and current(),
+    ///				in which case only the control thread ever copies them.
+
+    template<class T>
+    class snapshot {
+    public:
+        /// Constructor.
+        /// @param	initial_value	The value that will be seen by the audio thread until the first write().
+
+        explicit snapshot(const T& initial_value = T{})
+        : m_buffers{initial_value, initial_value, initial_value} {}
+
+
+        /// Publish a new value. Call only from the control thread.
+        /// @param	new_value	The value to publish.
+
+        void write(const T& new_value) {
+            m_buffers[m_back] = new_value;
+            auto previous     = m_middle.exchange(m_back | k_dirty, std::memory_order_acq_rel);
+            m_back            = previous & k_index_mask;
+        }
+
+
+        /// Fetch the most recently published value, if it has changed. Call only from the audio thread.
+        /// @param	value	Receives the new value if one has been published since the last call.
+        /// @return			true if a new value was published, otherwise false and value is untouched.
+
+        bool read(T& value) {
+            static_assert(std::is_trivially_copyable<T>::value, "snapshot values must be trivially copyable to be read by copy");
+
+            if (!update())
+                return false;
+            value = m_buffers[m_front];
+            return true;
+        }
+
+
+        /// Make the most recently published value current, if it has changed, without copying it. Call only from the audio thread.
+        /// @return	true if a new value was published since the last call, otherwise false and the current value is unchanged.
+
+        bool update() {
+            if ((m_middle.load(std::memory_order_relaxed) & k_dirty) == 0)
+                return false;
+
+            auto previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+            m_front       = previous & k_index_mask;
+            return true;
+        }
+
+
+        /// Return the current value. Call only from the audio thread.
+        /// @return	The value made current by the last call to update() or read(), which remains valid until the next such call.
+
+        const T& current() const {
+            return m_buffers[m_front];
+        }
+
+    private:
+        static constexpr int k_index_mask = 0x3;
+        static constexpr int k_dirty      = 0x4;
+
+        T                m_buffers[3];    ///< back, middle, and front copies of the value
+        int              m_back{0};       ///< index of the buffer owned by the writing thread
+        std::atomic<int> m_middle{1};     ///< index of the buffer in transit, plus the dirty bit
+        int              m_front{2};      ///< index of the buffer owned by the reading thread
+    };
+
+
+    ///	Lock-free, fixed-capacity queue of timestamped parameter changes.
+    ///
+    ///	Where snapshot delivers the latest state at block boundaries, this queue delivers every change along with an offset
+    ///	in samples so that the audio thread may split its vector and apply each change at the exact sample requested.
+    ///	There may only be one posting thread and one consuming thread.
+    /// @tparam	T			The type of the values being passed. Must be trivially copyable.
+    /// @tparam	capacity	The maximum number of pending events. Must be a power of two.
+
+    template<class T, std::size_t capacity = 64>
+    class parameter_queue {
+        static_assert(std::is_trivially_copyable<T>::value, "parameter_queue values must be trivially copyable");
+        static_assert(capacity > 1 && (capacity & (capacity - 1)) == 0, "parameter_queue capacity must be a power of two");
+
+    public:
+        /// A single parameter change.
+
+        struct event {
+            std::size_t offset;    ///< position in samples within the next vector at which to apply the change
+            T           value;     ///< the new parameter value
+        };
+
+
+        /// Post a change. Call only from the control thread.
+        /// @param	new_value	The new parameter value.
+        /// @param	offset		The sample within the next processed vector at which the change should take effect.
+        ///						Changes that are not consumed by the end of a vector will be applied at the start of the next one.
+        /// @return				false if the queue is full and the change was discarded.
+
+        bool post(const T& new_value, std::size_t offset = 0) {
+            auto write = m_write.load(std::memory_order_relaxed);
+            auto read  = m_read.load(std::memory_order_acquire);
+
+            if (write - read >= capacity)
+                return false;
+
+            m_events[write & k_mask] = {offset, new_value};
+            m_write.store(write + 1, std::memory_order_release);
+            return true;
+        }
+
+
+        /// Remove the oldest pending change if it is due. Call only from the audio thread.
+        /// @param	position	The current sample position within the vector being processed.
+        /// @param	e			Receives the change.
+        /// @return				true if a change with an offset at or before position was removed.
+
+        bool pop(std::size_t position, event& e) {
+            auto read  = m_read.load(std::memory_order_relaxed);
+            auto write = m_write.load(std::memory_order_acquire);
+
+            if (read == write)
+                return false;
+
+            auto& front = m_events[read & k_mask];
+            if (front.offset > position)
+                return false;
+
+            e = front;
+            m_read.store(read + 1, std::memory_order_release);
+            return true;
+        }
+
+
+        /// Return the offset of the oldest pending change. Call only from the audio thread.
+        /// @param	frame_count		The value to return if there are no pending changes, typically the size of the vector.
+        /// @return					The offset of the next change, clipped to frame_count.
+
+        std::size_t next_offset(std::size_t frame_count) {
+            auto read  = m_read.load(std::memory_order_relaxed);
+            auto write = m_write.load(std::memory_order_acquire);
+
+            if (read == write)
+                return frame_count;
+            return std::min(m_events[read & k_mask].offset, frame_count);
+        }
+
+
+        /// Test if there are no pending changes.
+        /// @return	true if the queue is empty.
+
+        bool empty() const {
+            return m_read.load(std::memory_order_acquire) == m_write.load(std::memory_order_acquire);
+        }
+
+    private:
+        static constexpr std::size_t k_mask = capacity - 1;
+
+        event                    m_events[capacity]{};    ///< ring of pending changes
+        std::atomic<std::size_t> m_write{0};              ///< total number of events posted
+        std::atomic<std::size_t> m_read{0};               ///< total number of events consumed
+    };
+
+
+}    // namespace c74::min::lib
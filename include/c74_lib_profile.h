@@ -0,0 +1,550 @@
+/// @file
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include "c74_min_api.h"
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#if !defined(MIN_LIB_PROFILE)
+#define MIN_LIB_PROFILE 0
+#endif
+
+#if MIN_LIB_PROFILE
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MIN_LIB_PROFILE_TSC 1
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define MIN_LIB_PROFILE_TSC 1
+#elif defined(__aarch64__) && !defined(_MSC_VER)
+#define MIN_LIB_PROFILE_CNTVCT 1
+#endif
+#endif
+
+
+namespace c74::min::lib {
+
+    /// Measurement of the time spent in processors, to find out which processor in a graph causes an xrun.
+    ///
+    /// Wrap a processor in profiled<> and give it a name. Its operator() and process() then read the CPU timestamp counter
+    /// before and after every call. Per processor, the wrapper keeps the call count, the total and worst cycles and a histogram of
+    /// the cycles per call. Each call is also written to a lock-free buffer of the calling thread, from which a Chrome trace is made.
+    ///
+    /// Profiling is compiled in only when MIN_LIB_PROFILE is defined to 1 before including Min-Lib.
+    /// Otherwise profiled<> adds nothing to the processor, and the exporters write empty documents.
+    ///
+    ///	@code
+    ///	profiled<lib::limiter> m_limiter;	// m_limiter.name("limiter") in the constructor
+    ///	...
+    ///	profile::write_chrome_trace(file);	// on a control thread, e.g. after an xrun
+    ///	@endcode
+
+    namespace profile {
+
+#if MIN_LIB_PROFILE
+
+        /// Read the timestamp counter: the TSC on x86, the virtual counter on ARM64, or else a steady clock in nanoseconds.
+        /// @return	The current count, in cycles of the counter.
+
+        inline std::uint64_t timestamp() noexcept {
+#if defined(MIN_LIB_PROFILE_TSC)
+            return __rdtsc();
+#elif defined(MIN_LIB_PROFILE_CNTVCT)
+            std::uint64_t value;
+            asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+            return value;
+#else
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+        }
+
+
+        /// Measure the rate of the timestamp counter against the steady clock, once. This takes about 20 milliseconds.
+        /// @return	The counts per microsecond.
+
+        inline double counts_per_microsecond() {
+            static const double rate = [] {
+                auto t0 = std::chrono::steady_clock::now();
+                auto c0 = timestamp();
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                auto c1 = timestamp();
+                auto t1 = std::chrono::steady_clock::now();
+                return (c1 - c0) / std::chrono::duration<double, std::micro>(t1 - t0).count();
+            }();
+            return rate;
+        }
+
+
+        /// Counters of the calls to one processor.
+        /// They are only written by the thread that calls the processor, so updates are plain relaxed loads and stores,
+        /// and any thread may read them at any time.
+
+        class statistics {
+        public:
+            static constexpr int k_bin_count = 40;    ///< bin i counts the calls of [2^i, 2^(i+1)) cycles
+
+
+            /// Add a call.
+            /// @param	cycles	The duration of the call in cycles.
+            /// @param	frames	The number of samples processed by the call.
+
+            void add(std::uint64_t cycles, std::uint64_t frames) noexcept {
+                bump(m_calls, 1);
+                bump(m_frames, frames);
+                bump(m_cycles, cycles);
+                if (cycles > m_worst.load(std::memory_order_relaxed))
+                    m_worst.store(cycles, std::memory_order_relaxed);
+
+#if defined(__GNUC__)
+                int bin = cycles ? 63 - __builtin_clzll(cycles) : 0;
+#else
+                int bin = 0;
+                while ((cycles >> (bin + 1)) != 0)
+                    ++bin;
+#endif
+                bump(m_histogram[bin < k_bin_count ? bin : k_bin_count - 1], 1);
+            }
+
+
+            /// Return the number of calls.
+            /// @return	The call count.
+
+            std::uint64_t calls() const noexcept {
+                return m_calls.load(std::memory_order_relaxed);
+            }
+
+
+            /// Return the number of samples processed over all calls.
+            /// @return	The sample count.
+
+            std::uint64_t frames() const noexcept {
+                return m_frames.load(std::memory_order_relaxed);
+            }
+
+
+            /// Return the total duration of all calls.
+            /// @return	The duration in cycles.
+
+            std::uint64_t cycles() const noexcept {
+                return m_cycles.load(std::memory_order_relaxed);
+            }
+
+
+            /// Return the duration of the longest call.
+            /// @return	The duration in cycles.
+
+            std::uint64_t worst() const noexcept {
+                return m_worst.load(std::memory_order_relaxed);
+            }
+
+
+            /// Return the average duration of a call.
+            /// @return	The duration in cycles, or zero if there were no calls.
+
+            double cycles_per_call() const noexcept {
+                auto n = calls();
+                return n ? static_cast<double>(cycles()) / n : 0.0;
+            }
+
+
+            /// Return the average duration per sample processed.
+            /// @return	The duration in cycles, or zero if no samples were processed.
+
+            double cycles_per_frame() const noexcept {
+                auto n = frames();
+                return n ? static_cast<double>(cycles()) / n : 0.0;
+            }
+
+
+            /// Return the number of calls that took from 2^bin up to 2^(bin + 1) cycles.
+            /// @param	bin		The bin, in the range [0, k_bin_count). The last bin also counts all longer calls.
+            /// @return			The call count.
+
+            std::uint64_t histogram(int bin) const noexcept {
+                return m_histogram[bin].load(std::memory_order_relaxed);
+            }
+
+        private:
+            static void bump(std::atomic<std::uint64_t>& counter, std::uint64_t amount) noexcept {
+                counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+            }
+
+            std::atomic<std::uint64_t>	m_calls		{};
+            std::atomic<std::uint64_t>	m_frames	{};
+            std::atomic<std::uint64_t>	m_cycles	{};
+            std::atomic<std::uint64_t>	m_worst		{};
+            std::atomic<std::uint64_t>	m_histogram[k_bin_count] {};
+        };
+
+
+        /// One call to a processor, as written to the buffer of the calling thread.
+
+        struct event {
+            const char*		name;		///< the name of the processor, which must outlive the profile
+            std::uint64_t	start;		///< the timestamp at the start of the call
+            std::uint64_t	cycles;		///< the duration of the call
+        };
+
+
+        /// A single-producer, single-consumer ring of events. Each thread that calls a profiled processor writes to its own buffer,
+        /// and the exporters read from all of them. Events are dropped when the buffer is full.
+
+        class buffer {
+        public:
+            static constexpr std::size_t k_capacity = 1 << 14;    ///< the number of events held, a power of two
+
+
+            /// Write an event. Call only from the thread that owns the buffer.
+            /// @param	e	The event.
+
+            void write(const event& e) noexcept {
+                auto head = m_head.load(std::memory_order_relaxed);
+                if (head - m_tail.load(std::memory_order_acquire) == k_capacity) {
+                    m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                    return;
+                }
+                m_events[head & (k_capacity - 1)] = e;
+                m_head.store(head + 1, std::memory_order_release);
+            }
+
+
+            /// Take all the events written so far. Call from one reading thread at a time.
+            /// @param	function	Called as function(event) for each event, oldest first.
+
+            template<class function_type>
+            void drain(function_type&& function) {
+                auto tail = m_tail.load(std::memory_order_relaxed);
+                auto head = m_head.load(std::memory_order_acquire);
+                for (; tail != head; ++tail)
+                    function(m_events[tail & (k_capacity - 1)]);
+                m_tail.store(tail, std::memory_order_release);
+            }
+
+
+            /// Return the number of events dropped because the buffer was full.
+            /// @return	The event count.
+
+            std::uint64_t dropped() const noexcept {
+                return m_dropped.load(std::memory_order_relaxed);
+            }
+
+
+            /// Return the index of the thread that owns the buffer, in the order in which threads first recorded an event.
+            /// @return	The thread index.
+
+            int thread() const noexcept {
+                return m_thread;
+            }
+
+
+            explicit buffer(int thread_index)
+            : m_events(k_capacity)
+            , m_thread { thread_index } {}
+
+        private:
+            std::vector<event>			m_events;
+            std::atomic<std::size_t>	m_head		{};
+            std::atomic<std::size_t>	m_tail		{};
+            std::atomic<std::uint64_t>	m_dropped	{};
+            int							m_thread;
+        };
+
+
+        /// The name and statistics of one profiled processor, which are listed in the registry for as long as the probe exists.
+
+        class probe {
+        public:
+            probe();
+            probe(const probe& other);
+            ~probe();
+
+            probe& operator=(const probe&) {
+                return *this;    // a processor that is assigned to keeps its own name and counters
+            }
+
+            const char*						name { "unnamed" };
+            lib::profile::statistics		statistics;
+        };
+
+
+        /// The processors and thread buffers known to the exporters.
+        /// The lock is only taken when a processor is created or destroyed, when a thread records its first event, and by the exporters.
+
+        class registry {
+        public:
+            static registry& instance() {
+                static registry r;
+                return r;
+            }
+
+
+            /// Return the buffer of the calling thread, creating it on first use.
+            /// Call it once from each audio thread before processing, since the first call allocates.
+            /// @return	The buffer.
+
+            static buffer& local() {
+                thread_local buffer* b = instance().add_buffer();
+                return *b;
+            }
+
+
+            void add(const probe* p) {
+                std::lock_guard<std::mutex> lock {m_mutex};
+                m_probes.push_back(p);
+            }
+
+
+            void remove(const probe* p) {
+                std::lock_guard<std::mutex> lock {m_mutex};
+                for (auto i = m_probes.begin(); i != m_probes.end(); ++i) {
+                    if (*i == p) {
+                        m_probes.erase(i);
+                        break;
+                    }
+                }
+            }
+
+
+            /// Call a function for each live processor, as function(name, statistics).
+
+            template<class function_type>
+            void for_each_processor(function_type&& function) {
+                std::lock_guard<std::mutex> lock {m_mutex};
+                for (auto p : m_probes)
+                    function(p->name, p->statistics);
+            }
+
+
+            /// Call a function for each thread buffer, as function(buffer).
+
+            template<class function_type>
+            void for_each_buffer(function_type&& function) {
+                std::lock_guard<std::mutex> lock {m_mutex};
+                for (auto& b : m_buffers)
+                    function(*b);
+            }
+
+        private:
+            buffer* add_buffer() {
+                std::lock_guard<std::mutex> lock {m_mutex};
+                m_buffers.push_back(std::make_unique<buffer>(static_cast<int>(m_buffers.size())));
+                return m_buffers.back().get();
+            }
+
+            std::mutex								m_mutex;
+            std::vector<const probe*>				m_probes;
+            std::vector<std::unique_ptr<buffer>>	m_buffers;	// kept after their threads end, so that their events can still be exported
+        };
+
+
+        inline probe::probe() {
+            registry::instance().add(this);
+        }
+
+        inline probe::probe(const probe& other)
+        : name { other.name } {
+            registry::instance().add(this);
+        }
+
+        inline probe::~probe() {
+            registry::instance().remove(this);
+        }
+
+
+        /// Prepare the calling thread for profiling, so that the first profiled call on it does not allocate.
+
+        inline void prepare_thread() {
+            registry::local();
+        }
+
+
+        /// Write a string as a JSON string literal.
+
+        inline void write_json_string(std::ostream& out, const char* s) {
+            out << '"';
+            for (; s && *s; ++s) {
+                if (*s == '"' || *s == '\\')
+                    out << '\\';
+                if (static_cast<unsigned char>(*s) >= 0x20)
+                    out << *s;
+            }
+            out << '"';
+        }
+
+
+        /// Write the statistics of all live processors as a JSON array, e.g. for a dashboard.
+        /// Each processor has its name, calls, frames, cycles, worst, cycles_per_call, cycles_per_frame
+        /// and a histogram of the calls per power of two cycles.
+        /// @param	out		The stream to write to.
+
+        inline void write_json(std::ostream& out) {
+            auto first = true;
+            out << "[";
+            registry::instance().for_each_processor([&](const char* name, const statistics& s) {
+                out << (first ? "\n" : ",\n") << "  {\"name\": ";
+                write_json_string(out, name);
+                out << ", \"calls\": " << s.calls() << ", \"frames\": " << s.frames() << ", \"cycles\": " << s.cycles()
+                    << ", \"worst\": " << s.worst() << ", \"cycles_per_call\": " << s.cycles_per_call()
+                    << ", \"cycles_per_frame\": " << s.cycles_per_frame() << ", \"histogram\": [";
+                for (auto bin = 0; bin < statistics::k_bin_count; ++bin)
+                    out << (bin ? ", " : "") << s.histogram(bin);
+                out << "]}";
+                first = false;
+            });
+            out << (first ? "]\n" : "\n]\n");
+        }
+
+
+        /// Write the events recorded since the last call as a Chrome trace, which chrome://tracing and Perfetto open.
+        /// Each call to a profiled processor is a complete event on the track of its thread.
+        /// The buffers are drained, so each event is written once. The first call takes about 20 ms to measure the counter rate.
+        /// @param	out		The stream to write to.
+
+        inline void write_chrome_trace(std::ostream& out) {
+            auto rate  = counts_per_microsecond();
+            auto first = true;
+            out << "{\"traceEvents\": [";
+            registry::instance().for_each_buffer([&](buffer& b) {
+                b.drain([&](const event& e) {
+                    out << (first ? "\n" : ",\n") << "  {\"name\": ";
+                    write_json_string(out, e.name);
+                    out << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << b.thread() << ", \"ts\": " << e.start / rate
+                        << ", \"dur\": " << e.cycles / rate << "}";
+                    first = false;
+                });
+            });
+            out << "\n], \"displayTimeUnit\": \"ns\"}\n";
+        }
+
+#else
+
+        inline void prepare_thread() {}
+
+        template<class stream_type>
+        void write_json(stream_type& out) {
+            out << "[]\n";
+        }
+
+        template<class stream_type>
+        void write_chrome_trace(stream_type& out) {
+            out << "{\"traceEvents\": []}\n";
+        }
+
+#endif
+    }    // namespace profile
+
+
+#if MIN_LIB_PROFILE
+
+    /// A processor whose operator() and process() calls are timed. Everything else is passed through to the processor.
+    /// The number of samples in a call is taken from its first integer argument, as in process(input, output, frame_count),
+    /// or else from the frame count of its first audio_bundle, or else it is one.
+    /// @tparam	processor_type	The processor to time, e.g. lib::delay or lib::limiter.
+
+    template<class processor_type>
+    class profiled : public processor_type {
+    public:
+        using processor_type::processor_type;
+
+
+        /// Set the name under which the processor is exported.
+        /// @param	name	The name, which must outlive the profile, e.g. a string literal.
+
+        void name(const char* name) {
+            m_probe.name = name;
+        }
+
+
+        /// Return the counters of the calls to this processor.
+        /// @return	The statistics.
+
+        const profile::statistics& statistics() const {
+            return m_probe.statistics;
+        }
+
+
+        template<class... argument_types>
+        decltype(auto) operator()(argument_types&&... arguments) {
+            timer t {*this, frames(arguments...)};
+            return processor_type::operator()(std::forward<argument_types>(arguments)...);
+        }
+
+
+        template<class... argument_types>
+        decltype(auto) process(argument_types&&... arguments) {
+            timer t {*this, frames(arguments...)};
+            return processor_type::process(std::forward<argument_types>(arguments)...);
+        }
+
+    private:
+        /// Time a call from construction to destruction, so that calls returning a value are timed the same way as the others.
+
+        class timer {
+        public:
+            timer(profiled& owner, std::uint64_t frames) noexcept
+            : m_owner { owner }
+            , m_frames { frames }
+            , m_start { profile::timestamp() } {}
+
+            ~timer() {
+                auto cycles = profile::timestamp() - m_start;
+                m_owner.m_probe.statistics.add(cycles, m_frames);
+                profile::registry::local().write({m_owner.m_probe.name, m_start, cycles});
+            }
+
+        private:
+            profiled&		m_owner;
+            std::uint64_t	m_frames;
+            std::uint64_t	m_start;
+        };
+
+
+        static std::uint64_t frames() {
+            return 1;
+        }
+
+        template<class first_type, class... argument_types>
+        static std::uint64_t frames(const first_type& first, const argument_types&... others) {
+            using type = std::decay_t<first_type>;
+            if constexpr (std::is_integral<type>::value && !std::is_same<type, bool>::value)
+                return static_cast<std::uint64_t>(first);
+            else if constexpr (std::is_same<type, audio_bundle>::value)
+                return static_cast<std::uint64_t>(const_cast<audio_bundle&>(first).frame_count());
+            else
+                return frames(others...);
+        }
+
+        profile::probe	m_probe;    // a member rather than constructor code, so that the inherited constructors register too
+    };
+
+#else
+
+    /// A processor whose operator() and process() calls would be timed if MIN_LIB_PROFILE were defined to 1.
+    /// As it is not, this is the processor itself, with a name() that does nothing.
+    /// @tparam	processor_type	The processor, e.g. lib::delay or lib::limiter.
+
+    template<class processor_type>
+    class profiled : public processor_type {
+    public:
+        using processor_type::processor_type;
+
+        void name(const char*) {}
+    };
+
+#endif
+
+}    // namespace c74::min::lib
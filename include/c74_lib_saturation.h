@@ -6,13 +6,27 @@
 #pragma once
 
 #include "c74_min_api.h"
+#include "c74_lib_math.h"
+
+#include <array>
 
 namespace c74::min::lib {
 
 
     ///	A single-channel soft-saturation/distortion effect.
+    ///
+    ///	Optionally the shaper can be evaluated with
+    ///	<a href="https://www.dafx.de/paper-archive/2016/dafxpapers/20-DAFx-16_paper_41-PN.pdf">antiderivative anti-aliasing</a>.
+    ///	Rather than shaping each sample, the closed-form antiderivative of the shaper is differentiated across consecutive samples,
+    ///	which averages the shaper over the interval between them and suppresses much of the aliasing at a fraction of the cost of oversampling.
+    ///
+    ///	For the lowest cost, the shaper can instead be evaluated with an odd polynomial that is fitted whenever the drive changes.
+    ///	Together with process(), which clips with min and max rather than branches, this lets the compiler vectorize a whole vector of samples.
+    ///
+    ///	@tparam	math_policy		How the sine of the shaper and its antiderivatives is evaluated: math::precise by default, or math::fast.
 
-    class saturation {
+    template<class math_policy = math::precise>
+    class basic_saturation {
     public:
         /// Set the amount of overdrive.
         /// @param	drive_percentage	The new amount of overdrive as a percentage.
@@ -22,7 +36,7 @@ namespace c74::min::lib {
             auto f  = MIN_CLAMP(drive_percentage / 100.0, 0.001, 0.999);
 
             m_z    = M_PI * f;
-            m_s    = 1.0 / sin(m_z);
+            m_s    = 1.0 / math_policy::sin(m_z);
             m_b    = MIN_CLAMP(1.0 / f, 0.0, 1.0);
             m_nb   = m_b * -1.0;
             auto i = int(f);
@@ -30,6 +44,17 @@ namespace c74::min::lib {
                 m_scale = sin(m_z);    // sin(f * kTTPi);
             else
                 m_scale = 1.0;
+
+            // the antiderivatives at the clipping point, and the cached values that depend on the shape
+
+            m_a1b = antiderivative1(m_b);
+            m_a2b = antiderivative2(m_b);
+
+            m_a1_1 = antiderivative1(m_x_1);
+            m_a2_1 = antiderivative2(m_x_1);
+            m_d_1  = divided_difference(m_x_1, m_x_2, m_a2_1, antiderivative2(m_x_2));
+
+            fit_polynomial();
         }
 
 
@@ -41,10 +66,128 @@ namespace c74::min::lib {
         }
 
 
+        /// Options for how the shaper is evaluated.
+
+        enum class evaluation_mode : int {
+            exact,			///< use sin()
+            polynomial,		///< use an odd polynomial of degree 15, within 1e-10 of the exact shaper at any drive
+            enum_count
+        };
+
+        /// Set how the shaper is evaluated when no anti-aliasing is applied.
+        /// @param	a_mode	The new evaluation mode.
+
+        void evaluation(evaluation_mode a_mode) {
+            m_evaluation = a_mode;
+        }
+
+        /// Return how the shaper is evaluated.
+        /// @return The current evaluation mode.
+
+        evaluation_mode evaluation() {
+            return m_evaluation;
+        }
+
+
+        /// Options for anti-aliasing the shaper.
+
+        enum class antialiasing_mode : int {
+            none,			///< shape each sample directly
+            first_order,	///< first-order antiderivative anti-aliasing, with half a sample of delay
+            second_order,	///< second-order antiderivative anti-aliasing, with one sample of delay and stronger suppression
+            enum_count
+        };
+
+        /// Set the anti-aliasing applied to the shaper. This clears the history.
+        /// @param	a_mode	The new anti-aliasing mode.
+
+        void antialiasing(antialiasing_mode a_mode) {
+            m_antialiasing = a_mode;
+            clear();
+        }
+
+        /// Return the anti-aliasing applied to the shaper.
+        /// @return The current anti-aliasing mode.
+
+        antialiasing_mode antialiasing() {
+            return m_antialiasing;
+        }
+
+
+        /// Return the delay caused by the anti-aliasing.
+        /// @return	The latency in samples, which is 0, 0.5 or 1 depending on the anti-aliasing mode.
+
+        number latency() {
+            if (m_antialiasing == antialiasing_mode::first_order)
+                return 0.5;
+            else if (m_antialiasing == antialiasing_mode::second_order)
+                return 1.0;
+            else
+                return 0.0;
+        }
+
+
+        /// Clear the history used for anti-aliasing.
+        /// All antiderivatives are zero at the origin, so no shaping is required.
+
+        void clear() {
+            m_x_1  = 0.0;
+            m_x_2  = 0.0;
+            m_a1_1 = 0.0;
+            m_a2_1 = 0.0;
+            m_d_1  = 0.0;
+        }
+
+
         /// Calculate one sample.
         ///	@return		Calculated sample
 
         sample operator()(sample x) {
+            if (m_antialiasing == antialiasing_mode::first_order)
+                x = first_order(x);
+            else if (m_antialiasing == antialiasing_mode::second_order)
+                x = second_order(x);
+            else if (m_evaluation == evaluation_mode::polynomial)
+                x = polynomial(x);
+            else
+                x = shape(x);
+            return x * m_scale;
+        }
+
+
+        /// Calculate a vector of samples.
+        /// With the polynomial evaluation mode and no anti-aliasing the loop has no branches, so the compiler can vectorize it.
+        /// @param	input			The samples to shape.
+        /// @param	output			Storage for the shaped samples. May be the same as input.
+        /// @param	frame_count		The number of samples to process.
+
+        void process(const sample* input, sample* output, std::size_t frame_count) {
+            if (m_evaluation == evaluation_mode::polynomial && m_antialiasing == antialiasing_mode::none) {
+                // local copies, since the output might otherwise alias the members
+                const auto c     = m_polynomial;
+                const auto lo    = m_nb;
+                const auto hi    = m_b;
+                const auto scale = m_scale;
+
+                for (auto i = 0; i < frame_count; ++i) {
+                    auto x  = std::min(std::max(input[i], lo), hi);
+                    auto x2 = x * x;
+                    auto y  = c[k_polynomial_terms - 1];
+                    for (auto k = k_polynomial_terms - 2; k >= 0; --k)
+                        y = y * x2 + c[k];
+                    output[i] = y * x * scale;
+                }
+            }
+            else {
+                for (auto i = 0; i < frame_count; ++i)
+                    output[i] = (*this)(input[i]);
+            }
+        }
+
+    private:
+        /// The shaper before scaling.
+
+        number shape(number x) const {
             if (x > m_b)
                 x = 1.0;
             else if (x < m_nb)
@@ -58,23 +201,192 @@ namespace c74::min::lib {
                 }
                 else
                     sign = 1.0;
-                x = sign * sin(m_z * x) * m_s;
+                x = sign * math_policy::sin(m_z * x) * m_s;
             }
 #else
             else
-                x = sin(m_z * x) * m_s;
+                x = math_policy::sin(m_z * x) * m_s;
 #endif
-            return x * m_scale;
+            return x;
         }
 
-    private:
-        number m_drive{};
-        number m_z;
-        number m_s;
-        number m_b;
-        number m_nb;    // negative b
-        number m_scale;
+
+        /// The shaper before scaling, clipped with min and max and evaluated with the fitted polynomial.
+
+        number polynomial(number x) const {
+            x = std::min(std::max(x, m_nb), m_b);
+
+            auto   x2 = x * x;
+            auto   c  = m_polynomial.data();
+            number y  = c[k_polynomial_terms - 1];
+            for (auto k = k_polynomial_terms - 2; k >= 0; --k)
+                y = y * x2 + c[k];
+            return y * x;
+        }
+
+
+        /// Fit the odd polynomial to the shaper between the clipping points.
+        /// Interpolating at Chebyshev nodes gives close to the smallest possible maximum error for the degree.
+        /// The interpolant is converted to powers of x using the recurrence T(k+1) = 2x T(k) - T(k-1),
+        /// which is well conditioned at this degree.
+
+        void fit_polynomial() {
+            constexpr int n = 2 * k_polynomial_terms;    // nodes, for a polynomial of degree n - 1
+
+            std::array<number, n> chebyshev {};
+            for (auto k = 1; k < n; k += 2) {
+                number sum {};
+                for (auto j = 0; j < n; ++j) {
+                    auto theta = M_PI * (j + 0.5) / n;
+                    sum += shape(m_b * cos(theta)) * cos(k * theta);
+                }
+                chebyshev[k] = 2.0 * sum / n;    // the even terms are zero since the shaper is odd
+            }
+
+            std::array<number, n> power {};
+            std::array<number, n> previous {};    // T(k-1)
+            std::array<number, n> current {};     // T(k)
+            std::array<number, n> next {};
+            previous[0] = 1.0;
+            current[1]  = 1.0;
+            for (auto k = 1; k < n; ++k) {
+                for (auto i = 0; i < n; ++i)
+                    power[i] += chebyshev[k] * current[i];
+                for (auto i = 0; i < n; ++i)
+                    next[i] = (i > 0 ? 2.0 * current[i - 1] : 0.0) - previous[i];
+                previous = current;
+                current  = next;
+            }
+
+            // keep the odd powers, scaled from the unit interval to the clipping points
+            for (auto k = 0; k < k_polynomial_terms; ++k)
+                m_polynomial[k] = power[2 * k + 1] / std::pow(m_b, 2 * k + 1);
+        }
+
+
+        /// The first antiderivative of the shaper, which is zero at the origin and even.
+        /// Inside the clipping point it is s * (1 - cos(z * x)) / z, written with sin() to avoid cancellation at low drive.
+        /// Beyond the clipping point the shaper is constant so its antiderivative continues as a straight line.
+
+        number antiderivative1(number x) const {
+            auto a = std::abs(x);
+            if (a > m_b)
+                return m_a1b + (a - m_b);
+
+            auto h = math_policy::sin(0.5 * m_z * x);
+            return 2.0 * m_s * h * h / m_z;
+        }
+
+
+        /// The second antiderivative of the shaper, which is zero at the origin and odd.
+        /// Inside the clipping point it is s * (u - sin(u)) / z^2 with u = z * x,
+        /// which uses a series for small u where the subtraction would lose most of its precision.
+
+        number antiderivative2(number x) const {
+            auto a = std::abs(x);
+            number y;
+
+            if (a > m_b) {
+                auto d = a - m_b;
+                y      = m_a2b + m_a1b * d + 0.5 * d * d;
+            }
+            else {
+                auto u = m_z * a;
+                number v;
+                if (u < 0.25) {
+                    auto u2 = u * u;
+                    v       = u * u2 * (1.0 / 6.0 - u2 * (1.0 / 120.0 - u2 * (1.0 / 5040.0 - u2 * (1.0 / 362880.0))));
+                }
+                else
+                    v = u - math_policy::sin(u);
+                y = m_s * v / (m_z * m_z);
+            }
+            return x < 0.0 ? -y : y;
+        }
+
+
+        /// The slope of the second antiderivative between two samples, which is the mean of the first antiderivative between them.
+        /// When the samples are nearly equal the first antiderivative at their midpoint is used instead.
+
+        number divided_difference(number x0, number x1, number a2_x0, number a2_x1) const {
+            if (std::abs(x0 - x1) < k_tolerance)
+                return antiderivative1(0.5 * (x0 + x1));
+            return (a2_x0 - a2_x1) / (x0 - x1);
+        }
+
+
+        /// First-order anti-aliasing: the mean of the shaper between the previous and current sample.
+
+        number first_order(number x) {
+            auto   a1 = antiderivative1(x);
+            number y;
+
+            if (std::abs(x - m_x_1) < k_tolerance)
+                y = shape(0.5 * (x + m_x_1));
+            else
+                y = (a1 - m_a1_1) / (x - m_x_1);
+
+            m_x_1  = x;
+            m_a1_1 = a1;
+            return y;
+        }
+
+
+        /// Second-order anti-aliasing: the difference of the mean of the first antiderivative over the last two intervals.
+        /// When the current sample and the one two samples ago are nearly equal, the limit of that difference is used instead.
+
+        number second_order(number x) {
+            auto   a2 = antiderivative2(x);
+            auto   d  = divided_difference(x, m_x_1, a2, m_a2_1);
+            number y;
+
+            if (std::abs(x - m_x_2) < k_tolerance) {
+                auto c = 0.5 * (x + m_x_2);
+                auto e = c - m_x_1;
+
+                if (std::abs(e) < k_tolerance)
+                    y = shape(0.5 * (c + m_x_1));
+                else
+                    y = 2.0 * (antiderivative1(c) * e - (antiderivative2(c) - m_a2_1)) / (e * e);
+            }
+            else
+                y = 2.0 * (d - m_d_1) / (x - m_x_2);
+
+            m_x_2  = m_x_1;
+            m_x_1  = x;
+            m_a2_1 = a2;
+            m_d_1  = d;
+            return y;
+        }
+
+
+        static constexpr number k_tolerance = 1e-5;    // below this difference between samples the divided differences are ill-conditioned
+        static constexpr int k_polynomial_terms = 8;    // odd powers from x to x^15
+
+        number				m_drive{};
+        number				m_z;
+        number				m_s;
+        number				m_b;
+        number				m_nb;    // negative b
+        number				m_scale;
+
+        evaluation_mode							m_evaluation	{ evaluation_mode::exact };
+        std::array<number, k_polynomial_terms>	m_polynomial	{};		// coefficients of x, x^3, x^5 ...
+        antialiasing_mode	m_antialiasing	{ antialiasing_mode::none };
+        number				m_a1b			{};		// antiderivatives at the clipping point
+        number				m_a2b			{};
+        number				m_x_1			{};		// previous inputs
+        number				m_x_2			{};
+        number				m_a1_1			{};		// antiderivatives of the previous input
+        number				m_a2_1			{};
+        number				m_d_1			{};		// previous divided difference, for second-order
     };
 
 
+    ///	A saturation with its shaper evaluated by the standard library.
+    ///	This is a class rather than an alias so that it can still be forward declared and specialized for.
+
+    class saturation : public basic_saturation<> {};
+
+
 }    // namespace c74::min::lib
@@ -0,0 +1,226 @@
+/// @file
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include "c74_min_api.h"
+#include "c74_lib_filters.h"
+
+
+namespace c74::min::lib {
+
+
+    ///	Cascade of second-order sections for n-channels of audio, e.g. a parametric equalizer.
+    ///	Each section is a transposed direct form II biquad, as in the biquad class.
+    ///
+    ///	A chain of biquads processed one after another is limited by the latency of each recursion rather than by arithmetic,
+    ///	since every output depends on the one before it. The cascade instead runs all sections of all channels side by side:
+    ///	at each step section k filters the sample that section k-1 produced at the previous step.
+    ///	The state, coefficients and pipeline registers of every section and channel are stored as contiguous lanes,
+    ///	so one step is a single loop over independent lanes that the compiler vectorizes.
+    ///	The pipeline is filled at the start of each vector and drained at the end, so there is no added latency
+    ///	and the output is identical to processing the sections one after another.
+    ///
+    ///	Coefficients should be set from the audio thread, or before processing begins.
+    ///	Use a snapshot to hand them over from a control thread.
+
+    class sos_cascade {
+    public:
+        /// Create a cascade.
+        /// @param	a_channel_count		The number of channels to filter.
+        /// @param	a_section_count		The number of second-order sections applied to each channel.
+        ///								All sections initially pass their input unchanged.
+
+        explicit sos_cascade(int a_channel_count = 1, int a_section_count = 1) {
+            m_channelcount = a_channel_count;
+            m_sectioncount = a_section_count;
+
+            auto lanes = m_channelcount * m_sectioncount;
+
+            m_b0.resize(lanes, 1.0);
+            m_b1.resize(lanes, 0.0);
+            m_b2.resize(lanes, 0.0);
+            m_a1.resize(lanes, 0.0);
+            m_a2.resize(lanes, 0.0);
+            m_z1.resize(lanes, 0.0);
+            m_z2.resize(lanes, 0.0);
+
+            // the registers have an extra channel-width of lanes: the input at the front and the cascade output at the back
+            m_registers[0].resize(lanes + m_channelcount, 0.0);
+            m_registers[1].resize(lanes + m_channelcount, 0.0);
+        }
+
+
+#if 0
+#pragma mark -
+#pragma mark attributes
+#endif
+
+        /// Set the coefficients of one section for all channels. The filter history is retained.
+        /// @param	index				The section in the range [0, section_count - 1], in processing order.
+        /// @param	new_coefficients	The new coefficients, e.g. from filters::peaking().
+
+        void section(int index, const filters::biquad_coefficients& new_coefficients) {
+            for (auto channel = 0; channel < m_channelcount; ++channel)
+                section(index, channel, new_coefficients);
+        }
+
+
+        /// Set the coefficients of one section for one channel. The filter history is retained.
+        /// @param	index				The section in the range [0, section_count - 1], in processing order.
+        /// @param	channel				The channel.
+        /// @param	new_coefficients	The new coefficients.
+
+        void section(int index, int channel, const filters::biquad_coefficients& new_coefficients) {
+            assert(index >= 0 && index < m_sectioncount);
+            assert(channel >= 0 && channel < m_channelcount);
+
+            auto lane = index * m_channelcount + channel;
+
+            m_b0[lane] = new_coefficients.b0;
+            m_b1[lane] = new_coefficients.b1;
+            m_b2[lane] = new_coefficients.b2;
+            m_a1[lane] = new_coefficients.a1;
+            m_a2[lane] = new_coefficients.a2;
+        }
+
+
+        /// Return the coefficients of one section for one channel.
+        /// @param	index		The section in the range [0, section_count - 1].
+        /// @param	channel		The channel.
+        /// @return				The coefficients of the section.
+
+        filters::biquad_coefficients section(int index, int channel = 0) const {
+            auto lane = index * m_channelcount + channel;
+            return {m_b0[lane], m_b1[lane], m_b2[lane], m_a1[lane], m_a2[lane]};
+        }
+
+
+        /// Return the number of sections applied to each channel.
+        /// @return	The section count.
+
+        int section_count() const {
+            return m_sectioncount;
+        }
+
+
+        /// Return the number of channels.
+        /// @return	The channel count.
+
+        int channel_count() const {
+            return m_channelcount;
+        }
+
+
+#if 0
+#pragma mark -
+#pragma mark methods
+#endif
+
+        /// Clear the history of all sections.
+
+        void clear() {
+            std::fill(m_z1.begin(), m_z1.end(), 0.0);
+            std::fill(m_z2.begin(), m_z2.end(), 0.0);
+        }
+
+
+#if 0
+#pragma mark -
+#pragma mark audio
+#endif
+
+        /// Filter n-samples for m-channels.
+        /// The number of channels at the input and output must match the channel count of the cascade.
+        /// The output may be the same as the input.
+
+        void operator()(audio_bundle input, audio_bundle output) {
+            const auto frame_count = input.frame_count();
+            const auto channels    = m_channelcount;
+            const auto sections    = m_sectioncount;
+            const auto last        = (sections - 1) * channels;    // first lane of the last section
+
+            // sample t enters section 0 at step t and leaves section (sections - 1) at step t + sections - 1
+
+            for (long step = 0; step < frame_count + sections - 1; ++step) {
+                auto in  = m_registers[step & 1].data();
+                auto out = m_registers[(step + 1) & 1].data();
+
+                if (step < frame_count) {
+                    for (auto channel = 0; channel < channels; ++channel)
+                        in[channel] = input.samples(channel)[step];
+                }
+
+                // only sections that hold a sample from this vector are active, which is all of them once the pipeline is full
+                auto first_section = std::max<long>(0, step - frame_count + 1);
+                auto last_section  = std::min<long>(sections - 1, step);
+
+                tick(in, out, first_section * channels, (last_section + 1) * channels);
+
+                if (last_section == sections - 1) {
+                    auto frame = step - (sections - 1);
+                    for (auto channel = 0; channel < channels; ++channel)
+                        output.samples(channel)[frame] = out[last + channels + channel];
+                }
+            }
+        }
+
+
+        /// Filter a vector of samples for a single channel cascade.
+        /// @param	input			The samples to filter.
+        /// @param	output			Storage for the filtered samples. May be the same as input.
+        /// @param	frame_count		The number of samples to process.
+
+        void process(const sample* input, sample* output, std::size_t frame_count) {
+            assert(m_channelcount == 1);
+
+            auto         in = const_cast<sample*>(input);
+            audio_bundle a {&in, 1, static_cast<long>(frame_count)};
+            audio_bundle b {&output, 1, static_cast<long>(frame_count)};
+            (*this)(a, b);
+        }
+
+
+    private:
+        /// Advance a range of lanes by one sample.
+        /// Lane j reads its input from register j and writes its output to register j + channel_count,
+        /// which is where the next section reads it from at the following step.
+
+        void tick(const sample* in, sample* out, int begin, int end) {
+            const auto offset = m_channelcount;
+            const auto b0     = m_b0.data();
+            const auto b1     = m_b1.data();
+            const auto b2     = m_b2.data();
+            const auto a1     = m_a1.data();
+            const auto a2     = m_a2.data();
+            const auto z1     = m_z1.data();
+            const auto z2     = m_z2.data();
+
+            for (auto j = begin; j < end; ++j) {
+                auto x = in[j];
+                auto y = b0[j] * x + z1[j];
+
+                z1[j]           = b1[j] * x - a1[j] * y + z2[j];
+                z2[j]           = b2[j] * x - a2[j] * y;
+                out[j + offset] = y;
+            }
+        }
+
+
+        int				m_channelcount	{};
+        int				m_sectioncount	{};
+
+        sample_vector	m_b0;				// [section * channel_count + channel]
+        sample_vector	m_b1;
+        sample_vector	m_b2;
+        sample_vector	m_a1;
+        sample_vector	m_a2;
+        sample_vector	m_z1;
+        sample_vector	m_z2;
+        sample_vector	m_registers[2];		// double-buffered pipeline registers, swapped at every step
+    };
+
+
+}    // namespace c74::min::lib
@@ -0,0 +1,161 @@
+/// @file
+///	@ingroup 	minlib
+///	@brief		The parts of the Min API used by Min-Lib, for building without the Max SDK.
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+///
+///	This header stands in for c74_min_api.h from min-api when Min-Lib is built on its own, e.g. for unit tests and benchmarks.
+///	It defines only what the Min-Lib headers use, with the same names and semantics, and must not be on the include path
+///	of a build that also uses min-api.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/// Limit a value to a range.
+/// The bounds are not checked, so low must not be greater than high.
+
+#define MIN_CLAMP(input, low, high) std::min(std::max((input), (low)), (high))
+
+
+namespace c74::min {
+
+    using number        = double;                  ///< a number for control or parameters
+    using sample        = double;                  ///< a single audio sample
+    using numbers       = std::vector<number>;     ///< a vector of numbers
+    using sample_vector = std::vector<sample>;     ///< a vector of audio samples
+
+    template<class T>
+    using vector = std::vector<T>;
+
+    /// Textual descriptors for the values of an enum used by an attribute.
+
+    using enum_map = std::vector<std::string>;
+
+
+    /// Audio channels passed to a vector operator: an array of pointers to the samples of each channel.
+    /// The bundle does not own the samples.
+
+    class audio_bundle {
+    public:
+        audio_bundle(double** samples, long channel_count, long frame_count)
+        : m_samples { samples }
+        , m_channel_count { channel_count }
+        , m_frame_count { frame_count } {}
+
+        double** samples() {
+            return m_samples;
+        }
+
+        double* samples(std::size_t channel) {
+            return m_samples[channel];
+        }
+
+        long channel_count() const {
+            return m_channel_count;
+        }
+
+        long frame_count() const {
+            return m_frame_count;
+        }
+
+    private:
+        double** m_samples;
+        long     m_channel_count;
+        long     m_frame_count;
+    };
+
+
+    /// Wrap a value into the range [low_bound, high_bound).
+    /// @param	input		The value to wrap.
+    /// @param	low_bound	The bottom of the range.
+    /// @param	high_bound	The top of the range.
+    /// @return				The wrapped value.
+
+    template<class T>
+    T wrap(T input, T low_bound, T high_bound) {
+        if (input >= low_bound && input < high_bound)
+            return input;
+
+        auto range  = high_bound - low_bound;
+        auto offset = std::fmod(input - low_bound, range);
+
+        if (offset < 0)
+            offset += range;
+        return low_bound + offset;
+    }
+
+
+    /// Fold a value back into the range [low_bound, high_bound], as if reflected at the bounds.
+    /// @param	input		The value to fold.
+    /// @param	low_bound	The bottom of the range.
+    /// @param	high_bound	The top of the range.
+    /// @return				The folded value.
+
+    template<class T>
+    T fold(T input, T low_bound, T high_bound) {
+        if (input >= low_bound && input <= high_bound)
+            return input;
+
+        auto range  = high_bound - low_bound;
+        auto offset = std::fmod(input - low_bound, 2 * range);
+
+        if (offset < 0)
+            offset += 2 * range;
+        if (offset > range)
+            offset = 2 * range - offset;
+        return low_bound + offset;
+    }
+
+
+    namespace dataspace {
+
+        /// Units of gain, converted to and from linear amplitude.
+
+        namespace gain {
+
+            struct linear {
+                static number to_linear(number x) {
+                    return x;
+                }
+                static number from_linear(number x) {
+                    return x;
+                }
+            };
+
+            struct db {
+                static number to_linear(number x) {
+                    return std::pow(10.0, x / 20.0);
+                }
+                static number from_linear(number x) {
+                    return 20.0 * std::log10(x);
+                }
+            };
+
+
+            /// Convert a gain from one unit to another.
+            /// @tparam	from_unit	The unit of the value.
+            /// @tparam	to_unit		The unit of the result.
+            /// @param	x			The value.
+            /// @return				The converted value.
+
+            template<class from_unit, class to_unit>
+            number convert(number x) {
+                return to_unit::from_linear(from_unit::to_linear(x));
+            }
+
+        }    // namespace gain
+    }    // namespace dataspace
+}    // namespace c74::min
@@ -0,0 +1,32 @@
+/// @file
+///	@ingroup 	minlib
+///	@brief		Catch for the unit tests of Min-Lib, for building without the Max SDK.
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <catch2/catch.hpp>
+
+#include <iostream>
+
+#include "c74_min_api.h"
+#include "c74_lib.h"
+
+
+/// The tests were written for the Catch 1 bundled with min-api, where Approx has a scale of one,
+/// so values close to zero compare with an absolute tolerance. Catch2 changed the default scale to zero.
+
+#define Approx(value) Catch::Detail::Approx(value).scale(1.0)
+
+
+/// Compare two vectors element by element, with the default tolerance of Approx.
+
+#define REQUIRE_VECTOR_APPROX(source, reference)					\
+    {																\
+        REQUIRE(source.size() == reference.size());					\
+        for (auto i = 0; i < source.size(); ++i) {					\
+            INFO("when i == " << i);								\
+            REQUIRE(source[i] == Approx(reference[i]));				\
+        }															\
+    }
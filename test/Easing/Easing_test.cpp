@@ -2434,3 +2434,125 @@ SCENARIO ("Using In Out Sine Easing") {
 
     }
 }
+
+
+TEST_CASE ("Easing ramps at audio rate and control rate") {
+    using c74::min::lib::easing::function;
+
+    const int	duration	= 1000;
+    const int	interval	= 32;
+
+    // functions with their largest second derivative, for the error bound of linear interpolation
+    const std::pair<function, double> functions[] = { {function::linear, 0.0}, {function::in_cubic, 6.0}, {function::in_out_sine, M_PI * M_PI / 2.0} };
+
+    for (auto& f : functions) {
+        INFO( "function " << static_cast<int>(f.first) );
+
+        c74::min::lib::easing::ramp audio;
+        c74::min::lib::easing::ramp control;
+        audio.function(f.first);
+        control.function(f.first);
+        control.control_rate(interval);
+        audio.start(2.0, 4.0, duration);
+        control.start(2.0, 4.0, duration);
+
+        c74::min::sample_vector expected(1100);
+        c74::min::sample_vector actual(1100);
+        for (auto& x : expected)
+            x = audio();
+        for (auto i = 0; i < 1100; i += 100)
+            control.process(actual.data() + i, 100);
+
+        REQUIRE( expected[0] == Approx(2.0 + 2.0 * c74::min::lib::easing::apply(f.first, 1.0 / duration)) );
+        REQUIRE( expected[duration - 1] == Approx(4.0) );
+        REQUIRE( !audio.active() );
+        REQUIRE( !control.active() );
+
+        auto bound = (double(interval) / duration) * (double(interval) / duration) * f.second * 2.0 / 8.0;
+        for (auto i = 0; i < 1100; ++i)
+            REQUIRE( std::abs(actual[i] - expected[i]) <= bound + 1e-12 );
+    }
+}
+
+
+TEST_CASE ("Easing a vector of values matches easing one value at a time") {
+    using c74::min::lib::easing::function;
+
+    c74::min::sample_vector input(1001);
+    for (auto i = 0; i < input.size(); ++i)
+        input[i] = i / double(input.size() - 1);
+
+    for (auto f = 0; f < static_cast<int>(function::enum_count); ++f) {
+        INFO( "function " << f );
+        auto name = static_cast<function>(f);
+
+        c74::min::sample_vector precise(input.size());
+        c74::min::sample_vector fast(input);
+        c74::min::lib::easing::apply(name, input.data(), precise.data(), input.size());
+        c74::min::lib::easing::apply<c74::min::lib::math::fast>(name, fast.data(), fast.data(), fast.size());
+
+        for (auto i = 0; i < input.size(); ++i) {
+            auto expected = c74::min::lib::easing::apply(name, input[i]);
+            REQUIRE( precise[i] == expected );
+            REQUIRE( std::abs(fast[i] - expected) < 1e-7 );
+        }
+    }
+}
+
+
+TEST_CASE ("Easing tables are close to the easing functions") {
+    using c74::min::lib::easing::function;
+
+    // the largest error with 1024 points, with the spline by default and with linear interpolation
+    const std::tuple<function, double, double> functions[] = {
+        {function::in_elastic, 1e-6, 1e-4}, {function::in_out_elastic, 1e-4, 1e-4}, {function::out_back, 1e-8, 1e-5},
+        {function::out_bounce, 2e-3, 2e-3}, {function::in_out_sine, 1e-9, 1e-6} };
+
+    for (auto& f : functions) {
+        INFO( "function " << static_cast<int>(std::get<0>(f)) );
+
+        c74::min::lib::easing::table<>	spline { std::get<0>(f) };
+        c74::min::lib::easing::table<c74::min::lib::interpolator::linear<>>	linear { std::get<0>(f) };
+        REQUIRE( spline.function() == std::get<0>(f) );
+
+        c74::min::sample_vector input(10007);
+        c74::min::sample_vector output(input.size());
+        for (auto i = 0; i < input.size(); ++i)
+            input[i] = i / double(input.size() - 1);
+        spline(input.data(), output.data(), input.size());
+
+        for (auto i = 0; i < input.size(); ++i) {
+            auto expected = c74::min::lib::easing::apply(std::get<0>(f), input[i]);
+            REQUIRE( std::abs(output[i] - expected) < std::get<1>(f) );
+            REQUIRE( std::abs(linear(input[i]) - expected) < std::get<2>(f) );
+        }
+        REQUIRE( spline(-1.0) == Approx(c74::min::lib::easing::apply(std::get<0>(f), 0.0)).margin(1e-12) );
+        REQUIRE( spline(2.0) == Approx(c74::min::lib::easing::apply(std::get<0>(f), 1.0)).margin(1e-12) );
+    }
+}
+
+
+TEST_CASE ("Easing curves chosen at compile time match easing::apply()") {
+    using c74::min::lib::easing::function;
+    using c74::min::lib::easing::curve;
+
+    static_assert(curve<function::in_out_sine>::name == function::in_out_sine, "the curve knows its function");
+    static_assert(std::is_empty<curve<function::in_elastic>>::value, "curves are stateless");
+
+    curve<function::in_elastic>		elastic;
+    curve<function::out_bounce>		bounce;
+    curve<function::in_out_cubic>	cubic;
+
+    for (auto i = 0; i <= 100; ++i) {
+        auto x = i / 100.0;
+        INFO( "x == " << x );
+        REQUIRE( elastic(x) == c74::min::lib::easing::apply(function::in_elastic, x) );
+        REQUIRE( bounce(x) == c74::min::lib::easing::apply(function::out_bounce, x) );
+        REQUIRE( cubic(x) == c74::min::lib::easing::apply(function::in_out_cubic, x) );
+        REQUIRE( cubic(2.0, 4.0, x) == Approx(2.0 + 2.0 * cubic(x)) );
+    }
+
+    auto& kernels = c74::min::lib::easing::kernels<>;
+    REQUIRE( kernels.size() == static_cast<std::size_t>(function::enum_count) );
+    REQUIRE( kernels[static_cast<int>(function::in_elastic)] == &curve<function::in_elastic>::process<c74::min::sample> );
+}
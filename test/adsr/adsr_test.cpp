@@ -0,0 +1,271 @@
+/// @file
+///	@brief 		Unit test for the adsr class
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#define CATCH_CONFIG_MAIN
+#include "c74_min_catch.h"
+
+#include <chrono>
+
+
+// adsr is a class rather than an alias of basic_adsr<>, so that code which forward declares it still compiles.
+
+namespace c74::min::lib {
+    class adsr;
+}
+
+
+// An envelope with 10 ms segments at 48 kHz and the given curve on every segment.
+
+template<class math_policy = c74::min::lib::math::precise>
+c74::min::lib::basic_adsr<math_policy> make_envelope(double curve, bool return_to_zero = true) {
+    c74::min::lib::basic_adsr<math_policy> env;
+    env.initial(0.0);
+    env.peak(1.0);
+    env.sustain(0.5);
+    env.end(0.0);
+    env.attack(10.0, 48000.0);
+    env.decay(10.0, 48000.0);
+    env.release(10.0, 48000.0);
+    env.retrigger(2.0, 48000.0);
+    env.attack_curve(curve);
+    env.decay_curve(-curve);
+    env.release_curve(curve);
+    env.return_to_zero(return_to_zero);
+    return env;
+}
+
+
+// Render the same sequence of events one sample at a time and in blocks of the given size, and return the largest difference.
+
+template<class math_policy>
+double compare_block_and_scalar(double curve, bool return_to_zero, std::size_t block_size) {
+    auto scalar = make_envelope<math_policy>(curve, return_to_zero);
+    auto block  = make_envelope<math_policy>(curve, return_to_zero);
+
+    // trigger, retrigger during the attack, release early, trigger, release from the sustain
+    const std::pair<int, bool> events[] = { {0, true}, {300, true}, {700, false}, {1000, true}, {3000, false}, {4000, false} };
+    const int length = 4000;
+
+    c74::min::sample_vector expected(length);
+    c74::min::sample_vector actual(length);
+
+    for (auto e = 0; e < 5; ++e) {
+        auto start = events[e].first;
+        auto end   = events[e + 1].first;
+
+        scalar.trigger(events[e].second);
+        block.trigger(events[e].second);
+
+        for (auto i = start; i < end; ++i)
+            expected[i] = scalar();
+        for (auto i = start; i < end; i += block_size)
+            block.process(actual.data() + i, std::min<std::size_t>(block_size, end - i));
+
+        REQUIRE( block.stage() == scalar.stage() );
+    }
+
+    double worst {};
+    for (auto i = 0; i < length; ++i)
+        worst = std::max(worst, std::abs(expected[i] - actual[i]));
+    return worst;
+}
+
+
+TEST_CASE ("adsr block processing matches single samples") {
+    for (auto curve : {0.0, 50.0, -50.0, 100.0}) {
+        for (auto rtz : {true, false}) {
+            for (auto block_size : {1, 7, 64, 512}) {
+                INFO( "curve " << curve << ", return to zero " << rtz << ", block size " << block_size );
+                REQUIRE( compare_block_and_scalar<c74::min::lib::math::precise>(curve, rtz, block_size) < 1e-9 );
+                REQUIRE( compare_block_and_scalar<c74::min::lib::math::fast>(curve, rtz, block_size) < 1e-8 );
+            }
+        }
+    }
+}
+
+
+TEST_CASE ("adsr block slopes follow the single-position slope without a pow per position") {
+    for (auto curve = -100.0; curve <= 100.0; curve += 12.5) {
+        for (auto steps : {50, 480, 48000}) {
+            INFO( "curve " << curve << ", " << steps << " steps" );
+
+            c74::min::lib::adsr::slope	slope;
+            c74::min::sample_vector		block(steps - 1);
+            slope = curve;
+
+            // in runs of varying length, as segment() calls it
+            auto position = 0.0;
+            auto step     = 1.0 / steps;
+            for (auto i = 0, n = 1; i < steps - 1; i += n, n = n * 3 % 1000 + 1) {
+                n = std::min(n, steps - 1 - i);
+                slope(position, step, block.data() + i, n);
+                for (auto k = 0; k < n; ++k)
+                    position += step;
+            }
+
+            double worst {};
+            position = 0.0;
+            for (auto i = 0; i < steps - 1; ++i) {
+                position += step;
+                worst = std::max(worst, std::abs(block[i] - slope(position)));
+            }
+            REQUIRE( worst < 1e-10 );
+        }
+    }
+}
+
+
+// Render the same envelope at audio rate and at control rate, and return the largest difference.
+
+double control_rate_error(double curve, c74::min::lib::interpolator::type kind, double tolerance, double attack_ms = 10.0) {
+    auto audio   = make_envelope(curve);
+    auto control = make_envelope(curve);
+    audio.attack(attack_ms, 48000.0);
+    control.attack(attack_ms, 48000.0);
+    control.control_rate(64, tolerance);
+    control.control_interpolation(kind);
+
+    c74::min::sample_vector expected(64);
+    c74::min::sample_vector actual(64);
+    double worst {};
+
+    audio.trigger(true);
+    control.trigger(true);
+    for (auto n = 0; n < 40; ++n) {
+        if (n == 30) {
+            audio.trigger(false);
+            control.trigger(false);
+        }
+        audio.process(expected.data(), 64);
+        control.process(actual.data(), 64);
+        for (auto i = 0; i < 64; ++i)
+            worst = std::max(worst, std::abs(expected[i] - actual[i]));
+    }
+    return worst;
+}
+
+
+TEST_CASE ("adsr at control rate stays within its tolerance") {
+    for (auto curve : {0.0, 15.0, -15.0, 30.0, -60.0, 100.0}) {
+        for (auto tolerance : {1e-2, 1e-3, 1e-4}) {
+            INFO( "curve " << curve << ", tolerance " << tolerance );
+            REQUIRE( control_rate_error(curve, c74::min::lib::interpolator::type::linear, tolerance) < tolerance );
+            REQUIRE( control_rate_error(curve, c74::min::lib::interpolator::type::spline, tolerance) < tolerance );
+        }
+    }
+}
+
+
+TEST_CASE ("adsr at control rate can keep the attack at audio rate") {
+    auto audio   = make_envelope(40.0);
+    auto control = make_envelope(40.0);
+    audio.attack(1.0, 48000.0);
+    control.attack(1.0, 48000.0);
+    control.control_rate(64, 0.1);
+    control.audio_rate_attack(true);
+
+    c74::min::sample_vector expected(48);
+    c74::min::sample_vector actual(48);
+    audio.trigger(true);
+    control.trigger(true);
+    audio.process(expected.data(), 48);
+    control.process(actual.data(), 48);
+
+    for (auto i = 0; i < 48; ++i)
+        REQUIRE( actual[i] == expected[i] );
+}
+
+
+TEST_CASE ("adsr retrigger without return to zero continues from the current level") {
+    for (auto curve : {0.0, 50.0, -50.0}) {
+        INFO( "curve " << curve );
+
+        // retrigger from the decay, which is above the sustain and below the peak
+        auto env = make_envelope(curve, false);
+        env.trigger(true);
+        c74::min::sample last {};
+        for (auto i = 0; i < 700; ++i)
+            last = env();
+        REQUIRE( env.stage() == c74::min::lib::adsr::adsr_stage::decay );
+
+        env.trigger(true);
+        REQUIRE( env() == last );
+        REQUIRE( env.stage() == c74::min::lib::adsr::adsr_stage::attack );
+
+        // the attack continues upwards from there, without a jump, and takes the rest of its length to reach the peak
+        auto previous = last;
+        auto steps    = 0;
+        while (env.stage() == c74::min::lib::adsr::adsr_stage::attack) {
+            auto y = env();
+            REQUIRE( y > previous - 1e-7 );
+            REQUIRE( y - previous < 0.05 );
+            previous = y;
+            ++steps;
+        }
+        REQUIRE( previous == 1.0 );
+        REQUIRE( steps > 10 );
+        REQUIRE( steps < 480 );
+    }
+}
+
+
+TEST_CASE ("adsr retrigger of a long attack is fast") {
+    c74::min::lib::adsr env;
+    env.initial(0.0);
+    env.peak(1.0);
+    env.sustain(1.0);
+    env.end(0.0);
+    env.attack(2000.0, 96000.0);
+    env.attack_curve(50.0);
+    env.return_to_zero(false);
+    env.trigger(true);
+    for (auto i = 0; i < 1000; ++i)
+        env();
+
+    auto start = std::chrono::steady_clock::now();
+    env.trigger(true);
+    env();
+    auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    REQUIRE( elapsed < 100.0 );
+    REQUIRE( env.stage() == c74::min::lib::adsr::adsr_stage::attack );
+}
+
+
+TEST_CASE ("benchmark of adsr for 256 voices", "[.benchmark]") {
+    const int					voices	= 256;
+    const int					frames	= 64;
+    const int					vectors	= 400;
+    c74::min::sample_vector		output(frames);
+
+    auto time = [&](auto f) {
+        std::vector<c74::min::lib::basic_adsr<>> envelopes;
+        for (auto v = 0; v < voices; ++v) {
+            envelopes.push_back(make_envelope(v % 2 ? 40.0 : 0.0));
+            envelopes.back().trigger(true);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (auto n = 0; n < vectors; ++n) {
+            for (auto& env : envelopes) {
+                if (n == vectors / 2)
+                    env.trigger(false);
+                f(env);
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::micro>(end - start).count() / vectors;
+    };
+
+    auto per_sample = time([&](auto& env) { for (auto i = 0; i < frames; ++i) output[i] = env(); });
+    auto per_block = time([&](auto& env) { env.process(output.data(), frames); });
+    auto control   = time([&](auto& env) { env.control_rate(32); env.process(output.data(), frames); });
+
+    std::cout << voices << " voices, " << frames << " samples, microseconds per vector, per sample / block / control rate: "
+              << per_sample << " / " << per_block << " / " << control << std::endl;
+
+    REQUIRE( std::isfinite(output[frames - 1]) );
+}
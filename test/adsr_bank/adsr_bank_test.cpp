@@ -0,0 +1,182 @@
+/// @file
+///	@brief 		Unit test for the adsr_bank class
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#define CATCH_CONFIG_MAIN
+#include "c74_min_catch.h"
+
+#include <chrono>
+
+
+// Apply the same settings to an envelope or a bank of envelopes.
+
+template<class envelope_type>
+void configure(envelope_type& env, double curve, double attack_ms = 10.0) {
+    env.initial(0.0);
+    env.peak(1.0);
+    env.sustain(0.5);
+    env.end(0.0);
+    env.attack(attack_ms, 48000.0);
+    env.decay(attack_ms * 0.7, 48000.0);
+    env.release(attack_ms * 0.5, 48000.0);
+    env.attack_curve(curve);
+    env.decay_curve(-curve);
+    env.release_curve(curve);
+}
+
+
+// Run a bank and an adsr instance per voice with the same math policy, and require that they match.
+
+template<class math_policy>
+void compare_with_adsr() {
+    const int	voices	= 24;
+    const int	frames	= 64;
+    const int	vectors	= 40;
+
+    for (auto curve : {0.0, 60.0, -60.0}) {
+        INFO( "curve " << curve );
+
+        c74::min::lib::basic_adsr_bank<math_policy> bank {voices};
+        configure(bank, curve);
+
+        std::vector<c74::min::lib::basic_adsr<math_policy>> reference(voices);
+        for (auto& env : reference) {
+            configure(env, curve);
+            env.return_to_zero(true);
+        }
+
+        std::vector<c74::min::sample_vector>	storage(voices, c74::min::sample_vector(frames));
+        std::vector<c74::min::sample*>			channels;
+        for (auto& c : storage)
+            channels.push_back(c.data());
+        c74::min::audio_bundle output {channels.data(), voices, frames};
+
+        double worst {};
+        for (auto n = 0; n < vectors; ++n) {
+            // voices start at staggered times and release at different points: in the attack, decay, sustain or not at all
+            for (auto v = 0; v < voices; ++v) {
+                if (n == v % 5) {
+                    bank.trigger(v, true);
+                    reference[v].trigger(true);
+                }
+                if (n == v % 5 + 1 + v % 17) {
+                    bank.trigger(v, false);
+                    reference[v].trigger(false);
+                }
+            }
+
+            bank(output);
+
+            for (auto v = 0; v < voices; ++v) {
+                for (auto i = 0; i < frames; ++i)
+                    worst = std::max(worst, std::abs(reference[v]() - storage[v][i]));
+                REQUIRE( bank.active(v) == (reference[v].stage() != c74::min::lib::basic_adsr<math_policy>::adsr_stage::inactive) );
+            }
+        }
+        REQUIRE( worst < 1e-7 );
+    }
+}
+
+
+TEST_CASE ("every envelope in a bank matches an adsr instance") {
+    SECTION ("math::precise")
+    compare_with_adsr<c74::min::lib::math::precise>();
+    SECTION ("math::fast")
+    compare_with_adsr<c74::min::lib::math::fast>();
+}
+
+
+TEST_CASE ("adsr_bank triggers and releases voices") {
+    c74::min::lib::adsr_bank bank {8};
+    configure(bank, 0.0);
+
+    c74::min::sample_vector				storage(8 * 16);
+    std::vector<c74::min::sample*>		channels;
+    for (auto v = 0; v < 8; ++v)
+        channels.push_back(storage.data() + v * 16);
+    c74::min::audio_bundle output {channels.data(), 8, 16};
+
+    REQUIRE( bank.active_count() == 0 );
+
+    bank.trigger(5, true);
+    bank.trigger(2, true);
+    REQUIRE( bank.active_count() == 2 );
+    REQUIRE( bank.active(5) );
+    REQUIRE( bank.active(2) );
+    REQUIRE( !bank.active(0) );
+
+    bank(output);
+    REQUIRE( bank.stage(5) == c74::min::lib::adsr::adsr_stage::attack );
+    REQUIRE( bank.level(5) == Approx(16.0 / 480.0) );
+    REQUIRE( channels[0][15] == 0.0 );
+
+    // triggering again restarts the attack from the current level, without a jump
+    auto level = bank.level(5);
+    bank.trigger(5, true);
+    bank(output);
+    REQUIRE( channels[5][0] > level );
+    REQUIRE( channels[5][0] < level + 0.01 );
+
+    // release runs to the end and frees the lane
+    bank.trigger(2, false);
+    REQUIRE( bank.stage(2) == c74::min::lib::adsr::adsr_stage::release );
+    for (auto n = 0; n < 20; ++n)
+        bank(output);
+    REQUIRE( !bank.active(2) );
+    REQUIRE( bank.active(5) );
+    REQUIRE( bank.active_count() == 1 );
+    REQUIRE( channels[2][15] == 0.0 );
+
+    bank.clear();
+    REQUIRE( bank.active_count() == 0 );
+}
+
+
+TEST_CASE ("benchmark of 1024 short envelopes", "[.benchmark]") {
+    const int	voices	= 1024;
+    const int	frames	= 64;
+    const int	vectors	= 200;
+
+    std::vector<c74::min::sample_vector>	storage(voices, c74::min::sample_vector(frames));
+    std::vector<c74::min::sample*>			channels;
+    for (auto& c : storage)
+        channels.push_back(c.data());
+    c74::min::audio_bundle output {channels.data(), voices, frames};
+
+    // grains retriggered in turn, so about a quarter are active at any time
+    auto time = [&](auto trigger, auto process) {
+        auto start = std::chrono::steady_clock::now();
+        for (auto n = 0; n < vectors; ++n) {
+            for (auto v = n % 4; v < voices; v += 4)
+                trigger(v, true);
+            for (auto v = (n + 3) % 4; v < voices; v += 4)
+                trigger(v, false);
+            process();
+        }
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::micro>(end - start).count() / vectors;
+    };
+
+    std::vector<c74::min::lib::adsr> envelopes(voices);
+    for (auto& env : envelopes)
+        configure(env, 40.0, 1.0);
+    auto separate = time([&](int v, bool a) { envelopes[v].trigger(a); }, [&]{
+        for (auto v = 0; v < voices; ++v)
+            envelopes[v].process(channels[v], frames);
+    });
+
+    c74::min::lib::adsr_bank bank {voices};
+    configure(bank, 40.0, 1.0);
+    auto banked = time([&](int v, bool a) { bank.trigger(v, a); }, [&]{ bank(output); });
+
+    c74::min::lib::basic_adsr_bank<c74::min::lib::math::fast> fast_bank {voices};
+    configure(fast_bank, 40.0, 1.0);
+    auto fast_banked = time([&](int v, bool a) { fast_bank.trigger(v, a); }, [&]{ fast_bank(output); });
+
+    std::cout << voices << " envelopes, " << frames << " samples, microseconds per vector, adsr / adsr_bank / adsr_bank with math::fast: "
+              << separate << " / " << banked << " / " << fast_banked << std::endl;
+
+    REQUIRE( std::isfinite(channels[0][frames - 1]) );
+}
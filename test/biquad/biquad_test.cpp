@@ -0,0 +1,126 @@
+/// @file
+///	@brief 		Unit test for the biquad class
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#define CATCH_CONFIG_MAIN
+#include "c74_min_catch.h"
+
+
+// Run a filter over a full-scale sine at the given frequency and return the peak of the output once it has settled.
+
+c74::min::sample settled_peak(c74::min::lib::biquad& f, double frequency) {
+    c74::min::sample peak {};
+
+    for (auto i = 0; i < 48000; ++i) {
+        auto y = f(cos(2.0 * M_PI * frequency * i / 48000.0));
+        if (i >= 24000)
+            peak = std::max(peak, std::abs(y));
+    }
+    return peak;
+}
+
+
+SCENARIO ("a biquad with default coefficients passes its input unchanged") {
+
+    GIVEN ("An instance of the biquad class") {
+        c74::min::lib::biquad f;
+
+        WHEN ("processing a ramp") {
+            c74::min::sample_vector input;
+            c74::min::sample_vector output;
+
+            for (auto i = 0; i < 64; ++i) {
+                input.push_back(i * 0.1 - 3.0);
+                output.push_back(f(input.back()));
+            }
+
+            THEN("the output is identical to the input")
+            REQUIRE( output == input );
+        }
+    }
+}
+
+
+SCENARIO ("lowpass and highpass biquads pass and reject the ends of the spectrum") {
+
+    GIVEN ("A lowpass and a highpass biquad at 1 kHz") {
+        c74::min::lib::biquad lowpass {c74::min::lib::filters::lowpass(1000.0, 0.7071067811865476, 48000.0)};
+        c74::min::lib::biquad highpass {c74::min::lib::filters::highpass(1000.0, 0.7071067811865476, 48000.0)};
+
+        THEN("the lowpass has unity gain at dc and none at nyquist") {
+            REQUIRE( settled_peak(lowpass, 0.0) == Approx(1.0).epsilon(1e-9) );
+            lowpass.clear();
+            REQUIRE( settled_peak(lowpass, 24000.0) == Approx(0.0).margin(1e-9) );
+        }
+        AND_THEN("the highpass has no gain at dc and unity gain at nyquist") {
+            REQUIRE( settled_peak(highpass, 0.0) == Approx(0.0).margin(1e-9) );
+            highpass.clear();
+            REQUIRE( settled_peak(highpass, 24000.0) == Approx(1.0).epsilon(1e-9) );
+        }
+        AND_THEN("both are 3 dB down at the cutoff frequency") {
+            REQUIRE( settled_peak(lowpass, 1000.0) == Approx(sqrt(0.5)).epsilon(1e-3) );
+            REQUIRE( settled_peak(highpass, 1000.0) == Approx(sqrt(0.5)).epsilon(1e-3) );
+        }
+    }
+}
+
+
+SCENARIO ("processing a vector matches processing single samples") {
+
+    GIVEN ("Two identical bandpass biquads") {
+        auto					coefficients = c74::min::lib::filters::bandpass(2000.0, 4.0, 48000.0);
+        c74::min::lib::biquad	scalar {coefficients};
+        c74::min::lib::biquad	vector {coefficients};
+
+        REQUIRE( vector.coefficients().b0 == coefficients.b0 );
+        REQUIRE( vector.coefficients().a2 == coefficients.a2 );
+
+        WHEN ("one filters a sample at a time and the other filters in place in vectors of 100 samples") {
+            const int				buffersize = 100;
+            c74::min::sample_vector	expected;
+            c74::min::sample_vector	output;
+            c74::min::sample_vector	buffer(buffersize);
+
+            for (auto block = 0; block < 10; ++block) {
+                for (auto i = 0; i < buffersize; ++i) {
+                    buffer[i] = sin(0.37 * (block * buffersize + i)) + 0.5 * sin(0.011 * (block * buffersize + i));
+                    expected.push_back(scalar(buffer[i]));
+                }
+                vector.process(buffer.data(), buffer.data(), buffersize);
+                output.insert(output.end(), buffer.begin(), buffer.end());
+            }
+
+            THEN("the outputs are identical")
+            REQUIRE( output == expected );
+        }
+    }
+}
+
+
+SCENARIO ("clearing a biquad discards its history") {
+
+    GIVEN ("A resonant lowpass biquad that has been excited") {
+        c74::min::lib::biquad f {c74::min::lib::filters::lowpass(500.0, 10.0, 48000.0)};
+
+        f(1.0);
+        for (auto i = 0; i < 10; ++i)
+            f(0.0);
+        REQUIRE( f(0.0) != 0.0 );
+
+        WHEN ("the biquad is cleared") {
+            f.clear();
+
+            THEN("silence in produces silence out")
+            for (auto i = 0; i < 10; ++i)
+                REQUIRE( f(0.0) == 0.0 );
+        }
+        AND_WHEN ("the coefficients are changed without clearing") {
+            f.coefficients(c74::min::lib::filters::highpass(500.0, 10.0, 48000.0));
+
+            THEN("the history is retained")
+            REQUIRE( f(0.0) != 0.0 );
+        }
+    }
+}
@@ -0,0 +1,176 @@
+/// @file
+///	@brief 		Unit test for the convolver class
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#define CATCH_CONFIG_MAIN
+#include "c74_min_catch.h"
+
+#include <thread>
+
+
+// Convolve noise with a decaying noise impulse response in vectors of varying size and compare with direct convolution.
+
+void check(int block_size, bool background) {
+    const int				length = 5000;
+    const int				frames = 12000;
+    c74::min::sample_vector	ir(length);
+    c74::min::sample_vector	x(frames);
+
+    for (auto i = 0; i < length; ++i)
+        ir[i] = c74::min::lib::math::random(-1.0, 1.0) * exp(-i / 1000.0);
+    for (auto& v : x)
+        v = c74::min::lib::math::random(-1.0, 1.0);
+
+    c74::min::lib::convolver	c {ir, block_size, background, 256};
+    c74::min::sample_vector		y = x;
+
+    REQUIRE( c.latency() == block_size );
+    REQUIRE( c.stage_count() > 1 );
+
+    // no more than four blocks at a time with the background thread, which is what it can keep up with
+    const int	sizes[] = {1, 7, 64, 100, 13, 512, 3};
+    auto		offset = 0;
+    for (auto i = 0; offset < frames; ++i) {
+        auto n = std::min({sizes[i % 7], frames - offset, background ? 4 * block_size : frames});
+        c.process(y.data() + offset, y.data() + offset, n);
+        offset += n;
+
+        // this runs much faster than real time, so let the background thread keep up rather than skip partitions
+        while (c.pending())
+            std::this_thread::yield();
+    }
+
+    auto matches = true;
+    for (auto t = 0; t < frames; ++t) {
+        double reference {};
+        auto   u = t - block_size;
+        for (auto k = 0; k < length && k <= u; ++k)
+            reference += ir[k] * x[u - k];
+        matches = matches && std::abs(y[t] - reference) < 1e-9;
+    }
+    REQUIRE( matches );
+}
+
+
+TEST_CASE ("convolution matches direct evaluation") {
+    SECTION("block size 32")
+    check(32, false);
+    SECTION("block size 64 with a background thread")
+    check(64, true);
+}
+
+
+TEST_CASE ("a convolver with a background thread that falls behind skips partitions rather than waiting") {
+    c74::min::sample_vector		ir(100000, 0.0001);
+    c74::min::lib::convolver	c {ir, 32, true};
+    c74::min::sample_vector		y(32, 1.0);
+
+    // run far faster than real time, and clear while the background thread may be busy
+    auto finite = true;
+    for (auto i = 0; i < 20000; ++i) {
+        c.process(y.data(), y.data(), y.size());
+        for (auto& v : y) {
+            finite = finite && std::isfinite(v);
+            v = 1.0;
+        }
+        if (i % 5000 == 4999)
+            c.clear();
+    }
+    REQUIRE( finite );
+    REQUIRE( c.stage_count() > 3 );
+}
+
+
+TEST_CASE ("a convolver matches direct convolution again once its background thread has caught up") {
+    const int				length = 5000;
+    const int				frames = 16000;
+    c74::min::sample_vector	ir(length);
+    c74::min::sample_vector	x(frames);
+
+    for (auto i = 0; i < length; ++i)
+        ir[i] = c74::min::lib::math::random(-1.0, 1.0) * exp(-i / 1000.0);
+    for (auto& v : x)
+        v = c74::min::lib::math::random(-1.0, 1.0);
+
+    // stages of 32, 128 and 256 samples, the last with 18 partitions in its delay line
+    c74::min::lib::convolver	c {ir, 32, true, 256};
+    c74::min::sample_vector		y = x;
+    auto						offset = 0;
+
+    auto run = [&](int count) {
+        c.process(y.data() + offset, y.data() + offset, count);
+        offset += count;
+        while (c.pending())
+            std::this_thread::yield();
+    };
+
+    while (offset < 4096)
+        run(32);
+
+    // two partitions of the longest stage at once, which is too fast for the background thread to calculate the first
+    for (auto attempt = 0; attempt < 20 && c.skipped() == 0; ++attempt)
+        run(512);
+    REQUIRE( c.skipped() > 0 );
+
+    auto skipped_until = offset + 2 * 256 + 32;
+    while (offset < frames)
+        run(32);
+
+    // the skipped partitions still entered the delay line, so the rest of the output is exact
+    auto matches = true;
+    for (auto t = skipped_until; t < frames; ++t) {
+        double reference {};
+        auto   u = t - 32;
+        for (auto k = 0; k < length && k <= u; ++k)
+            reference += ir[k] * x[u - k];
+        matches = matches && std::abs(y[t] - reference) < 1e-9;
+    }
+    REQUIRE( matches );
+}
+
+
+TEST_CASE ("a cleared convolver matches direct convolution of the input after clear()") {
+    const int				length = 3000;
+    const int				frames = 8000;
+    c74::min::sample_vector	ir(length);
+    c74::min::sample_vector	x(frames);
+
+    for (auto i = 0; i < length; ++i)
+        ir[i] = c74::min::lib::math::random(-1.0, 1.0) * exp(-i / 1000.0);
+    for (auto& v : x)
+        v = c74::min::lib::math::random(-1.0, 1.0);
+
+    for (auto background : {false, true}) {
+        INFO( "background " << background );
+
+        c74::min::lib::convolver	c {ir, 32, background, 256};
+        c74::min::sample_vector		y = x;
+
+        // clear part way through a block, after the history is full
+        const int cleared = 4000 + 19;
+        for (auto offset = 0; offset < frames; offset += 50) {
+            auto n = std::min(50, frames - offset);
+            if (offset <= cleared && cleared < offset + n) {
+                c.process(y.data() + offset, y.data() + offset, cleared - offset);
+                c.clear();
+                c.process(y.data() + cleared, y.data() + cleared, offset + n - cleared);
+            }
+            else
+                c.process(y.data() + offset, y.data() + offset, n);
+            while (c.pending())
+                std::this_thread::yield();
+        }
+
+        auto matches = true;
+        for (auto t = cleared; t < frames; ++t) {
+            double reference {};
+            auto   u = t - 32;
+            for (auto k = 0; k < length && u - k >= cleared; ++k)
+                reference += ir[k] * x[u - k];
+            matches = matches && std::abs(y[t] - reference) < 1e-9;
+        }
+        REQUIRE( matches );
+    }
+}
@@ -0,0 +1,42 @@
+/// @file
+///	@brief 		Unit test for the linkwitz_riley crossover
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#define CATCH_CONFIG_MAIN
+#include "c74_min_catch.h"
+
+
+SCENARIO ("the bands of a crossover sum to an allpass response") {
+
+    GIVEN ("An instance of the linkwitz_riley class") {
+        c74::min::lib::linkwitz_riley	f;
+        c74::min::lib::biquad			reference {c74::min::lib::filters::allpass(1000.0, 0.7071067811865476, 48000.0)};
+
+        f.frequency(1000.0, 48000.0);
+
+        WHEN ("processing a 256-sample impulse") {
+            const int				buffersize = 256;
+            c74::min::sample_vector	impulse(buffersize);
+
+            std::fill_n(impulse.begin(), buffersize, 0.0);
+            impulse[0] = 1.0;
+
+            c74::min::sample_vector	output;
+            c74::min::sample_vector	expected;
+
+            for (auto x : impulse) {
+                c74::min::sample low;
+                c74::min::sample high;
+
+                f(x, low, high);
+                output.push_back(low + high);
+                expected.push_back(reference(x));
+            }
+
+            THEN("The sum of the bands matches the impulse response of the allpass")
+            REQUIRE_VECTOR_APPROX(output, expected);
+        }
+    }
+}
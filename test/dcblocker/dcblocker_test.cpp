@@ -39,3 +39,34 @@ SCENARIO ("produce the correct impulse response") {
         }
     }
 }
+
+
+SCENARIO ("a dcblocker_bank matches independent dcblocker filters") {
+
+    GIVEN ("A bank of 4 filters and 4 dcblocker instances") {
+        c74::min::lib::dcblocker_bank<4>		bank;
+        std::vector<c74::min::lib::dcblocker>	filters(4);
+
+        WHEN ("processing noise with a dc offset per channel") {
+            const int				frames = 256;
+            c74::min::sample_vector	buffers[4];
+            c74::min::sample*		pointers[4];
+
+            for (auto c = 0; c < 4; ++c) {
+                for (auto i = 0; i < frames; ++i)
+                    buffers[c].push_back(c * 0.25 + c74::min::lib::math::random(-0.1, 0.1));
+                pointers[c] = buffers[c].data();
+            }
+
+            std::vector<c74::min::sample_vector>	reference(buffers, buffers + 4);
+            c74::min::audio_bundle					bundle {pointers, 4, frames};
+            bank(bundle, bundle);
+
+            THEN("every channel matches its scalar filter") {
+                for (auto c = 0; c < 4; ++c)
+                    for (auto i = 0; i < frames; ++i)
+                        REQUIRE( buffers[c][i] == filters[c](reference[c][i]) );
+            }
+        }
+    }
+}
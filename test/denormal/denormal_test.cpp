@@ -0,0 +1,130 @@
+/// @file
+///	@brief 		Unit test and benchmark for denormal protection
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#define CATCH_CONFIG_MAIN
+#include "c74_min_catch.h"
+
+#include <chrono>
+#include <cmath>
+
+
+// Prime a onepole so that its history starts just above the subnormal range and decays slowly through it.
+
+c74::min::lib::onepole primed_onepole() {
+    c74::min::lib::onepole f {0.0};
+    f(1e-305);
+    f.coefficient(0.9999);
+    return f;
+}
+
+
+// Process silence and return the time taken in milliseconds.
+
+double silence(c74::min::lib::onepole& f, int count) {
+    auto   start = std::chrono::steady_clock::now();
+    double sum {};
+
+    for (auto i = 0; i < count; ++i)
+        sum += f(0.0);
+
+    auto end = std::chrono::steady_clock::now();
+    REQUIRE( sum >= 0.0 );    // use the result so the loop is not optimized away
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+
+SCENARIO ("feedback processors produce subnormal values unless protected") {
+
+    GIVEN ("A onepole whose history is decaying toward zero") {
+        auto f = primed_onepole();
+
+        WHEN ("processing silence without protection") {
+            for (auto i = 0; i < 100000; ++i)
+                f(0.0);
+            THEN("the history is subnormal")
+            REQUIRE( std::fpclassify(f.history()) == FP_SUBNORMAL );
+        }
+        AND_WHEN ("processing silence with the history flushed") {
+            f.flush_denormals(true);
+            f(0.0);
+            THEN("the history is zero")
+            REQUIRE( f.history() == 0.0 );
+        }
+        AND_WHEN ("processing silence inside a guard") {
+            {
+                c74::min::lib::denormal::guard guard;
+                for (auto i = 0; i < 100000; ++i)
+                    f(0.0);
+            }
+            THEN("the history is zero if the platform supports flush-to-zero") {
+                if (c74::min::lib::denormal::guard::supported())
+                    REQUIRE( f.history() == 0.0 );
+            }
+        }
+    }
+}
+
+
+TEST_CASE ("flushing leaves normal signals untouched") {
+    c74::min::lib::dcblocker a;
+    c74::min::lib::dcblocker b;
+
+    b.flush_denormals(true);
+    for (auto i = 0; i < 1000; ++i) {
+        auto x = std::sin(i * 0.01);
+        REQUIRE( a(x) == b(x) );
+    }
+
+    REQUIRE( c74::min::lib::denormal::flush(1e-16) == 0.0 );
+    REQUIRE( c74::min::lib::denormal::flush(-1e-16) == 0.0 );
+    REQUIRE( c74::min::lib::denormal::flush(1e-14) == 1e-14 );
+}
+
+
+TEST_CASE ("guards restore the previous state when nested") {
+    auto f = primed_onepole();
+    {
+        c74::min::lib::denormal::guard outer;
+        {
+            c74::min::lib::denormal::guard inner;
+        }
+        for (auto i = 0; i < 100000; ++i)
+            f(0.0);
+        if (c74::min::lib::denormal::guard::supported())
+            REQUIRE( f.history() == 0.0 );
+    }
+
+    f = primed_onepole();
+    for (auto i = 0; i < 100000; ++i)
+        f(0.0);
+    REQUIRE( std::fpclassify(f.history()) == FP_SUBNORMAL );
+}
+
+
+TEST_CASE ("benchmark of silent input", "[.benchmark]") {
+    const int count = 1000000;
+
+    auto   plain      = primed_onepole();
+    double plain_time = silence(plain, count);
+
+    auto flushed = primed_onepole();
+    flushed.flush_denormals(true);
+    double flushed_time = silence(flushed, count);
+
+    auto   guarded = primed_onepole();
+    double guarded_time;
+    {
+        c74::min::lib::denormal::guard guard;
+        guarded_time = silence(guarded, count);
+    }
+
+    std::cout << "onepole, " << count << " samples of silence after decay into the subnormal range:" << std::endl;
+    std::cout << "  unprotected:        " << plain_time << " ms" << std::endl;
+    std::cout << "  flush_denormals():  " << flushed_time << " ms" << std::endl;
+    std::cout << "  denormal::guard:    " << guarded_time << " ms" << std::endl;
+
+    REQUIRE( flushed.history() == 0.0 );
+}
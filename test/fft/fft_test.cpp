@@ -0,0 +1,98 @@
+/// @file
+///	@brief 		Unit test for the fft and real_fft classes
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#define CATCH_CONFIG_MAIN
+#include "c74_min_catch.h"
+
+
+// Direct evaluation of the discrete Fourier transform.
+
+std::vector<c74::min::lib::fft::complex> dft(const std::vector<c74::min::lib::fft::complex>& x, double sign = -1.0) {
+    std::vector<c74::min::lib::fft::complex> y(x.size());
+    for (auto k = 0; k < x.size(); ++k)
+        for (auto n = 0; n < x.size(); ++n)
+            y[k] += x[n] * std::polar(1.0, sign * 2.0 * M_PI * double(k) * n / x.size());
+    return y;
+}
+
+
+TEST_CASE ("mixed radix fft sizes match a direct evaluation, in the interleaved form and the split form in place") {
+    using complex = c74::min::lib::fft::complex;
+
+    for (auto size : {1, 2, 3, 4, 5, 6, 8, 9, 12, 15, 16, 25, 30, 48, 60, 100, 120, 125, 243, 360}) {
+        REQUIRE( c74::min::lib::fft::supported(size) );
+
+        c74::min::lib::fft		transform {std::size_t(size)};
+        std::vector<complex>	x(size);
+        c74::min::sample_vector	re(size);
+        c74::min::sample_vector	im(size);
+
+        for (auto i = 0; i < size; ++i) {
+            x[i]  = {c74::min::lib::math::random(-1.0, 1.0), c74::min::lib::math::random(-1.0, 1.0)};
+            re[i] = x[i].real();
+            im[i] = x[i].imag();
+        }
+
+        auto reference = dft(x);
+        auto y         = x;
+        transform.forward(y.data());
+        for (auto k = 0; k < size; ++k) {
+            REQUIRE( y[k].real() == Approx(reference[k].real()).margin(1e-10) );
+            REQUIRE( y[k].imag() == Approx(reference[k].imag()).margin(1e-10) );
+        }
+        transform.inverse(y.data());
+        for (auto n = 0; n < size; ++n)
+            REQUIRE( y[n].real() / size == Approx(x[n].real()).margin(1e-12) );
+
+        transform.forward(re.data(), im.data(), re.data(), im.data());
+        for (auto k = 0; k < size; ++k) {
+            REQUIRE( re[k] == Approx(reference[k].real()).margin(1e-10) );
+            REQUIRE( im[k] == Approx(reference[k].imag()).margin(1e-10) );
+        }
+
+        transform.inverse(re.data(), im.data(), re.data(), im.data());
+        for (auto n = 0; n < size; ++n) {
+            REQUIRE( re[n] / size == Approx(x[n].real()).margin(1e-12) );
+            REQUIRE( im[n] / size == Approx(x[n].imag()).margin(1e-12) );
+        }
+    }
+
+    REQUIRE( c74::min::lib::fft::supported(7) == false );
+    REQUIRE( c74::min::lib::fft::supported(0) == false );
+}
+
+
+TEST_CASE ("real fft matches the complex transform of real data") {
+    using complex = c74::min::lib::fft::complex;
+
+    for (auto size : {2, 4, 6, 10, 24, 64, 90, 512}) {
+        c74::min::lib::real_fft	transform {std::size_t(size)};
+        std::vector<complex>	x(size);
+        c74::min::sample_vector	input(size);
+
+        for (auto i = 0; i < size; ++i) {
+            input[i] = c74::min::lib::math::random(-1.0, 1.0);
+            x[i]     = input[i];
+        }
+
+        REQUIRE( transform.bin_count() == size / 2 + 1 );
+
+        c74::min::sample_vector	re(size / 2 + 1);
+        c74::min::sample_vector	im(size / 2 + 1);
+        auto					reference = dft(x);
+
+        transform.forward(input.data(), re.data(), im.data());
+        for (auto k = 0; k <= size / 2; ++k) {
+            REQUIRE( re[k] == Approx(reference[k].real()).margin(1e-10) );
+            REQUIRE( im[k] == Approx(reference[k].imag()).margin(1e-10) );
+        }
+
+        c74::min::sample_vector output(size);
+        transform.inverse(re.data(), im.data(), output.data());
+        for (auto n = 0; n < size; ++n)
+            REQUIRE( output[n] / size == Approx(input[n]).margin(1e-12) );
+    }
+}
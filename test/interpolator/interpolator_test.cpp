@@ -768,3 +768,36 @@ TEST_CASE("Produce correct values when changing between types using interpolator
 
 }
 
+
+
+TEST_CASE ("knots evaluates each knot once within a run") {
+    using c74::min::lib::interpolator::type;
+
+    for (auto kind : {type::linear, type::spline}) {
+        INFO( "spline " << (kind == type::spline) );
+
+        // a quadratic, over 100 samples with a knot every 8, in runs that do not line up with the knots
+        std::vector<int>		calls(101);
+        auto					function = [&calls](int i) { ++calls[i]; return 0.001 * i * i; };
+        c74::min::sample_vector	output(100);
+
+        for (auto begin = 0; begin < 100; begin += 30) {
+            auto count = std::min(30, 100 - begin);
+            c74::min::lib::interpolator::knots(function, kind, 8, begin, count, 100, output.data() + begin);
+        }
+
+        for (auto i = 8; i <= 100; i += 8)
+            REQUIRE( output[i - 1] == Approx(0.001 * i * i) );
+        REQUIRE( output[99] == Approx(10.0) );
+
+        // only the 14 knots are evaluated, and the spline's outer knot for the shorter last interval at 92,
+        // and a knot is evaluated again only at the start of another run
+        auto total = 0;
+        for (auto i = 0; i <= 100; ++i) {
+            INFO( "index " << i );
+            REQUIRE( (i % 8 == 0 || i == 100 || (i == 92 && kind == type::spline) || calls[i] == 0) );
+            total += calls[i];
+        }
+        REQUIRE( total <= 15 + 3 * (kind == type::spline ? 4 : 2) );
+    }
+}
@@ -0,0 +1,193 @@
+/// @file
+///	@brief 		Unit test for the limiter class
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#define CATCH_CONFIG_MAIN
+#include "c74_min_catch.h"
+
+#include <atomic>
+#include <thread>
+
+
+// Process a loud left channel and a quiet right channel, returning the peak of each channel after the limiter has settled.
+
+template<class F>
+std::pair<double, double> peaks(F&& process) {
+    const int				buffersize = 128;
+    c74::min::sample_vector	left(buffersize);
+    c74::min::sample_vector	right(buffersize);
+    c74::min::sample_vector	out_left(buffersize);
+    c74::min::sample_vector	out_right(buffersize);
+    c74::min::sample*		inputs[] = {left.data(), right.data()};
+    c74::min::sample*		outputs[] = {out_left.data(), out_right.data()};
+    c74::min::audio_bundle	input {inputs, 2, buffersize};
+    c74::min::audio_bundle	output {outputs, 2, buffersize};
+    double					peak_left {};
+    double					peak_right {};
+
+    for (auto block = 0; block < 50; ++block) {
+        for (auto i = 0; i < buffersize; ++i) {
+            auto t = block * buffersize + i;
+            left[i] = 1.5 * sin(t * 0.01);
+            right[i] = 0.3 * sin(t * 0.05);
+        }
+        process(input, output);
+        if (block >= 10) {
+            for (auto i = 0; i < buffersize; ++i) {
+                peak_left = std::max(peak_left, std::abs(out_left[i]));
+                peak_right = std::max(peak_right, std::abs(out_right[i]));
+            }
+        }
+    }
+    return {peak_left, peak_right};
+}
+
+
+SCENARIO ("channels may be linked or limited independently") {
+
+    GIVEN ("A 2-channel limiter with a threshold of -6 dB") {
+        c74::min::lib::limiter	l {2, 512, 48000.0};
+        auto					threshold = pow(10.0, -6.0 / 20.0);
+
+        l.threshold(-6.0);
+        l.lookahead(64);
+        l.release(50.0);
+        l.dcblock(false);
+
+        WHEN ("the channels are fully linked") {
+            auto p = peaks([&l](auto& in, auto& out) { l(in, out); });
+            THEN("the loud channel is limited and the quiet channel is reduced with it") {
+                REQUIRE( p.first <= Approx(threshold) );
+                REQUIRE( p.second < 0.3 * 0.5 );
+            }
+        }
+        AND_WHEN ("the channels are limited independently") {
+            l.link(c74::min::lib::limiter::link_mode::per_channel);
+            auto p = peaks([&l](auto& in, auto& out) { l(in, out); });
+            THEN("the loud channel is limited and the quiet channel is untouched") {
+                REQUIRE( p.first <= Approx(threshold) );
+                REQUIRE( p.second == Approx(0.3).epsilon(0.01) );
+            }
+        }
+        AND_WHEN ("each channel is placed in its own group") {
+            l.groups({1, 0});
+            l.link(c74::min::lib::limiter::link_mode::grouped);
+            auto p = peaks([&l](auto& in, auto& out) { l(in, out); });
+            THEN("the result is the same as limiting independently") {
+                REQUIRE( p.first <= Approx(threshold) );
+                REQUIRE( p.second == Approx(0.3).epsilon(0.01) );
+            }
+        }
+    }
+}
+
+
+SCENARIO ("detection may come from a sidechain") {
+
+    GIVEN ("A 2-channel limiter with a threshold of -6 dB and a sidechain that is loud only on the right") {
+        c74::min::lib::limiter	l {2, 512, 48000.0};
+        const int				buffersize = 128;
+        c74::min::sample_vector	silence(buffersize, 0.0);
+        c74::min::sample_vector	loud(buffersize, 2.0);
+        c74::min::sample*		sidechains[] = {silence.data(), loud.data()};
+        c74::min::audio_bundle	sidechain {sidechains, 2, buffersize};
+
+        l.threshold(-6.0);
+        l.lookahead(64);
+        l.dcblock(false);
+        l.link(c74::min::lib::limiter::link_mode::per_channel);
+
+        WHEN ("processing the input") {
+            auto p = peaks([&](auto& in, auto& out) { l(in, sidechain, out); });
+            THEN("only the right channel is reduced, and by the amount the sidechain exceeds the threshold") {
+                REQUIRE( p.first == Approx(1.5).epsilon(0.01) );
+                REQUIRE( p.second == Approx(0.3 * pow(10.0, -6.0 / 20.0) / 2.0).epsilon(0.01) );
+            }
+        }
+    }
+}
+
+
+TEST_CASE ("attributes may be set from a control thread while the audio thread clears and processes") {
+    using namespace c74::min;
+
+    lib::limiter			l {2, 512, 48000.0};
+    const int				buffersize = 64;
+    sample_vector			left(buffersize, 0.9);
+    sample_vector			right(buffersize, -0.9);
+    sample*					channels[] = {left.data(), right.data()};
+    audio_bundle			bundle {channels, 2, buffersize};
+    std::atomic<bool>		done {false};
+    bool					finite {true};
+
+    std::thread audio([&] {
+        for (auto block = 0; block < 2000; ++block) {
+            l(bundle, bundle);
+            if (block % 7 == 0)
+                l.clear();
+            for (auto i = 0; i < buffersize; ++i)
+                finite = finite && std::isfinite(left[i]) && std::isfinite(right[i]);
+            std::fill(left.begin(), left.end(), 0.9);
+            std::fill(right.begin(), right.end(), -0.9);
+        }
+        done = true;
+    });
+
+    for (auto i = 0; !done; ++i) {
+        l.threshold(-(i % 12));
+        l.release(10.0 + i % 100);
+        l.mode(i % 2 ? lib::limiter::response_mode::linear : lib::limiter::response_mode::exponential);
+        l.lookahead(16 + i % 200);
+        l.preamp(i % 6);
+        l.groups({i % 2, 0});
+        l.link(static_cast<lib::limiter::link_mode>(i % 3));
+    }
+    audio.join();
+
+    REQUIRE( finite );
+}
+
+
+TEST_CASE ("a buffer smaller than the default lookahead limits the lookahead") {
+    using namespace c74::min;
+
+    lib::limiter		l {2, 64, 48000.0};
+    sample_vector		left(64, 2.0);
+    sample_vector		right(64, 2.0);
+    sample*				channels[] = {left.data(), right.data()};
+    audio_bundle		bundle {channels, 2, 64};
+
+    REQUIRE( l.lookahead() == 64 );
+
+    l.dcblock(false);
+    l(bundle, bundle);
+    REQUIRE( std::abs(left[63]) <= 1.0 );
+
+    lib::multiband_limiter<4> m {2, 32, 48000.0};
+    REQUIRE( m.lookahead() == 32 );
+}
+
+
+TEST_CASE ("the output is delayed by the lookahead and the gain ramps down ahead of a peak") {
+    using namespace c74::min;
+
+    lib::limiter		l {1, 512, 48000.0};
+    sample_vector		samples(64);
+    sample*				channels[] = {samples.data()};
+    audio_bundle		bundle {channels, 1, 64};
+
+    l.lookahead(8);
+    l.dcblock(false);
+    for (auto i = 0; i < 64; ++i)
+        samples[i] = i >= 20 && i < 30 ? 2.0 : 0.5;
+    l(bundle, bundle);
+
+    REQUIRE( samples[7] == 0.0 );
+    REQUIRE( samples[8] == Approx(0.5) );
+    REQUIRE( samples[20] == Approx(0.5) );
+    for (auto i = 21; i < 28; ++i)
+        REQUIRE( samples[i] < samples[i - 1] );
+    REQUIRE( samples[28] == Approx(1.0) );
+}
@@ -0,0 +1,77 @@
+/// @file
+///	@brief 		Unit test for the loudness_meter class
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#define CATCH_CONFIG_MAIN
+#include "c74_min_catch.h"
+
+
+// Feed a sine wave of the given amplitude into the left channel of a stereo meter for a number of seconds.
+
+void tone(c74::min::lib::loudness_meter& meter, double amplitude, double seconds, long& t) {
+    const int				buffersize = 480;
+    c74::min::sample_vector	left(buffersize);
+    c74::min::sample_vector	right(buffersize, 0.0);
+    c74::min::sample*		inputs[] = {left.data(), right.data()};
+    c74::min::audio_bundle	input {inputs, 2, buffersize};
+
+    for (auto block = 0; block < seconds * 100; ++block) {
+        for (auto i = 0; i < buffersize; ++i, ++t)
+            left[i] = amplitude * sin(2.0 * M_PI * 997.0 * t / 48000.0);
+        meter(input);
+    }
+}
+
+
+SCENARIO ("a full-scale sine in one channel measures -3.01 LUFS") {
+
+    GIVEN ("A stereo loudness meter") {
+        c74::min::lib::loudness_meter	meter {2, 48000.0};
+        long							t {};
+
+        THEN("Nothing has been measured yet")
+        REQUIRE( meter.momentary() == -std::numeric_limits<double>::infinity() );
+
+        WHEN ("measuring 5 seconds of a 997 Hz sine at 0 dBFS") {
+            tone(meter, 1.0, 5.0, t);
+            THEN("The momentary, short-term, and integrated loudness all agree with EBU Tech 3341") {
+                REQUIRE( meter.momentary() == Approx(-3.01).margin(0.1) );
+                REQUIRE( meter.short_term() == Approx(-3.01).margin(0.1) );
+                REQUIRE( meter.integrated() == Approx(-3.01).margin(0.1) );
+            }
+        }
+    }
+}
+
+
+SCENARIO ("integrated loudness is gated") {
+
+    GIVEN ("A stereo loudness meter") {
+        c74::min::lib::loudness_meter	meter {2, 48000.0};
+        long							t {};
+
+        WHEN ("measuring a tone at -20 dBFS followed by silence") {
+            tone(meter, pow(10.0, -20.0 / 20.0), 10.0, t);
+            auto before = meter.integrated();
+            tone(meter, 0.0, 10.0, t);
+
+            THEN("The silence is excluded by the absolute gate") {
+                REQUIRE( before == Approx(-23.01).margin(0.1) );
+                REQUIRE( meter.integrated() == Approx(before).margin(0.1) );
+                REQUIRE( meter.momentary() == -std::numeric_limits<double>::infinity() );
+            }
+        }
+        AND_WHEN ("measuring a tone at -20 dBFS followed by a tone 30 dB quieter") {
+            tone(meter, pow(10.0, -20.0 / 20.0), 10.0, t);
+            auto before = meter.integrated();
+            tone(meter, pow(10.0, -50.0 / 20.0), 10.0, t);
+
+            THEN("The quiet passage is excluded by the relative gate") {
+                REQUIRE( meter.integrated() == Approx(before).margin(0.1) );
+                REQUIRE( meter.short_term() == Approx(-53.01).margin(0.1) );
+            }
+        }
+    }
+}
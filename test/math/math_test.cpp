@@ -0,0 +1,247 @@
+/// @file
+///	@brief 		Unit test for the math functions
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#define CATCH_CONFIG_MAIN
+#include "c74_min_catch.h"
+
+#include <chrono>
+
+using c74::min::lib::math::fast;
+using c74::min::lib::math::precise;
+
+
+// The largest error of an approximation over evenly spaced points in a range, absolute or relative to the reference.
+
+template<class approximation_type, class reference_type>
+double worst_error(approximation_type approximation, reference_type reference, double low, double high, bool relative) {
+    const int	count = 1000000;
+    double		worst {};
+
+    for (auto i = 0; i <= count; ++i) {
+        auto x     = low + (high - low) * i / count;
+        auto error = std::abs(approximation(x) - reference(x));
+        if (relative)
+            error /= std::abs(reference(x));
+        worst = std::max(worst, error);
+    }
+    return worst;
+}
+
+
+TEST_CASE ("fast math functions are within their documented error bounds") {
+    SECTION("sin and cos") {
+        REQUIRE( worst_error([](double x) { return fast::sin(x); }, [](double x) { return std::sin(x); }, -10.0, 10.0, false) < 2e-9 );
+        REQUIRE( worst_error([](double x) { return fast::cos(x); }, [](double x) { return std::cos(x); }, -10.0, 10.0, false) < 2e-9 );
+        REQUIRE( worst_error([](double x) { return fast::sin(x); }, [](double x) { return std::sin(x); }, -1e6, 1e6, false) < 2e-9 );
+        REQUIRE( fast::sin(0.0) == 0.0 );
+        REQUIRE( fast::cos(0.0) == 1.0 );
+    }
+    SECTION("exp2 and exp") {
+        REQUIRE( worst_error([](double x) { return fast::exp2(x); }, [](double x) { return std::exp2(x); }, -1022.0, 1023.0, true) < 1e-8 );
+        REQUIRE( worst_error([](double x) { return fast::exp(x); }, [](double x) { return std::exp(x); }, -708.0, 709.0, true) < 1e-8 );
+        REQUIRE( fast::exp2(0.0) == 1.0 );
+        REQUIRE( fast::exp2(10.0) == 1024.0 );
+    }
+    SECTION("log2") {
+        REQUIRE( worst_error([](double x) { return fast::log2(x); }, [](double x) { return std::log2(x); }, 1e-6, 10.0, false) < 1.5e-9 );
+        REQUIRE( worst_error([](double x) { return fast::log2(x); }, [](double x) { return std::log2(x); }, 1e-300, 1e300, false) < 1.5e-9 );
+        REQUIRE( fast::log2(1.0) == 0.0 );
+        REQUIRE( fast::log2(0.125) == -3.0 );
+    }
+    SECTION("pow") {
+        for (auto y : {0.25, 2.0, 3.7, 20.0}) {
+            auto bound = 1e-8 + 1e-9 * y;
+            REQUIRE( worst_error([y](double x) { return fast::pow(x, y); }, [y](double x) { return std::pow(x, y); }, 1e-6, 4.0, true) < bound );
+        }
+    }
+    SECTION("tanh") {
+        REQUIRE( worst_error([](double x) { return fast::tanh(x); }, [](double x) { return std::tanh(x); }, -30.0, 30.0, false) < 5e-9 );
+    }
+}
+
+
+TEST_CASE ("fast math functions behave outside their ranges") {
+    REQUIRE( std::isfinite(fast::exp(1000.0)) );
+    REQUIRE( fast::exp(1000.0) > 1e307 );
+    REQUIRE( fast::exp(-1000.0) >= 0.0 );
+    REQUIRE( fast::exp(-1000.0) < 1e-300 );
+    REQUIRE( fast::tanh(1000.0) == 1.0 );
+    REQUIRE( fast::tanh(-1000.0) == -1.0 );
+    REQUIRE( fast::pow(0.0, 2.0) == 0.0 );
+    REQUIRE( fast::pow(-1.0, 2.0) == 0.0 );
+}
+
+
+TEST_CASE ("block overloads match the scalar functions") {
+    c74::min::sample_vector x(1001);
+    c74::min::sample_vector y(x.size());
+    for (auto i = 0; i < x.size(); ++i)
+        x[i] = 0.01 * i + 0.001;
+
+    fast::sin(x.data(), y.data(), x.size());
+    for (auto i = 0; i < x.size(); ++i)
+        REQUIRE( y[i] == fast::sin(x[i]) );
+
+    fast::log2(x.data(), y.data(), x.size());
+    for (auto i = 0; i < x.size(); ++i)
+        REQUIRE( y[i] == fast::log2(x[i]) );
+
+    fast::pow(x.data(), 1.5, y.data(), x.size());
+    for (auto i = 0; i < x.size(); ++i)
+        REQUIRE( y[i] == fast::pow(x[i], 1.5) );
+
+    precise::exp(x.data(), y.data(), x.size());
+    for (auto i = 0; i < x.size(); ++i)
+        REQUIRE( y[i] == std::exp(x[i]) );
+}
+
+
+TEST_CASE ("select chooses a value without a branch") {
+    using c74::min::lib::math::select;
+
+    REQUIRE( select(true, 1.5, -2.0) == 1.5 );
+    REQUIRE( select(false, 1.5, -2.0) == -2.0 );
+    REQUIRE( std::signbit(select(true, -0.0, 0.0)) );
+    REQUIRE( select(false, std::nan(""), INFINITY) == INFINITY );
+}
+
+
+TEST_CASE ("processors accept a math policy") {
+    c74::min::lib::onepole	reference;
+    c74::min::lib::onepole	approximate;
+
+    reference.frequency(1000.0, 48000.0);
+    approximate.frequency<fast>(1000.0, 48000.0);
+    REQUIRE( approximate.coefficient() == Approx(reference.coefficient()).epsilon(1e-8) );
+
+    c74::min::lib::interpolator::cosine<>							exact;
+    c74::min::lib::interpolator::cosine<c74::min::number, fast>		quick;
+    for (auto delta = 0.0; delta <= 1.0; delta += 0.01)
+        REQUIRE( quick(2.0, 3.0, delta) == Approx(exact(2.0, 3.0, delta)).margin(1e-8) );
+
+    c74::min::lib::saturation					precise_shaper;
+    c74::min::lib::basic_saturation<fast>		fast_shaper;
+    precise_shaper.drive(70.0);
+    fast_shaper.drive(70.0);
+    for (auto x = -1.5; x <= 1.5; x += 0.01)
+        REQUIRE( fast_shaper(x) == Approx(precise_shaper(x)).margin(1e-8) );
+
+    c74::min::lib::adsr::slope				precise_slope;
+    c74::min::lib::basic_adsr<fast>::slope	fast_slope;
+    precise_slope = 40.0;
+    fast_slope = 40.0;
+    for (auto x = 0.0; x <= 1.0; x += 0.01)
+        REQUIRE( fast_slope(x) == Approx(precise_slope(x)).margin(1e-8) );
+}
+
+
+TEST_CASE ("streaming statistics match a two-pass calculation") {
+    c74::min::lib::xoshiro		engine {7};
+    std::vector<double>			x(10007);
+    for (auto& v : x)
+        v = 1000.0 + engine.bipolar();    // a large offset, which loses precision with a naive sum of squares
+
+    double mean {};
+    for (auto v : x)
+        mean += v;
+    mean /= x.size();
+    double variance {};
+    for (auto v : x)
+        variance += (v - mean) * (v - mean);
+    variance /= x.size();
+
+    c74::min::lib::math::statistics scalar;
+    for (auto v : x)
+        scalar(v);
+
+    c74::min::lib::math::statistics block;
+    block.update(x.data(), 5000);
+    block.update(x.data() + 5000, x.size() - 5000);
+
+    c74::min::lib::math::statistics first;
+    c74::min::lib::math::statistics second;
+    first.update(x.data(), 3001);
+    second.update(x.data() + 3001, x.size() - 3001);
+    first.merge(second);
+
+    for (const auto& s : {scalar, block, first}) {
+        REQUIRE( s.count() == x.size() );
+        REQUIRE( s.mean() == Approx(mean).epsilon(1e-14) );
+        REQUIRE( s.variance() == Approx(variance).epsilon(1e-10) );
+        REQUIRE( s.minimum() == *std::min_element(x.begin(), x.end()) );
+        REQUIRE( s.maximum() == *std::max_element(x.begin(), x.end()) );
+    }
+
+    auto result = c74::min::lib::math::mean(x);
+    REQUIRE( result.first == Approx(mean).epsilon(1e-14) );
+    REQUIRE( result.second == Approx(std::sqrt(variance)).epsilon(1e-10) );
+}
+
+
+TEST_CASE ("streaming statistics of a sine") {
+    c74::min::lib::math::statistics s;
+    REQUIRE( s.count() == 0 );
+    REQUIRE( s.rms() == 0.0 );
+    REQUIRE( s.crest_factor() == 0.0 );
+
+    std::vector<double> x(4800);
+    for (auto i = 0; i < x.size(); ++i)
+        x[i] = 0.5 * std::sin(2.0 * M_PI * i / 480.0);
+    s.update(x.data(), x.size());
+
+    REQUIRE( s.mean() == Approx(0.0).margin(1e-15) );
+    REQUIRE( s.rms() == Approx(0.5 / std::sqrt(2.0)) );
+    REQUIRE( s.peak() == Approx(0.5) );
+    REQUIRE( s.crest_factor() == Approx(std::sqrt(2.0)) );
+
+    s.clear();
+    REQUIRE( s.count() == 0 );
+    REQUIRE( s.peak() == 0.0 );
+}
+
+
+TEST_CASE ("benchmark of fast math functions", "[.benchmark]") {
+    const int				count = 1 << 16;
+    c74::min::sample_vector	x(count);
+    c74::min::sample_vector	y(count);
+    for (auto i = 0; i < count; ++i)
+        x[i] = (i % 1000) * 0.01 + 0.001;
+
+    auto time = [](auto f) {
+        auto start = std::chrono::steady_clock::now();
+        for (auto i = 0; i < 20; ++i)
+            f();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::micro>(end - start).count() / 20;
+    };
+
+    std::cout << count << " values, precise / fast in microseconds:" << std::endl;
+    std::cout << "  sin:   " << time([&]{ precise::sin(x.data(), y.data(), count); }) << " / " << time([&]{ fast::sin(x.data(), y.data(), count); }) << std::endl;
+    std::cout << "  exp:   " << time([&]{ precise::exp(x.data(), y.data(), count); }) << " / " << time([&]{ fast::exp(x.data(), y.data(), count); }) << std::endl;
+    std::cout << "  log2:  " << time([&]{ precise::log2(x.data(), y.data(), count); }) << " / " << time([&]{ fast::log2(x.data(), y.data(), count); }) << std::endl;
+    std::cout << "  tanh:  " << time([&]{ precise::tanh(x.data(), y.data(), count); }) << " / " << time([&]{ fast::tanh(x.data(), y.data(), count); }) << std::endl;
+
+    REQUIRE( std::isfinite(y[count - 1]) );
+}
+
+
+TEST_CASE ("benchmark of streaming statistics", "[.benchmark]") {
+    const int						count = 1 << 16;
+    c74::min::sample_vector			x(count);
+    c74::min::lib::math::statistics	s;
+    for (auto i = 0; i < count; ++i)
+        x[i] = (i % 1000) * 0.01 + 0.001;
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < 20; ++i) {
+        s.clear();
+        s.update(x.data(), count);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << count << " values, statistics in microseconds: " << std::chrono::duration<double, std::micro>(end - start).count() / 20 << std::endl;
+    REQUIRE( s.count() == count );
+}
@@ -0,0 +1,181 @@
+/// @file
+///	@brief 		Unit test for the multiband limiter
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#define CATCH_CONFIG_MAIN
+#include "c74_min_catch.h"
+
+#include <chrono>
+
+
+SCENARIO ("multiband limiter is transparent below threshold") {
+
+    GIVEN ("A 4-band, 2-channel multiband limiter") {
+        c74::min::lib::multiband_limiter<4>	l {2, 512, 48000.0};
+
+        l.lookahead(100);
+
+        WHEN ("processing a quiet signal in vectors of 100 samples") {
+            const int				buffersize = 100;
+            c74::min::sample_vector	left(buffersize);
+            c74::min::sample_vector	right(buffersize);
+            c74::min::sample_vector	out_left(buffersize);
+            c74::min::sample_vector	out_right(buffersize);
+            c74::min::sample*		inputs[] = {left.data(), right.data()};
+            c74::min::sample*		outputs[] = {out_left.data(), out_right.data()};
+
+            c74::min::audio_bundle	input {inputs, 2, buffersize};
+            c74::min::audio_bundle	output {outputs, 2, buffersize};
+
+            c74::min::sample_vector	result;
+            double					energy_in {};
+            double					energy_out {};
+
+            for (auto block = 0; block < 48; ++block) {
+                for (auto i = 0; i < buffersize; ++i) {
+                    auto t = block * buffersize + i;
+                    left[i] = 0.25 * sin(2.0 * M_PI * 440.0 * t / 48000.0);
+                    right[i] = left[i];
+                }
+                l(input, output);
+                if (block >= 24) {
+                    for (auto i = 0; i < buffersize; ++i) {
+                        energy_in += left[i] * left[i];
+                        energy_out += out_left[i] * out_left[i];
+                    }
+                }
+                REQUIRE( out_left == out_right );
+            }
+
+            THEN("The signal passes at the same level")
+            REQUIRE( energy_out == Approx(energy_in).epsilon(0.01) );
+        }
+    }
+}
+
+
+SCENARIO ("multiband limiter limits each band to its own threshold") {
+
+    GIVEN ("A 4-band, 1-channel multiband limiter with the lowest band limited to -6 dB") {
+        c74::min::lib::multiband_limiter<4>	l {1, 512, 48000.0};
+        const int							buffersize = 64;
+        c74::min::sample_vector				samples(buffersize);
+        c74::min::sample*					channels[] = {samples.data()};
+        c74::min::audio_bundle				bundle {channels, 1, buffersize};
+
+        l.threshold(0, -6.0);
+        l.release(0, 50.0);
+        l.ceiling(6.0);
+        REQUIRE( l.threshold(0) == -6.0 );
+        REQUIRE( l.latency() == 100 + 32 );
+
+        WHEN ("processing a loud bass tone") {
+            double peak {};
+
+            for (auto block = 0; block < 400; ++block) {
+                for (auto i = 0; i < buffersize; ++i)
+                    samples[i] = 2.0 * sin(2.0 * M_PI * 40.0 * (block * buffersize + i) / 48000.0);
+                l(bundle, bundle);
+                if (block >= 200) {
+                    for (auto x : samples)
+                        peak = std::max(peak, std::abs(x));
+                }
+            }
+
+            THEN("the output peaks at the threshold of the lowest band")
+            REQUIRE( peak == Approx(pow(10.0, -6.0 / 20.0)).epsilon(0.05) );
+        }
+    }
+}
+
+
+SCENARIO ("multiband limiter follows a change of samplerate") {
+
+    GIVEN ("A 4-band, 1-channel multiband limiter at 48 kHz") {
+        c74::min::lib::multiband_limiter<4>	l {1, 512, 48000.0};
+
+        l.frequency(2, 20000.0);
+        REQUIRE( l.frequency(2) == 20000.0 );
+
+        WHEN ("the samplerate is lowered to 32 kHz") {
+            l.samplerate(32000.0);
+
+            THEN("the crossovers are clamped below the new nyquist frequency")
+            REQUIRE( l.samplerate() == 32000.0 );
+            REQUIRE( l.frequency(2) == Approx(32000.0 * 0.49) );
+        }
+
+        WHEN ("a loud bass tone is processed at 96 kHz") {
+            const int				buffersize = 64;
+            c74::min::sample_vector	samples(buffersize);
+            c74::min::sample*		channels[] = {samples.data()};
+            c74::min::audio_bundle	bundle {channels, 1, buffersize};
+            double					peak {};
+
+            l.samplerate(96000.0);
+            l.threshold(0, -6.0);
+            l.ceiling(6.0);
+
+            for (auto block = 0; block < 800; ++block) {
+                for (auto i = 0; i < buffersize; ++i)
+                    samples[i] = 2.0 * sin(2.0 * M_PI * 40.0 * (block * buffersize + i) / 96000.0);
+                l(bundle, bundle);
+                if (block >= 400) {
+                    for (auto x : samples)
+                        peak = std::max(peak, std::abs(x));
+                }
+            }
+
+            THEN("the output still peaks at the threshold of the lowest band")
+            REQUIRE( peak == Approx(pow(10.0, -6.0 / 20.0)).epsilon(0.05) );
+        }
+    }
+}
+
+
+// Run a limiter over a loud two-channel signal and return the time taken in milliseconds.
+
+template<class limiter_type>
+double limit_time(limiter_type& l) {
+    const int				buffersize = 64;
+    c74::min::sample_vector	left(buffersize);
+    c74::min::sample_vector	right(buffersize);
+    c74::min::sample*		channels[] = {left.data(), right.data()};
+    c74::min::audio_bundle	bundle {channels, 2, buffersize};
+    const int				blocks = 4000;
+    c74::min::sample_vector	source(blocks * buffersize);
+    double					sum {};
+
+    for (auto t = 0; t < blocks * buffersize; ++t)
+        source[t] = 2.0 * sin(2.0 * M_PI * 110.0 * t / 48000.0) + 0.5 * sin(2.0 * M_PI * 3000.0 * t / 48000.0);
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto block = 0; block < blocks; ++block) {
+        std::copy_n(source.data() + block * buffersize, buffersize, left.data());
+        std::copy_n(source.data() + block * buffersize, buffersize, right.data());
+        l(bundle, bundle);
+        sum += left[0];
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    REQUIRE( std::isfinite(sum) );    // use the result so the loop is not optimized away
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+
+TEST_CASE ("benchmark of the multiband limiter against the single-band limiter", "[.benchmark]") {
+    c74::min::lib::limiter					single {2, 512, 48000.0};
+    c74::min::lib::multiband_limiter<4>		multiband {2, 512, 48000.0};
+
+    single.lookahead(100);
+    multiband.lookahead(100);
+
+    auto single_time    = limit_time(single);
+    auto multiband_time = limit_time(multiband);
+
+    std::cout << "256000 samples of 2 channels, lookahead 100:" << std::endl;
+    std::cout << "  limiter: " << single_time << " ms" << std::endl;
+    std::cout << "  multiband_limiter<4>: " << multiband_time << " ms, " << multiband_time / single_time << "x" << std::endl;
+}
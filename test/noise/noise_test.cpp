@@ -0,0 +1,189 @@
+/// @file
+///	@brief 		Unit test for the random number engine and noise generators
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#define CATCH_CONFIG_MAIN
+#include "c74_min_catch.h"
+
+#include <chrono>
+
+
+SCENARIO ("the random number engine is deterministic and uniform") {
+
+    GIVEN ("Two engines with the same seed") {
+        c74::min::lib::xoshiro a {42};
+        c74::min::lib::xoshiro b {42};
+
+        WHEN ("one is drawn one value at a time and the other a block at a time") {
+            c74::min::sample_vector scalar(1001);
+            c74::min::sample_vector block(1001);
+
+            for (auto& v : scalar)
+                v = a.bipolar();
+            b.fill(block.data(), 3);    // leave the engine part way through a round of its streams
+            b.fill(block.data() + 3, block.size() - 3);
+
+            THEN("the sequences are the same")
+            REQUIRE( scalar == block );
+        }
+    }
+
+    GIVEN ("Engines with different seeds") {
+        c74::min::lib::xoshiro a;
+        c74::min::lib::xoshiro b;
+        c74::min::lib::xoshiro c {0};
+
+        THEN("the sequences differ") {
+            auto same = 0;
+            for (auto i = 0; i < 1000; ++i) {
+                auto x = a();
+                same += (x == b()) + (x == c());
+            }
+            REQUIRE( same == 0 );
+        }
+    }
+
+    GIVEN ("Consecutive default seeds") {
+        // the splitmix64 expansion of xoshiro::seed()
+        auto expand = [](std::uint64_t seed) {
+            std::array<std::uint64_t, 4> state;
+            for (auto& s : state) {
+                seed += 0x9E3779B97F4A7C15ULL;
+                auto z = seed;
+                z      = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z      = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                s      = z ^ (z >> 31);
+            }
+            return state;
+        };
+
+        THEN("their expanded states share no words") {
+            auto previous = expand(c74::min::lib::xoshiro::unique_seed());
+            auto shared   = 0;
+            for (auto i = 0; i < 100; ++i) {
+                auto state = expand(c74::min::lib::xoshiro::unique_seed());
+                for (auto s : state)
+                    shared += std::count(previous.begin(), previous.end(), s);
+                previous = state;
+            }
+            REQUIRE( shared == 0 );
+        }
+    }
+
+    GIVEN ("A million bipolar values") {
+        c74::min::lib::xoshiro	engine {7};
+        c74::min::sample_vector	x(1000000);
+        engine.fill(x.data(), x.size());
+
+        THEN("they are in range with the mean and variance of a uniform distribution") {
+            double sum {};
+            double squares {};
+            auto   in_range = true;
+
+            for (auto v : x) {
+                sum += v;
+                squares += v * v;
+                in_range = in_range && v >= -1.0 && v < 1.0;
+            }
+            REQUIRE( in_range );
+            REQUIRE( sum / x.size() == Approx(0.0).margin(0.003) );
+            REQUIRE( squares / x.size() == Approx(1.0 / 3.0).margin(0.003) );
+        }
+    }
+}
+
+
+TEST_CASE ("the random number engine works with the standard distributions") {
+    c74::min::lib::xoshiro				engine {1};
+    std::uniform_int_distribution<int>	die {1, 6};
+    std::array<int, 7>					counts {};
+
+    for (auto i = 0; i < 60000; ++i)
+        ++counts[die(engine)];
+    for (auto face = 1; face <= 6; ++face)
+        REQUIRE( counts[face] == Approx(10000).margin(500) );
+
+    for (auto i = 0; i < 1000; ++i) {
+        auto u = engine.uniform(2.0, 3.0);
+        REQUIRE( u >= 2.0 );
+        REQUIRE( u < 3.0 );
+    }
+}
+
+
+// The mean power in each octave band of a noise generator, from the average spectrum of many 4096-point blocks at 48 kHz.
+// Band k spans [375 * 2^k, 750 * 2^k) hertz.
+
+template<class generator_type>
+std::vector<double> octave_power(generator_type& generator) {
+    const int					size = 4096;
+    const int					blocks = 200;
+    c74::min::lib::real_fft		transform {size};
+    c74::min::sample_vector		x(size);
+    c74::min::sample_vector		re(size / 2 + 1);
+    c74::min::sample_vector		im(size / 2 + 1);
+    std::vector<double>			power(5);
+
+    for (auto b = 0; b < blocks; ++b) {
+        generator.process(x.data(), size);
+        transform.forward(x.data(), re.data(), im.data());
+        for (auto k = 0; k < power.size(); ++k) {
+            for (auto bin = 32 << k; bin < 64 << k; ++bin)
+                power[k] += re[bin] * re[bin] + im[bin] * im[bin];
+        }
+    }
+    return power;
+}
+
+
+TEST_CASE ("noise generators have the expected spectral slopes") {
+    c74::min::lib::noise::white	white {1};
+    c74::min::lib::noise::pink	pink {2};
+    c74::min::lib::noise::brown	brown {3};
+
+    auto w = octave_power(white);
+    auto p = octave_power(pink);
+    auto b = octave_power(brown);
+
+    // white noise has equal power per hertz, so each octave has 3 dB more than the one below
+    // pink noise has equal power per octave, and brown noise 3 dB less in each octave
+    for (auto k = 1; k < w.size(); ++k) {
+        REQUIRE( 10.0 * log10(w[k] / w[k - 1]) == Approx(3.0).margin(0.5) );
+        REQUIRE( 10.0 * log10(p[k] / p[k - 1]) == Approx(0.0).margin(0.5) );
+        REQUIRE( 10.0 * log10(b[k] / b[k - 1]) == Approx(-3.0).margin(0.5) );
+    }
+}
+
+
+TEST_CASE ("noise generators produce the same output one sample or one block at a time") {
+    c74::min::lib::noise::pink	a {9};
+    c74::min::lib::noise::pink	b {9};
+    c74::min::sample_vector		block(512);
+
+    b.process(block.data(), block.size());
+    for (auto i = 0; i < block.size(); ++i)
+        REQUIRE( a() == block[i] );
+}
+
+
+TEST_CASE ("benchmark of random numbers", "[.benchmark]") {
+    const int				count = 100000;
+    c74::min::sample_vector	x(count);
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto& v : x)
+        v = c74::min::lib::math::random(-1.0, 1.0);
+    auto middle = std::chrono::steady_clock::now();
+
+    c74::min::lib::xoshiro engine;
+    engine.fill(x.data(), count);
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << count << " random numbers:" << std::endl;
+    std::cout << "  math::random():   " << std::chrono::duration<double, std::micro>(middle - start).count() << " us" << std::endl;
+    std::cout << "  xoshiro::fill():  " << std::chrono::duration<double, std::micro>(end - middle).count() << " us" << std::endl;
+
+    REQUIRE( x[count - 1] >= -1.0 );
+}
@@ -255,3 +255,76 @@ TEST_CASE ("Parameters are set properly with different constructors") {
     REQUIRE( o5.coefficient() == Approx(1.0) );	// check the initialized value
 
 }
+
+
+SCENARIO ("a onepole_bank matches independent onepole filters") {
+
+    GIVEN ("A bank of 6 filters with different coefficients and 6 onepole instances") {
+        c74::min::lib::onepole_bank<6>			bank;
+        std::vector<c74::min::lib::onepole>		filters(6);
+
+        for (auto c = 0; c < 6; ++c) {
+            bank.coefficient(c, 0.1 * (c + 1));
+            filters[c].coefficient(0.1 * (c + 1));
+        }
+        REQUIRE( bank.coefficient(3) == Approx(0.4) );
+
+        WHEN ("processing interleaved noise") {
+            const int				frames = 256;
+            c74::min::sample_vector	x(frames * 6);
+            for (auto& v : x)
+                v = c74::min::lib::math::random(-1.0, 1.0);
+
+            c74::min::sample_vector	y(frames * 6);
+            bank.process(x.data(), y.data(), frames);
+
+            THEN("every channel matches its scalar filter") {
+                for (auto i = 0; i < frames; ++i)
+                    for (auto c = 0; c < 6; ++c)
+                        REQUIRE( y[i * 6 + c] == Approx(filters[c](x[i * 6 + c])).margin(1e-15) );
+                for (auto c = 0; c < 6; ++c)
+                    REQUIRE( bank.history(c) == Approx(filters[c].history()).margin(1e-15) );
+            }
+        }
+        AND_WHEN ("processing a single frame") {
+            auto y = bank({1.0, 1.0, 1.0, 1.0, 1.0, 1.0});
+            THEN("each channel produces its first impulse response sample") {
+                REQUIRE( y[0] == Approx(0.9) );
+                REQUIRE( y[5] == Approx(0.4) );
+            }
+        }
+    }
+}
+
+
+SCENARIO ("rendering offline on several threads matches sequential processing") {
+
+    GIVEN ("Two identical onepole filters with some history") {
+        c74::min::lib::onepole	sequential {0.999};
+        c74::min::lib::onepole	parallel {0.999};
+
+        sequential(0.5);
+        parallel(0.5);
+
+        WHEN ("filtering a million samples of noise, in place for the parallel render") {
+            const int				frames = 1000000;
+            c74::min::sample_vector	x(frames);
+            for (auto& v : x)
+                v = c74::min::lib::math::random(-1.0, 1.0);
+
+            c74::min::sample_vector	reference(frames);
+            c74::min::sample_vector	y = x;
+
+            sequential.process(x.data(), reference.data(), frames);
+            parallel.render(y.data(), y.data(), frames, 4);
+
+            THEN("the outputs and histories match to within rounding") {
+                auto matches = true;
+                for (auto i = 0; i < frames; ++i)
+                    matches = matches && (std::abs(y[i] - reference[i]) < 1e-12);
+                REQUIRE( matches );
+                REQUIRE( parallel.history() == Approx(sequential.history()).margin(1e-12) );
+            }
+        }
+    }
+}
@@ -0,0 +1,97 @@
+/// @file
+///	@brief 		Unit test for the oversampler class
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#define CATCH_CONFIG_MAIN
+#include "c74_min_catch.h"
+
+
+// Pass a sine through an oversampler without processing and compare with the sine delayed by the reported latency.
+
+template<int factor>
+void check_transparent() {
+    c74::min::lib::oversampler<factor>	o;
+    const int							frames = 4096;
+    const double						w = 2.0 * M_PI * 1000.0 / 48000.0;
+    c74::min::sample_vector				x(frames);
+
+    for (auto i = 0; i < frames; ++i)
+        x[i] = sin(w * i);
+
+    o.process(x.data(), x.data(), frames, [](c74::min::sample v) { return v; });
+
+    auto latency = o.latency();
+    auto matches = true;
+    for (auto i = 1000; i < frames; ++i)
+        matches = matches && std::abs(x[i] - sin(w * (i - latency))) < 1e-3;
+    REQUIRE( matches );
+}
+
+
+TEST_CASE ("oversampling without processing only delays the signal") {
+    SECTION("2x")
+    check_transparent<2>();
+    SECTION("4x")
+    check_transparent<4>();
+    SECTION("8x")
+    check_transparent<8>();
+
+    REQUIRE( c74::min::lib::oversampler<2>().latency() == 31.0 );
+    REQUIRE( c74::min::lib::oversampler<4>().latency() == 36.5 );
+}
+
+
+// Energy below 20 kHz in the spectrum of the last 4096 samples that does not fall on a harmonic, relative to the total.
+// Aliases that fold back into the transition band of the half-band filters are not counted.
+
+double alias_ratio(const c74::min::sample_vector& y, int fundamental_bin) {
+    const int							size = 4096;
+    c74::min::lib::real_fft				transform {size};
+    c74::min::sample_vector				re(size / 2 + 1);
+    c74::min::sample_vector				im(size / 2 + 1);
+
+    transform.forward(y.data() + y.size() - size, re.data(), im.data());
+
+    double harmonics {};
+    double total {};
+    for (auto k = 1; k <= size * 20 / 48; ++k) {
+        auto energy = re[k] * re[k] + im[k] * im[k];
+        total += energy;
+        if (k % fundamental_bin == 0)
+            harmonics += energy;
+    }
+    return (total - harmonics) / total;
+}
+
+
+SCENARIO ("oversampling reduces the aliasing of saturation") {
+
+    GIVEN ("A heavily driven saturation and a sine at 5.1 kHz") {
+        c74::min::lib::saturation	shaper;
+        shaper.drive(95.0);
+
+        const int					frames = 16384;
+        const int					bin = 437;    // an exact bin of a 4096-point transform
+        c74::min::sample_vector		x(frames);
+        for (auto i = 0; i < frames; ++i)
+            x[i] = 0.9 * sin(2.0 * M_PI * bin * i / 4096.0);
+
+        WHEN ("processed at the base rate and oversampled by 4") {
+            c74::min::sample_vector naive(frames);
+            for (auto i = 0; i < frames; ++i)
+                naive[i] = shaper(x[i]);
+
+            c74::min::lib::oversampler<4>	o;
+            c74::min::sample_vector			oversampled(frames);
+            o.process(x.data(), oversampled.data(), frames, shaper);
+
+            THEN("the aliased energy is reduced by more than 40 dB") {
+                auto before = alias_ratio(naive, bin);
+                auto after  = alias_ratio(oversampled, bin);
+                REQUIRE( 10.0 * log10(after / before) < -40.0 );
+            }
+        }
+    }
+}
@@ -0,0 +1,167 @@
+/// @file
+///	@brief 		Unit test for the parameter hand-off classes
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#define CATCH_CONFIG_MAIN
+#include "c74_min_catch.h"
+
+#include <thread>
+
+
+struct test_coefficients {
+    double a {0.0};
+    double b {0.0};
+};
+
+
+SCENARIO ("snapshot hands the latest value to the reader") {
+
+    GIVEN ("A snapshot with an initial value") {
+        c74::min::lib::snapshot<test_coefficients>	s {{1.0, -1.0}};
+        test_coefficients							c {};
+
+        THEN("Nothing is read before the first write")
+        REQUIRE( s.read(c) == false );
+
+        WHEN ("a value is written") {
+            s.write({2.0, -2.0});
+            THEN("it is read exactly once") {
+                REQUIRE( s.read(c) == true );
+                REQUIRE( c.a == 2.0 );
+                REQUIRE( c.b == -2.0 );
+                REQUIRE( s.read(c) == false );
+            }
+        }
+        AND_WHEN ("several values are written before a read") {
+            s.write({3.0, -3.0});
+            s.write({4.0, -4.0});
+            s.write({5.0, -5.0});
+            THEN("only the most recent value is read") {
+                REQUIRE( s.read(c) == true );
+                REQUIRE( c.a == 5.0 );
+                REQUIRE( s.read(c) == false );
+            }
+        }
+    }
+}
+
+
+TEST_CASE ("snapshot values are never torn when written from another thread") {
+    c74::min::lib::snapshot<test_coefficients>	s;
+    const int									count = 100000;
+
+    std::thread writer([&s]() {
+        for (auto i = 1; i <= count; ++i)
+            s.write({double(i), double(-i)});
+    });
+
+    test_coefficients	c {};
+    double				previous {0.0};
+    bool				consistent {true};
+    bool				ordered {true};
+
+    while (c.a < count) {
+        if (s.read(c)) {
+            consistent = consistent && (c.a == -c.b);
+            ordered = ordered && (c.a > previous);
+            previous = c.a;
+        }
+    }
+    writer.join();
+
+    REQUIRE( consistent );
+    REQUIRE( ordered );
+}
+
+
+SCENARIO ("snapshot hands a vector to the reader in place") {
+
+    GIVEN ("A snapshot of a vector") {
+        c74::min::lib::snapshot<std::vector<int>>	s {{0, 0, 0}};
+
+        THEN("The initial value is current before the first write") {
+            REQUIRE( s.update() == false );
+            REQUIRE( s.current() == std::vector<int> {0, 0, 0} );
+        }
+
+        WHEN ("values are written") {
+            s.write({1, 2, 3});
+            REQUIRE( s.update() == true );
+            const auto* first = s.current().data();
+            REQUIRE( s.current() == std::vector<int> {1, 2, 3} );
+
+            s.write({4, 5, 6});
+            s.write({7, 8, 9});
+
+            THEN("the current value only changes on update, and only to the most recent value") {
+                REQUIRE( s.current().data() == first );
+                REQUIRE( s.current() == std::vector<int> {1, 2, 3} );
+                REQUIRE( s.update() == true );
+                REQUIRE( s.current() == std::vector<int> {7, 8, 9} );
+                REQUIRE( s.update() == false );
+                REQUIRE( s.current() == std::vector<int> {7, 8, 9} );
+            }
+        }
+    }
+}
+
+
+SCENARIO ("parameter_queue delivers changes at their sample offsets") {
+
+    GIVEN ("A parameter_queue with a capacity of 4 events") {
+        c74::min::lib::parameter_queue<double, 4>			q;
+        c74::min::lib::parameter_queue<double, 4>::event	e;
+
+        REQUIRE( q.empty() );
+        REQUIRE( q.next_offset(64) == 64 );
+
+        WHEN ("changes are posted for offsets 0, 10 and 80") {
+            REQUIRE( q.post(0.25, 0) );
+            REQUIRE( q.post(0.5, 10) );
+            REQUIRE( q.post(0.75, 80) );
+
+            THEN("changes are only popped when due, in order") {
+                REQUIRE( q.pop(0, e) );
+                REQUIRE( e.value == 0.25 );
+                REQUIRE( q.next_offset(64) == 10 );
+                REQUIRE( q.pop(9, e) == false );
+                REQUIRE( q.pop(10, e) );
+                REQUIRE( e.value == 0.5 );
+                REQUIRE( q.next_offset(64) == 64 );
+                REQUIRE( q.pop(63, e) == false );
+                REQUIRE( q.pop(80, e) );
+                REQUIRE( e.value == 0.75 );
+                REQUIRE( q.empty() );
+            }
+        }
+        AND_WHEN ("the queue is filled to capacity") {
+            REQUIRE( q.post(1.0) );
+            REQUIRE( q.post(2.0) );
+            REQUIRE( q.post(3.0) );
+            REQUIRE( q.post(4.0) );
+            THEN("further changes are refused") {
+                REQUIRE( q.post(5.0) == false );
+                REQUIRE( q.pop(0, e) );
+                REQUIRE( e.value == 1.0 );
+                REQUIRE( q.post(5.0) );
+            }
+        }
+    }
+}
+
+
+TEST_CASE ("onepole coefficient is a consistent pair") {
+    c74::min::lib::onepole	f;
+
+    f.coefficient(0.25);
+    REQUIRE( f.coefficient() == 0.25 );
+
+    auto y = f(1.0);
+    REQUIRE( y == 0.75 );
+
+    c74::min::lib::onepole	g {f};
+    REQUIRE( g.coefficient() == 0.25 );
+    REQUIRE( g.history() == 0.75 );
+}
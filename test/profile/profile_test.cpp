@@ -0,0 +1,130 @@
+/// @file
+///	@brief 		Unit test for the profiling of processors
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#define MIN_LIB_PROFILE 1
+#define CATCH_CONFIG_MAIN
+#include "c74_min_catch.h"
+
+#include <sstream>
+
+
+TEST_CASE ("Profiled processors count their calls, frames and cycles") {
+    using namespace c74::min;
+    using namespace c74::min::lib;
+
+    profile::prepare_thread();
+
+    profiled<delay>			my_delay {{100, 10}};
+    profiled<allpass>		my_allpass {{100, 10}, 0.5};
+    profiled<oscillator<>>	my_oscillator;
+    profiled<adsr>			my_adsr;
+
+    my_delay.name("delay");
+    my_allpass.name("allpass");
+    my_oscillator.name("oscillator");
+    my_adsr.name("adsr");
+
+    INFO ("The wrapper passes the configuration through to the processor");
+    REQUIRE( my_delay.size() == 10 );
+    my_oscillator.frequency(440.0, 48000.0);
+
+    sample y {};
+    for (auto i = 0; i < 64; ++i) {
+        y += my_delay(1.0);
+        y += my_allpass(1.0);
+        y += my_oscillator();
+    }
+
+    sample_vector output(64);
+    my_adsr.trigger(true);
+    my_adsr.process(output.data(), output.size());
+    my_adsr.process(output.data(), 32);
+
+    REQUIRE( std::isfinite(y) );
+    REQUIRE( my_delay.statistics().calls() == 64 );
+    REQUIRE( my_delay.statistics().frames() == 64 );
+    REQUIRE( my_oscillator.statistics().calls() == 64 );
+    REQUIRE( my_adsr.statistics().calls() == 2 );
+    REQUIRE( my_adsr.statistics().frames() == 96 );
+
+    INFO ("The cycles add up, and the histogram counts every call");
+    const auto& stats = my_allpass.statistics();
+    REQUIRE( stats.cycles() > 0 );
+    REQUIRE( stats.worst() <= stats.cycles() );
+    REQUIRE( stats.worst() >= stats.cycles_per_call() );
+
+    std::uint64_t histogram_calls {};
+    for (auto bin = 0; bin < profile::statistics::k_bin_count; ++bin)
+        histogram_calls += stats.histogram(bin);
+    REQUIRE( histogram_calls == 64 );
+}
+
+
+TEST_CASE ("Profiled processors take the frame count from their audio bundles") {
+    using namespace c74::min;
+    using namespace c74::min::lib;
+
+    profiled<limiter>	my_limiter {2, 512, 48000.0};
+    sample_vector		left(64), right(64);
+    double*				pointers[] = {left.data(), right.data()};
+    audio_bundle		bundle {pointers, 2, 64};
+
+    my_limiter(bundle, bundle);
+    my_limiter(bundle, bundle, bundle);
+
+    REQUIRE( my_limiter.statistics().calls() == 2 );
+    REQUIRE( my_limiter.statistics().frames() == 128 );
+}
+
+
+TEST_CASE ("The profile is exported as JSON and as a Chrome trace") {
+    using namespace c74::min;
+    using namespace c74::min::lib;
+
+    {
+        std::ostringstream discard;
+        profile::write_chrome_trace(discard);    // drop the events of the other test cases
+    }
+
+    profiled<delay>	my_delay;
+    my_delay.name("my \"delay\"");
+
+    for (auto i = 0; i < 10; ++i)
+        my_delay(0.0);
+
+    std::ostringstream json;
+    profile::write_json(json);
+    REQUIRE( json.str().find("{\"name\": \"my \\\"delay\\\"\", \"calls\": 10, \"frames\": 10,") != std::string::npos );
+
+    std::ostringstream trace;
+    profile::write_chrome_trace(trace);
+    auto text = trace.str();
+    REQUIRE( text.find("{\"traceEvents\": [") == 0 );
+
+    auto events = 0;
+    for (auto position = text.find("\"ph\": \"X\""); position != std::string::npos; position = text.find("\"ph\": \"X\"", position + 1))
+        ++events;
+    REQUIRE( events == 10 );
+
+    INFO ("Events are exported once");
+    std::ostringstream again;
+    profile::write_chrome_trace(again);
+    REQUIRE( again.str().find("\"ph\"") == std::string::npos );
+}
+
+
+TEST_CASE ("Processors that go away leave the profile") {
+    using namespace c74::min::lib;
+
+    {
+        profiled<dcblocker> my_dcblocker;
+        my_dcblocker.name("transient");
+    }
+
+    std::ostringstream json;
+    profile::write_json(json);
+    REQUIRE( json.str().find("transient") == std::string::npos );
+}
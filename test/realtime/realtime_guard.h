@@ -0,0 +1,294 @@
+/// @file
+///	@brief 		Detection of operations that are not real-time safe, for unit tests
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+///
+///	Including this header replaces the global allocation functions of the test program, and on Linux with glibc
+///	also malloc and friends, pthread mutex locking, condition variable signalling
+///	and the sources of OS entropy that std::random_device reads.
+///	While a realtime::scope is alive on a thread, any of those calls on that thread is counted as a violation
+///	and reported on stderr with a stack trace.
+///
+///	With libstdc++ the construction and use of std::random_device are also detected directly,
+///	since it may use the RDRAND instruction rather than make a call to the OS.
+///
+///	Include it in exactly one translation unit of a test program, since it defines the replacement functions.
+
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <unistd.h>
+#define MIN_LIB_REALTIME_INTERPOSE 1
+
+extern "C" void* __libc_malloc(std::size_t);
+extern "C" void* __libc_calloc(std::size_t, std::size_t);
+extern "C" void* __libc_realloc(void*, std::size_t);
+extern "C" void* __libc_memalign(std::size_t, std::size_t);
+extern "C" void  __libc_free(void*);
+#endif
+
+
+namespace realtime {
+
+    inline thread_local int		armed		{};		// the number of scopes alive on this thread
+    inline thread_local bool	reporting	{};		// true while reporting, so that the report itself is not checked
+    inline thread_local bool	quiet		{};		// true to count violations without reporting them
+    inline std::atomic<int>		violations	{};		// the number of violations on all threads since the program started
+
+
+    /// Count and report a call that is not real-time safe, if a scope is alive on this thread.
+    /// @param	what	The name of the call.
+
+    inline void violation(const char* what) {
+        if (!armed || reporting)
+            return;
+
+        ++violations;
+        if (quiet)
+            return;
+
+        reporting = true;
+        std::fprintf(stderr, "real-time violation: %s\n", what);
+#if defined(MIN_LIB_REALTIME_INTERPOSE)
+        void* frames[32];
+        auto  frame_count = backtrace(frames, 32);
+        backtrace_symbols_fd(frames, frame_count, STDERR_FILENO);
+#endif
+        reporting = false;
+    }
+
+
+    /// Check the calls made on this thread for as long as the scope is alive.
+    /// Create it around the operator() or process() calls of a processor, and require that violations() is zero.
+
+    class scope {
+    public:
+        /// Start checking.
+        /// @param	report	False to only count the violations, e.g. when they are expected.
+
+        explicit scope(bool report = true) {
+            m_start   = realtime::violations;
+            m_quiet   = quiet;
+            quiet     = !report;
+            ++armed;
+        }
+
+        ~scope() {
+            --armed;
+            quiet = m_quiet;
+        }
+
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+
+
+        /// Return the number of violations since the scope was created.
+        /// @return	The number of violations.
+
+        int violations() const {
+            return realtime::violations - m_start;
+        }
+
+    private:
+        int		m_start;
+        bool	m_quiet;
+    };
+
+
+#if defined(MIN_LIB_REALTIME_INTERPOSE)
+
+    /// Look up the next definition of a function, i.e. the one in the C library, on first use.
+    /// The cache is a constant-initialized atomic rather than a function-local static,
+    /// whose initialization would take a lock inside the very functions that are replaced here.
+
+    template<class function_type>
+    function_type next(std::atomic<function_type>& cache, const char* name) {
+        auto f = cache.load(std::memory_order_acquire);
+        if (!f) {
+            auto was_reporting = reporting;
+            reporting = true;    // dlsym may allocate on first use
+            f = reinterpret_cast<function_type>(dlsym(RTLD_NEXT, name));
+            reporting = was_reporting;
+            cache.store(f, std::memory_order_release);
+        }
+        return f;
+    }
+
+
+    /// Load what backtrace() needs before any scope exists, since it allocates on its first use.
+
+    inline const bool preloaded = [] {
+        void* frames[1];
+        return backtrace(frames, 1) >= 0;
+    }();
+
+#endif
+}    // namespace realtime
+
+
+// The allocation functions of the C++ library
+
+#if defined(MIN_LIB_REALTIME_INTERPOSE)
+#define MIN_LIB_REALTIME_ALLOCATE(size) __libc_malloc(size)
+#define MIN_LIB_REALTIME_FREE(p) __libc_free(p)
+#else
+#define MIN_LIB_REALTIME_ALLOCATE(size) std::malloc(size)
+#define MIN_LIB_REALTIME_FREE(p) std::free(p)
+#endif
+
+void* operator new(std::size_t size) {
+    realtime::violation("operator new");
+    if (auto p = MIN_LIB_REALTIME_ALLOCATE(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    realtime::violation("operator new");
+    return MIN_LIB_REALTIME_ALLOCATE(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept {
+    if (p)
+        realtime::violation("operator delete");
+    MIN_LIB_REALTIME_FREE(p);
+}
+
+void operator delete[](void* p) noexcept {
+    operator delete(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    operator delete(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    operator delete(p);
+}
+
+
+// The C library
+
+#if defined(MIN_LIB_REALTIME_INTERPOSE)
+
+extern "C" {
+
+void* malloc(std::size_t size) noexcept {
+    realtime::violation("malloc");
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size) noexcept {
+    realtime::violation("calloc");
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* p, std::size_t size) noexcept {
+    realtime::violation("realloc");
+    return __libc_realloc(p, size);
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept {
+    realtime::violation("aligned_alloc");
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** p, std::size_t alignment, std::size_t size) noexcept {
+    realtime::violation("posix_memalign");
+    *p = __libc_memalign(alignment, size);
+    return *p ? 0 : ENOMEM;
+}
+
+void free(void* p) noexcept {
+    if (p)
+        realtime::violation("free");
+    __libc_free(p);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept {
+    static std::atomic<int (*)(pthread_mutex_t*)> next {};
+    realtime::violation("pthread_mutex_lock");
+    return realtime::next(next, "pthread_mutex_lock")(mutex);
+}
+
+int pthread_mutex_trylock(pthread_mutex_t* mutex) noexcept {
+    static std::atomic<int (*)(pthread_mutex_t*)> next {};
+    realtime::violation("pthread_mutex_trylock");
+    return realtime::next(next, "pthread_mutex_trylock")(mutex);
+}
+
+int pthread_cond_signal(pthread_cond_t* condition) noexcept {
+    static std::atomic<int (*)(pthread_cond_t*)> next {};
+    realtime::violation("pthread_cond_signal");
+    return realtime::next(next, "pthread_cond_signal")(condition);
+}
+
+int pthread_cond_broadcast(pthread_cond_t* condition) noexcept {
+    static std::atomic<int (*)(pthread_cond_t*)> next {};
+    realtime::violation("pthread_cond_broadcast");
+    return realtime::next(next, "pthread_cond_broadcast")(condition);
+}
+
+ssize_t getrandom(void* buffer, std::size_t length, unsigned int flags) {
+    static std::atomic<ssize_t (*)(void*, std::size_t, unsigned int)> next {};
+    realtime::violation("getrandom");
+    return realtime::next(next, "getrandom")(buffer, length, flags);
+}
+
+int getentropy(void* buffer, std::size_t length) {
+    static std::atomic<int (*)(void*, std::size_t)> next {};
+    realtime::violation("getentropy");
+    return realtime::next(next, "getentropy")(buffer, length);
+}
+
+}    // extern "C"
+
+
+// The entry points of std::random_device in libstdc++, which its inline constructor and operator() call
+// whatever the source of entropy, including the RDRAND instruction that none of the checks above can see.
+// They are declared by their mangled names, for the library built with the C++11 ABI.
+
+#if defined(__GLIBCXX__) && _GLIBCXX_USE_CXX11_ABI
+#define MIN_LIB_REALTIME_RANDOM_DEVICE_INIT "_ZNSt13random_device7_M_initERKNSt7__cxx1112basic_stringIcSt11char_traitsIcESaIcEEE"
+#define MIN_LIB_REALTIME_RANDOM_DEVICE_GETVAL "_ZNSt13random_device9_M_getvalEv"
+
+namespace realtime {
+
+    void random_device_init(void* device, const void* token) __asm__(MIN_LIB_REALTIME_RANDOM_DEVICE_INIT);
+    unsigned int random_device_getval(void* device) __asm__(MIN_LIB_REALTIME_RANDOM_DEVICE_GETVAL);
+
+    void random_device_init(void* device, const void* token) {
+        static std::atomic<void (*)(void*, const void*)> next {};
+        violation("std::random_device::random_device");
+        realtime::next(next, MIN_LIB_REALTIME_RANDOM_DEVICE_INIT)(device, token);
+    }
+
+    unsigned int random_device_getval(void* device) {
+        static std::atomic<unsigned int (*)(void*)> next {};
+        violation("std::random_device::operator()");
+        return realtime::next(next, MIN_LIB_REALTIME_RANDOM_DEVICE_GETVAL)(device);
+    }
+
+}    // namespace realtime
+#endif
+
+#endif
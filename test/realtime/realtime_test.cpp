@@ -0,0 +1,281 @@
+/// @file
+///	@brief 		Unit test for the real-time safety of the processors
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#define CATCH_CONFIG_MAIN
+#include "c74_min_catch.h"
+#include "realtime_guard.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+
+
+// Every processor is created and configured outside of the scope, then runs several vectors inside it,
+// including the first one, which is where lazy initialization would show up.
+
+constexpr int	k_frames	= 64;
+constexpr int	k_vectors	= 8;
+
+
+// A test signal, with silence at the end so that feedback paths decay toward denormals.
+
+c74::min::sample_vector make_input(int channel = 0, int frames = k_frames) {
+    c74::min::sample_vector input(frames);
+    for (auto i = 0; i < frames; ++i)
+        input[i] = i < frames / 2 ? std::sin(0.1 * i + channel) : 0.0;
+    return input;
+}
+
+
+// Run a function once per vector inside a scope, and return the number of violations, which are reported unless report is false.
+
+template<class function_type>
+int violations(function_type&& function, bool report = true) {
+    realtime::scope scope {report};
+    for (auto v = 0; v < k_vectors; ++v)
+        function();
+    return scope.violations();
+}
+
+
+// A bundle of channels that owns its samples.
+
+struct channels {
+    explicit channels(int count, int frames = k_frames)
+    : samples(count, make_input(0, frames))
+    , pointers(count) {
+        for (auto c = 0; c < count; ++c)
+            pointers[c] = samples[c].data();
+    }
+
+    c74::min::audio_bundle bundle() {
+        return {pointers.data(), static_cast<long>(pointers.size()), static_cast<long>(samples[0].size())};
+    }
+
+    std::vector<c74::min::sample_vector>	samples;
+    std::vector<double*>					pointers;
+};
+
+
+TEST_CASE ("The real-time guard detects allocation, locking, signalling and random devices") {
+    std::mutex				mutex;
+    std::condition_variable	condition;
+
+    REQUIRE( violations([] { c74::min::sample_vector v(16); }, false) > 0 );
+    REQUIRE( violations([&mutex] { std::lock_guard<std::mutex> lock {mutex}; }, false) > 0 );
+    REQUIRE( violations([&condition] { condition.notify_one(); }, false) > 0 );
+    REQUIRE( violations([] { auto p = std::malloc(16); std::free(p); }, false) > 0 );
+#if defined(MIN_LIB_REALTIME_RANDOM_DEVICE_INIT)
+    REQUIRE( violations([] { std::random_device device; }, false) > 0 );
+    std::random_device device;
+    REQUIRE( violations([&device] { device(); }, false) > 0 );
+#endif
+    REQUIRE( violations([] {}) == 0 );
+}
+
+
+TEST_CASE ("Calls that are only safe after their first use or once constructed") {
+    using namespace c74::min::lib;
+
+#if defined(MIN_LIB_REALTIME_RANDOM_DEVICE_INIT)
+    SECTION ("math::random seeds a generator from std::random_device on its first call on each thread") {
+        auto first = 0;
+        auto later = 0;
+        std::thread thread {[&] {
+            first = violations([] { math::random(0.0, 1.0); }, false);
+            later = violations([] { math::random(0.0, 1.0); });
+        }};
+        thread.join();
+        REQUIRE( first > 0 );
+        REQUIRE( later == 0 );
+    }
+#endif
+    SECTION ("interpolator::proxy allocates when it is constructed but not when it is used") {
+        std::optional<interpolator::proxy<>> proxy;
+        REQUIRE( violations([&] { if (!proxy) proxy.emplace(interpolator::type::cubic); }, false) > 0 );
+
+        c74::min::sample y {};
+        REQUIRE( violations([&] { proxy->change_interpolation(interpolator::type::hermite); y += (*proxy)(0.0, 1.0, 0.5, 0.2, 0.3); }) == 0 );
+        REQUIRE( std::isfinite(y) );
+    }
+    SECTION ("limiters process vectors larger than any before without growing") {
+        limiter				l {2, 512, 48000.0};
+        multiband_limiter	m {2, 512, 48000.0};
+        channels			small_in {2, 16};
+        channels			small_out {2, 16};
+        channels			large_in {2, 4096};
+        channels			large_out {2, 4096};
+        REQUIRE( violations([&] {
+            l(small_in.bundle(), small_out.bundle());
+            l(large_in.bundle(), large_out.bundle());
+            m(small_in.bundle(), small_out.bundle());
+            m(large_in.bundle(), large_out.bundle());
+        }) == 0 );
+    }
+}
+
+
+TEST_CASE ("Sample-by-sample processors are real-time safe") {
+    using namespace c74::min::lib;
+    auto input = make_input();
+    c74::min::sample y {};
+
+    SECTION ("adsr") {
+        adsr env;
+        env.attack(1.0, 48000.0);
+        env.decay(1.0, 48000.0);
+        env.release(1.0, 48000.0);
+        env.attack_curve(30.0);
+        REQUIRE( violations([&] { env.trigger(true); for (auto i = 0; i < k_frames; ++i) y += env(); env.trigger(false); }) == 0 );
+    }
+    SECTION ("allpass") {
+        allpass f {{100, 10}, 0.5};
+        REQUIRE( violations([&] { for (auto x : input) y += f(x); }) == 0 );
+    }
+    SECTION ("biquad") {
+        biquad f {filters::lowpass(1000.0, 0.7, 48000.0)};
+        REQUIRE( violations([&] { for (auto x : input) y += f(x); }) == 0 );
+    }
+    SECTION ("dcblocker") {
+        dcblocker f;
+        REQUIRE( violations([&] { for (auto x : input) y += f(x); }) == 0 );
+    }
+    SECTION ("delay") {
+        delay d {{100, 10}};
+        d.change_interpolation(interpolator::type::cubic);
+        REQUIRE( violations([&] { for (auto x : input) y += d(x); d.clear(); }) == 0 );
+    }
+    SECTION ("linkwitz_riley") {
+        linkwitz_riley f;
+        f.frequency(1000.0, 48000.0);
+        REQUIRE( violations([&] { c74::min::sample low {}, high {}; for (auto x : input) f(x, low, high); y += low; }) == 0 );
+    }
+    SECTION ("onepole") {
+        onepole f {0.2};
+        REQUIRE( violations([&] { for (auto x : input) y += f(x); }) == 0 );
+    }
+    SECTION ("oscillator") {
+        oscillator<> osc;
+        osc.frequency(440.0, 48000.0);
+        REQUIRE( violations([&] { for (auto i = 0; i < k_frames; ++i) y += osc(); }) == 0 );
+    }
+    SECTION ("saturation") {
+        saturation s;
+        s.drive(50.0);
+        REQUIRE( violations([&] { for (auto x : input) y += s(x); }) == 0 );
+    }
+    SECTION ("sync") {
+        c74::min::lib::sync s;
+        s.frequency(440.0, 48000.0);
+        REQUIRE( violations([&] { for (auto i = 0; i < k_frames; ++i) y += s(); }) == 0 );
+    }
+    SECTION ("easing") {
+        easing::table<> table {easing::function::in_elastic};
+        easing::ramp ramp;
+        ramp.function(easing::function::out_bounce);
+        ramp.control_rate(16, interpolator::type::spline);
+        REQUIRE( violations([&] { for (auto x : input) y += table(x) + easing::apply(easing::function::in_out_back, x); ramp.start(0.0, 1.0, 100); for (auto i = 0; i < k_frames; ++i) y += ramp(); }) == 0 );
+    }
+    SECTION ("noise") {
+        noise::pink p {1};
+        xoshiro random {2};
+        REQUIRE( violations([&] { for (auto i = 0; i < k_frames; ++i) y += p() + random.uniform(); }) == 0 );
+    }
+    REQUIRE( std::isfinite(y) );
+}
+
+
+TEST_CASE ("Vector processors are real-time safe") {
+    using namespace c74::min::lib;
+    auto					input = make_input();
+    c74::min::sample_vector	output(k_frames);
+
+    SECTION ("adsr") {
+        adsr env;
+        env.control_rate(16);
+        REQUIRE( violations([&] { env.trigger(true); env.process(output.data(), k_frames); env.trigger(false); env.process(output.data(), k_frames); }) == 0 );
+    }
+    SECTION ("adsr_bank") {
+        adsr_bank bank {4};
+        channels out {4};
+        REQUIRE( violations([&] { bank.trigger(1, true); bank(out.bundle()); bank.trigger(1, false); bank(out.bundle()); }) == 0 );
+    }
+    SECTION ("biquad") {
+        biquad f {filters::highpass(100.0, 0.7, 48000.0)};
+        REQUIRE( violations([&] { f.process(input.data(), output.data(), k_frames); }) == 0 );
+    }
+    SECTION ("convolver") {
+        c74::min::sample_vector impulse_response(1000, 0.001);
+        convolver c {impulse_response, k_frames};
+        REQUIRE( violations([&] { c.process(input.data(), output.data(), k_frames); }) == 0 );
+    }
+    SECTION ("convolver with a background thread") {
+        c74::min::sample_vector impulse_response(20000, 0.001);
+        convolver c {impulse_response, k_frames, true, 256};
+        REQUIRE( c.stage_count() > 1 );
+        REQUIRE( violations([&] { for (auto i = 0; i < 16; ++i) c.process(input.data(), output.data(), k_frames); c.clear(); }) == 0 );
+    }
+    SECTION ("dcblocker_bank") {
+        dcblocker_bank<2> f;
+        c74::min::sample_vector frames(2 * k_frames);
+        REQUIRE( violations([&] { f.process(frames.data(), frames.data(), k_frames); }) == 0 );
+    }
+    SECTION ("easing") {
+        easing::table<> table {easing::function::out_elastic};
+        REQUIRE( violations([&] { easing::apply<math::fast>(easing::function::in_out_sine, input.data(), output.data(), k_frames); table(input.data(), output.data(), k_frames); }) == 0 );
+    }
+    SECTION ("limiter") {
+        limiter l {2, 512, 48000.0};
+        channels in {2};
+        channels side {2};
+        channels out {2};
+        l.preamp(12.0);
+        REQUIRE( violations([&] { l(in.bundle(), out.bundle()); l(in.bundle(), side.bundle(), out.bundle()); }) == 0 );
+        l.groups({1, 0});
+        l.link(limiter::link_mode::grouped);    // picked up by the audio thread inside the scope
+        REQUIRE( violations([&] { l(in.bundle(), out.bundle()); }) == 0 );
+    }
+    SECTION ("loudness_meter") {
+        loudness_meter m {2, 48000.0, k_frames};
+        channels in {2};
+        REQUIRE( violations([&] { m(in.bundle()); }) == 0 );
+    }
+    SECTION ("multiband_limiter") {
+        multiband_limiter l {2, 512, 48000.0};
+        channels in {2};
+        channels out {2};
+        REQUIRE( violations([&] { l(in.bundle(), out.bundle()); }) == 0 );
+    }
+    SECTION ("noise") {
+        noise::brown b {3};
+        REQUIRE( violations([&] { b.process(output.data(), k_frames); }) == 0 );
+    }
+    SECTION ("onepole_bank") {
+        onepole_bank<4> f;
+        channels in {4};
+        channels out {4};
+        REQUIRE( violations([&] { f(in.bundle(), out.bundle()); }) == 0 );
+    }
+    SECTION ("oversampler") {
+        oversampler<4> o {k_frames};
+        saturation s;
+        s.drive(50.0);
+        REQUIRE( violations([&] { o.process(input.data(), output.data(), k_frames, s); }) == 0 );
+    }
+    SECTION ("saturation") {
+        saturation s;
+        s.drive(50.0);
+        REQUIRE( violations([&] { s.process(input.data(), output.data(), k_frames); }) == 0 );
+    }
+    SECTION ("sos_cascade") {
+        sos_cascade f {2, 3};
+        channels in {2};
+        channels out {2};
+        REQUIRE( violations([&] { f(in.bundle(), out.bundle()); }) == 0 );
+    }
+}
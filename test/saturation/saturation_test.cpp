@@ -0,0 +1,218 @@
+/// @file
+///	@brief 		Unit test for the saturation class
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#define CATCH_CONFIG_MAIN
+#include "c74_min_catch.h"
+
+#include <chrono>
+
+using antialiasing_mode = c74::min::lib::saturation::antialiasing_mode;
+
+
+// saturation is a class rather than an alias of basic_saturation<>, so that code which forward declares it still compiles.
+
+namespace c74::min::lib {
+    class saturation;
+}
+
+
+// The shaper as originally specified, for reference.
+// Above 50% drive the sine overshoots the clipping level, so the output is scaled down.
+
+double reference(double x, double drive_percentage) {
+    auto f     = drive_percentage / 100.0;
+    auto scale = f > 0.5 ? sin(M_PI * f) : 1.0;
+
+    if (x > 1.0)
+        return scale;
+    else if (x < -1.0)
+        return -scale;
+    return sin(M_PI * f * x) / sin(M_PI * f) * scale;
+}
+
+
+// Energy below 20 kHz in the spectrum of the last 4096 samples that does not fall on a harmonic, relative to the total.
+
+double alias_ratio(const c74::min::sample_vector& y, int fundamental_bin) {
+    const int							size = 4096;
+    c74::min::lib::real_fft				transform {size};
+    c74::min::sample_vector				re(size / 2 + 1);
+    c74::min::sample_vector				im(size / 2 + 1);
+
+    transform.forward(y.data() + y.size() - size, re.data(), im.data());
+
+    double harmonics {};
+    double total {};
+    for (auto k = 1; k <= size * 20 / 48; ++k) {
+        auto energy = re[k] * re[k] + im[k] * im[k];
+        total += energy;
+        if (k % fundamental_bin == 0)
+            harmonics += energy;
+    }
+    return (total - harmonics) / total;
+}
+
+
+// Saturate a sine at an exact bin of a 4096-point transform.
+
+c74::min::sample_vector saturate_sine(antialiasing_mode mode, int bin, double amplitude) {
+    c74::min::lib::saturation	s;
+    c74::min::sample_vector		y(8192);
+
+    s.drive(50.0);
+    s.antialiasing(mode);
+    for (auto i = 0; i < y.size(); ++i)
+        y[i] = s(amplitude * sin(2.0 * M_PI * bin * i / 4096.0));
+    return y;
+}
+
+
+TEST_CASE ("saturation without anti-aliasing matches the reference shaper") {
+    c74::min::lib::saturation s;
+
+    for (auto drive : {10.0, 45.0, 90.0}) {
+        s.drive(drive);
+        for (auto x = -1.5; x <= 1.5; x += 0.01)
+            REQUIRE( s(x) == Approx(reference(x, drive)) );
+    }
+    REQUIRE( s.latency() == 0.0 );
+}
+
+
+// Process a slow ramp through the clipping point, then a signal whose consecutive samples are nearly or exactly equal.
+
+void check_follows(antialiasing_mode mode) {
+    c74::min::lib::saturation s;
+    s.drive(70.0);
+    s.antialiasing(mode);
+
+    auto latency = s.latency();
+    auto matches = true;
+    for (auto i = 0; i < 4000; ++i) {
+        auto y = s(-2.0 + i * 0.001);
+        auto x = -2.0 + (i - latency) * 0.001;
+        if (i > 2)
+            matches = matches && std::abs(y - reference(x, 70.0)) < 1e-3;
+    }
+    REQUIRE( matches );
+
+    auto finite = true;
+    auto close  = true;
+    for (auto i = 0; i < 1000; ++i) {
+        auto x = 0.3 + (i % 7) * 1e-9 + (i / 100) * 1e-7;
+        auto y = s(x);
+        finite = finite && std::isfinite(y);
+        if (i > 2)
+            close = close && std::abs(y - reference(x, 70.0)) < 1e-5;
+    }
+    REQUIRE( finite );
+    REQUIRE( close );
+
+    // the input returns to the same value every other sample
+    for (auto i = 0; i < 100; ++i)
+        finite = finite && std::isfinite(s(i % 2 ? 0.5 : 0.2));
+    REQUIRE( finite );
+}
+
+
+TEST_CASE ("antiderivative anti-aliasing follows slowly changing input, and falls back when samples are nearly equal") {
+    SECTION("first-order")
+    check_follows(antialiasing_mode::first_order);
+    SECTION("second-order")
+    check_follows(antialiasing_mode::second_order);
+}
+
+
+SCENARIO ("antiderivative anti-aliasing reduces aliasing") {
+
+    GIVEN ("A sine at 5.1 kHz driven into clipping") {
+        const int bin = 437;
+
+        auto none   = alias_ratio(saturate_sine(antialiasing_mode::none, bin, 1.5), bin);
+        auto first  = alias_ratio(saturate_sine(antialiasing_mode::first_order, bin, 1.5), bin);
+        auto second = alias_ratio(saturate_sine(antialiasing_mode::second_order, bin, 1.5), bin);
+
+        THEN("first-order reduces the aliased energy, and second-order reduces it further") {
+            REQUIRE( 10.0 * log10(first / none) < -10.0 );
+            REQUIRE( 10.0 * log10(second / none) < -20.0 );
+        }
+    }
+}
+
+
+TEST_CASE ("benchmark of anti-aliasing modes", "[.benchmark]") {
+    const int count = 1000000;
+
+    for (auto mode : {antialiasing_mode::none, antialiasing_mode::first_order, antialiasing_mode::second_order}) {
+        c74::min::lib::saturation s;
+        s.drive(50.0);
+        s.antialiasing(mode);
+
+        auto   start = std::chrono::steady_clock::now();
+        double sum {};
+        for (auto i = 0; i < count; ++i)
+            sum += s(1.5 * sin(i * 0.001));
+        auto end = std::chrono::steady_clock::now();
+
+        std::cout << "saturation, antialiasing mode " << static_cast<int>(mode) << ": "
+                  << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+        REQUIRE( std::isfinite(sum) );
+    }
+}
+
+
+TEST_CASE ("the polynomial evaluation is within its documented error bound") {
+    using evaluation_mode = c74::min::lib::saturation::evaluation_mode;
+
+    c74::min::lib::saturation exact;
+    c74::min::lib::saturation fast;
+    fast.evaluation(evaluation_mode::polynomial);
+
+    c74::min::sample_vector x(4001);
+    c74::min::sample_vector y(x.size());
+    for (auto i = 0; i < x.size(); ++i)
+        x[i] = -2.0 + i * 0.001;
+
+    double worst {};
+    auto   same = true;
+    for (auto drive = 0.0; drive <= 100.0; drive += 2.5) {
+        exact.drive(drive);
+        fast.drive(drive);
+        fast.process(x.data(), y.data(), x.size());
+
+        for (auto i = 0; i < x.size(); ++i) {
+            worst = std::max(worst, std::abs(y[i] - exact(x[i])));
+            same  = same && std::abs(y[i] - fast(x[i])) < 1e-15;
+        }
+    }
+    REQUIRE( worst < 1e-10 );
+    REQUIRE( same );    // process() and operator() agree
+}
+
+
+TEST_CASE ("benchmark of evaluation modes", "[.benchmark]") {
+    using evaluation_mode = c74::min::lib::saturation::evaluation_mode;
+
+    const int				count = 1000000;
+    c74::min::sample_vector	x(count);
+    c74::min::sample_vector	y(count);
+    for (auto i = 0; i < count; ++i)
+        x[i] = 1.5 * sin(i * 0.001);
+
+    for (auto mode : {evaluation_mode::exact, evaluation_mode::polynomial}) {
+        c74::min::lib::saturation s;
+        s.drive(50.0);
+        s.evaluation(mode);
+
+        auto start = std::chrono::steady_clock::now();
+        s.process(x.data(), y.data(), count);
+        auto end = std::chrono::steady_clock::now();
+
+        std::cout << "saturation::process(), evaluation mode " << static_cast<int>(mode) << ": "
+                  << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+        REQUIRE( std::abs(y[count / 2]) <= 1.0 );
+    }
+}
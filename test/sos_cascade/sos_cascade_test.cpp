@@ -0,0 +1,121 @@
+/// @file
+///	@brief 		Unit test for the sos_cascade class and the biquad designers
+///	@ingroup 	minlib
+///	@copyright	Copyright 2018 The Min-Lib Authors. All rights reserved.
+///	@license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#define CATCH_CONFIG_MAIN
+#include "c74_min_catch.h"
+
+#include <complex>
+
+
+// Magnitude of the frequency response of a biquad in decibels.
+
+double response(const c74::min::lib::filters::biquad_coefficients& c, double frequency, double fs = 48000.0) {
+    auto z1  = std::polar(1.0, -2.0 * M_PI * frequency / fs);
+    auto z2  = z1 * z1;
+    auto num = c.b0 + c.b1 * z1 + c.b2 * z2;
+    auto den = 1.0 + c.a1 * z1 + c.a2 * z2;
+    return 20.0 * log10(std::abs(num / den));
+}
+
+
+TEST_CASE ("biquad designers have the expected response") {
+    using namespace c74::min::lib::filters;
+
+    REQUIRE( response(bandpass(1000.0, 2.0, 48000.0), 1000.0) == Approx(0.0).margin(1e-9) );
+    REQUIRE( response(bandpass(1000.0, 2.0, 48000.0), 100.0) < -20.0 );
+    REQUIRE( response(notch(1000.0, 2.0, 48000.0), 1000.0) < -200.0 );
+    REQUIRE( response(notch(1000.0, 2.0, 48000.0), 10.0) == Approx(0.0).margin(1e-3) );
+    REQUIRE( response(peaking(1000.0, 1.0, 6.0, 48000.0), 1000.0) == Approx(6.0) );
+    REQUIRE( response(peaking(1000.0, 1.0, -6.0, 48000.0), 1000.0) == Approx(-6.0) );
+    REQUIRE( response(lowshelf(500.0, 0.7071, 9.0, 48000.0), 0.0) == Approx(9.0) );
+    REQUIRE( response(lowshelf(500.0, 0.7071, 9.0, 48000.0), 500.0) == Approx(4.5).margin(0.01) );
+    REQUIRE( response(lowshelf(500.0, 0.7071, 9.0, 48000.0), 20000.0) == Approx(0.0).margin(0.01) );
+    REQUIRE( response(highshelf(5000.0, 0.7071, -9.0, 48000.0), 24000.0) == Approx(-9.0) );
+    REQUIRE( response(highshelf(5000.0, 0.7071, -9.0, 48000.0), 20.0) == Approx(0.0).margin(0.01) );
+}
+
+
+SCENARIO ("a cascade produces the same output as a chain of biquads") {
+
+    GIVEN ("A 3-channel, 5-section equalizer and equivalent chains of biquads") {
+        using namespace c74::min::lib;
+
+        const int								channels = 3;
+        const int								sections = 5;
+        const filters::biquad_coefficients		eq[sections] = {
+            filters::highpass(30.0, 0.7071, 48000.0),
+            filters::lowshelf(120.0, 0.7071, 3.0, 48000.0),
+            filters::peaking(800.0, 2.0, -4.0, 48000.0),
+            filters::peaking(3000.0, 0.7, 2.5, 48000.0),
+            filters::highshelf(9000.0, 0.7071, -6.0, 48000.0)
+        };
+
+        sos_cascade				cascade {channels, sections};
+        std::vector<biquad>		chain[channels];
+
+        for (auto k = 0; k < sections; ++k)
+            cascade.section(k, eq[k]);
+        cascade.section(2, 1, filters::notch(60.0, 4.0, 48000.0));    // one channel differs
+
+        for (auto c = 0; c < channels; ++c)
+            for (auto k = 0; k < sections; ++k)
+                chain[c].push_back(biquad {cascade.section(k, c)});
+
+        WHEN ("processing noise in place in vectors of varying size, some shorter than the pipeline") {
+            const int			frames = 1000;
+            c74::min::sample_vector	buffers[channels];
+            c74::min::sample_vector	reference[channels];
+
+            for (auto c = 0; c < channels; ++c) {
+                for (auto i = 0; i < frames; ++i)
+                    buffers[c].push_back(c74::min::lib::math::random(-1.0, 1.0));
+                reference[c] = buffers[c];
+                for (auto& section : chain[c])
+                    section.process(reference[c].data(), reference[c].data(), frames);
+            }
+
+            const int	sizes[] = {1, 3, 4, 64, 17, 2, 511};
+            int			offset {};
+            for (auto i = 0; offset < frames; ++i) {
+                auto				n = std::min(sizes[i % 7], frames - offset);
+                c74::min::sample*	pointers[channels];
+                for (auto c = 0; c < channels; ++c)
+                    pointers[c] = buffers[c].data() + offset;
+
+                c74::min::audio_bundle bundle {pointers, channels, n};
+                cascade(bundle, bundle);
+                offset += n;
+            }
+
+            THEN("the outputs match") {
+                for (auto c = 0; c < channels; ++c)
+                    for (auto i = 0; i < frames; ++i)
+                        REQUIRE( buffers[c][i] == Approx(reference[c][i]).margin(1e-12) );
+            }
+        }
+    }
+
+    GIVEN ("A single channel cascade of one section") {
+        using namespace c74::min::lib;
+
+        sos_cascade	cascade;
+        biquad		filter {filters::lowpass(1000.0, 0.7071, 48000.0)};
+        cascade.section(0, filter.coefficients());
+
+        WHEN ("processing an impulse") {
+            c74::min::sample_vector	x(64, 0.0);
+            c74::min::sample_vector	y(64);
+            c74::min::sample_vector	reference(64);
+            x[0] = 1.0;
+
+            cascade.process(x.data(), y.data(), 64);
+            filter.process(x.data(), reference.data(), 64);
+
+            THEN("the impulse responses match")
+            REQUIRE( y == reference );
+        }
+    }
+}